@@ -0,0 +1,150 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: Helpers
+// -------------------------------------------------------------------------- //
+
+static inline size_t alignUp(size_t n) {
+    return (n + (ARENA_ALIGNMENT - 1)) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static ArenaChunk *chunkNew(ArenaChunk *prev, size_t capacity) {
+    if (capacity > SIZE_MAX - sizeof(ArenaChunk))
+        return NULL;
+
+    ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + capacity);
+    if (!chunk) {
+        fprintf(stderr, "<ArenaAlloc(): allocation failure>\n");
+        return NULL;
+    }
+
+    chunk->prev     = prev;
+    chunk->capacity = capacity;
+    chunk->used     = 0;
+    return chunk;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Tags
+// -------------------------------------------------------------------------- //
+
+const char *ArenaTagStr(ArenaTag tag) {
+    switch (tag) {
+    #define X(name, str) case name: return str;
+    ARENA_TAG_LIST
+    #undef X
+    default: return "<invalid ArenaTag>";
+    }
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Implementation
+// -------------------------------------------------------------------------- //
+
+Arena ArenaNew(size_t chunkSize) {
+    return (Arena) {
+        .chunks    = {0},
+        .chunkSize = chunkSize == 0 ? ARENA_CHUNK_SIZE : alignUp(chunkSize),
+    };
+}
+
+void *ArenaAlloc(Arena *self, ArenaTag tag, size_t size) {
+    if (!ArenaIsValid(self) || tag >= ARENA_TAG_COUNT || size == 0)
+        return NULL;
+    if (size > SIZE_MAX - ARENA_ALIGNMENT)
+        return NULL;
+
+    size = alignUp(size);
+    ArenaChunk *chunk = self->chunks[tag];
+
+    //
+    // Start a new chunk (if needed). Oversized allocations get a chunk of
+    // exactly their size so they don't waste the rest of a default chunk.
+    //
+    if (!chunk || chunk->capacity - chunk->used < size) {
+        size_t capacity = size > self->chunkSize ? size : self->chunkSize;
+        chunk = chunkNew(chunk, capacity);
+        if (!chunk) return NULL;
+        self->chunks[tag] = chunk;
+    }
+
+    void *ptr = (char *)chunk->data + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+void *ArenaGrow(
+    Arena *self,
+    ArenaTag tag,
+    void *ptr,
+    size_t oldSize,
+    size_t newSize
+) {
+    if (!ptr)
+        return ArenaAlloc(self, tag, newSize);
+    if (!ArenaIsValid(self) || tag >= ARENA_TAG_COUNT || newSize == 0)
+        return NULL;
+    if (newSize <= oldSize)
+        return ptr;
+    if (newSize > SIZE_MAX - ARENA_ALIGNMENT)
+        return NULL;
+
+    //
+    // Extend in place if `ptr` is the last allocation of this tag
+    //
+    ArenaChunk *chunk = self->chunks[tag];
+    size_t oldAligned = alignUp(oldSize);
+    size_t newAligned = alignUp(newSize);
+    if (chunk
+        && (char *)ptr + oldAligned == (char *)chunk->data + chunk->used
+        && chunk->capacity - chunk->used >= newAligned - oldAligned)
+    {
+        chunk->used += newAligned - oldAligned;
+        return ptr;
+    }
+
+    // Otherwise move it
+    void *newPtr = ArenaAlloc(self, tag, newSize);
+    if (!newPtr) return NULL;
+    memcpy(newPtr, ptr, oldSize);
+    return newPtr;
+}
+
+void ArenaReleaseTag(Arena *self, ArenaTag tag) {
+    if (!self || tag >= ARENA_TAG_COUNT)
+        return;
+
+    ArenaChunk *chunk = self->chunks[tag];
+    while (chunk) {
+        ArenaChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+    self->chunks[tag] = NULL;
+}
+
+void ArenaRelease(Arena *self) {
+    if (!self)
+        return;
+
+    for (size_t tag = 0; tag < ARENA_TAG_COUNT; tag++)
+        ArenaReleaseTag(self, (ArenaTag)tag);
+}
+
+size_t ArenaBytesUsed(const Arena *self, ArenaTag tag) {
+    if (!self || tag >= ARENA_TAG_COUNT)
+        return 0;
+
+    size_t used = 0;
+    for (const ArenaChunk *c = self->chunks[tag]; c; c = c->prev)
+        used += c->used;
+    return used;
+}
+
+bool ArenaIsValid(const Arena *self) {
+    return self && self->chunkSize > 0;
+}
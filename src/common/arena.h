@@ -0,0 +1,93 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// The default size of each chunk requested from `malloc`. Allocations larger
+// than this get a chunk of their own.
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+// Every allocation handed out by the arena is aligned to this many bytes.
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+// -------------------------------------------------------------------------- //
+// MARK: Tags
+// -------------------------------------------------------------------------- //
+
+// Each tag is an independent lifetime inside an arena. Memory allocated under
+// one tag can be released without touching memory allocated under the others,
+// i.e. the tokens can be dropped as soon as parsing is finished while the AST
+// lives on.
+#define ARENA_TAG_LIST                                                         \
+    X(ARENA_TAG_MISC,   "misc")                                                \
+    X(ARENA_TAG_TOKENS, "tokens")                                              \
+    X(ARENA_TAG_AST,    "ast")                                                 \
+    X(ARENA_TAG_DIAGS,  "diagnostics")
+
+typedef enum ArenaTag {
+    #define X(name, str) name,
+    ARENA_TAG_LIST
+    #undef X
+    ARENA_TAG_COUNT
+} ArenaTag;
+
+// Returns the tag name as a string.
+const char *ArenaTagStr(ArenaTag tag);
+
+// -------------------------------------------------------------------------- //
+// MARK: Arena
+// -------------------------------------------------------------------------- //
+
+// One block of memory owned by an arena. Chunks of the same tag form a
+// singly linked list with the newest chunk at the head.
+typedef struct ArenaChunk {
+    struct ArenaChunk *prev;
+    size_t capacity;
+    size_t used;
+    max_align_t data[];
+} ArenaChunk;
+
+// A chunked bump allocator. There should be one arena per translation unit;
+// everything allocated from it is released at once with `ArenaRelease()`.
+// - `chunks` the newest chunk of every tag (or `NULL`).
+// - `chunkSize` the default capacity of each new chunk in bytes.
+//
+// Individual allocations are never freed. `ArenaGrow()` extends the most
+// recent allocation of a tag in place when there is room, which is what makes
+// growable lists cheap to back with an arena.
+typedef struct Arena {
+    ArenaChunk *chunks[ARENA_TAG_COUNT];
+    size_t chunkSize;
+} Arena;
+
+// Creates a new, empty arena. No memory is allocated until the first call to
+// `ArenaAlloc()`. A `chunkSize` of zero uses `ARENA_CHUNK_SIZE`.
+Arena ArenaNew(size_t chunkSize);
+
+// Allocates `size` bytes under the given tag. Returns `NULL` if `size` is zero
+// or if `malloc` fails. The memory is not zeroed.
+void *ArenaAlloc(Arena *self, ArenaTag tag, size_t size);
+
+// Grows an allocation from `oldSize` to `newSize` bytes. If `ptr` is the most
+// recent allocation of `tag` and its chunk has room, it is extended in place
+// and `ptr` is returned. Otherwise new memory is allocated and the old bytes
+// are copied over (the old block is not reclaimed until its tag is released).
+void *ArenaGrow(Arena *self, ArenaTag tag, void *ptr, size_t oldSize,
+    size_t newSize);
+
+// Frees every chunk of one tag. Any pointer allocated under that tag is
+// dangling afterwards.
+void ArenaReleaseTag(Arena *self, ArenaTag tag);
+
+// Frees every chunk of every tag, leaving the arena empty but reusable.
+void ArenaRelease(Arena *self);
+
+// Returns the number of bytes handed out under the given tag.
+size_t ArenaBytesUsed(const Arena *self, ArenaTag tag);
+
+// Checks that the arena pointer is valid and has a nonzero chunk size.
+bool ArenaIsValid(const Arena *self);
+
+#endif
@@ -40,6 +40,7 @@ const char *DiagIssueStringified(DiagIssue self) {
 
     case ERR_INVALID_CHAR:   return "invalid character";
     case ERR_INVALID_STRING: return "invalid string";
+    case ERR_INVALID_NUMBER: return "invalid number";
     
     case ERR_INVALID_SYNTAX: return "invalid syntax";
     }
@@ -60,42 +61,34 @@ const char *DiagLevelStringified(DiagLevel self) {
 // -------------------------------------------------------------------------- //
 
 void DiagReportRender(const DiagReport *self, const char *underlineColor) {
-    const char *data = self->span.src->data;
-    size_t fileLen = self->span.src->length;
-    size_t gutterSize = 2 + countDigits(self->span.y);
+    const Source *src = SpanSource(&self->span);
+    size_t line = 0, col = 0;
+    if (!src || !SpanLineCol(&self->span, &line, &col)) {
+        fprintf(stderr, "<DiagReportRender(): span has no source>\n");
+        return;
+    }
+
+    // Everything below works with offsets local to the source
+    const char *data = src->data;
+    size_t fileLen = src->length;
+    size_t offset = self->span.offset - src->base;
+    size_t gutterSize = 2 + countDigits(line);
 
     // Header
     COLORIZE(ANSI_COLOR_BLUE);
-    printf(
-        "  %s:%zu:%zu\n",
-        self->span.src->path,
-        self->span.y,
-        self->span.x
-    );
+    printf("  %s:%zu:%zu\n", src->path, line, col);
     COLORIZE(ANSI_RESET);
 
-    //
-    // Find start of the line containing span.offset
-    // @(expect) assume invariant #1 here:
-    //
-    size_t start = 0;
-    for (size_t i = self->span.offset; ; i--) {
-        if (data[i] == '\n') {
-            start = i + 1;
-            break;
-        }
-        if (i == 0) {
-            start = 0;
-            break;
-        }
-    }
+    // Start of the line containing the span, from the line index. Streamed
+    // sources only hold a window, which may begin part way through the line.
+    size_t start = offset >= col - 1 ? offset - (col - 1) : 0;
 
     //
     // Count how many lines the span touches
     //
     size_t line_count = 1;
-    for (size_t i = self->span.offset;
-         i < fileLen && i < self->span.offset + self->span.length;
+    for (size_t i = offset;
+         i < fileLen && i < offset + self->span.length;
          i++)
     {
         if (data[i] == '\n')
@@ -112,7 +105,7 @@ void DiagReportRender(const DiagReport *self, const char *underlineColor) {
 
         // Print line number gutter
         COLORIZE(ANSI_COLOR_BLUE);
-        printf(" %zu | ", self->span.y + ln);
+        printf(" %zu | ", line + ln);
         COLORIZE(ANSI_RESET);
 
         // Print source line
@@ -134,16 +127,16 @@ void DiagReportRender(const DiagReport *self, const char *underlineColor) {
         COLORIZE(ANSI_RESET);
 
         bool first_line =
-            index <= self->span.offset &&
-            self->span.offset < eol;
+            index <= offset &&
+            offset < eol;
 
         for (size_t i = index; i < eol; i++) {
             COLORIZE(underlineColor);
-            if (first_line && i == self->span.offset)
+            if (first_line && i == offset)
                 printf("^");
             else if (
-                i >= self->span.offset &&
-                i < self->span.offset + self->span.length
+                i >= offset &&
+                i < offset + self->span.length
             )
                 printf("~");
             else
@@ -180,6 +173,15 @@ Diagnostic DiagNew(
     };
 }
 
+Diagnostic DiagShifted(const Diagnostic *self, uint32_t delta) {
+    const Span span = (Span) {
+        self->report.span.offset + delta,
+        self->report.span.length,
+    };
+    return DiagNew(self->issue, self->message,
+        (DiagReport) { span, self->report.message });
+}
+
 void DiagRender(const Diagnostic *self) {
     const char *underlineColor;
     const char *foregroundColor;
@@ -223,27 +225,32 @@ void DiagRender(const Diagnostic *self) {
 // -------------------------------------------------------------------------- //
 
 DiagEngine DENew() {
-    List diagList = ListNew(sizeof(Diagnostic), INIT_DIAG_LIST_CAP);
-    if (!ListIsValid(&diagList)) return (DiagEngine) {0};
+    return DENewInArena(NULL);
+}
+
+DiagEngine DENewInArena(Arena *arena) {
+    DiagnosticVec diagList = DiagnosticVecNewInArena(
+        arena, ARENA_TAG_DIAGS, MEM_DIAGS, INIT_DIAG_LIST_CAP);
+    if (!DiagnosticVecIsValid(&diagList)) return (DiagEngine) {0};
     else return (DiagEngine) { diagList };
 }
 
 void DEPush(DiagEngine *engine, const Diagnostic *diag) {
-    /* discard */ ListPush(&engine->diagnostics, diag);
+    /* discard */ DiagnosticVecPush(&engine->diagnostics, diag);
+}
+
+void DERecordMemStats(const DiagEngine *self) {
+    if (!self) return;
+    MemStatsSetInUse(MEM_DIAGS, self->diagnostics.count * sizeof(Diagnostic));
 }
 
 void DEPrint(FILE *ioStream, const DiagEngine *self) {
-    if (!self || !ioStream || !ListIsValid(&self->diagnostics)) {
+    if (!self || !ioStream || !DiagnosticVecIsValid(&self->diagnostics)) {
         fprintf(stderr, "<invalid diag engine pointer or IO stream pointer>\n");
         return;
     }
 
     for (size_t i = 0; i < self->diagnostics.count; i++) {
-        Diagnostic *diag = (Diagnostic *)ListGet(&self->diagnostics, i);
-        if (!diag) {
-            fprintf(ioStream, "<invalid diag pointer in list>\n");
-            continue;
-        }
-        DiagRender(diag);
+        DiagRender(DiagnosticVecGet(&self->diagnostics, i));
     }
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "source.h"
 #include "list.h"
+#include "arena.h"
+#include "vec.h"
 
 #define INIT_DIAG_LIST_CAP 16
 
@@ -23,6 +25,7 @@ typedef enum DiagIssue {
     /* Lexical errors */
     ERR_INVALID_CHAR,
     ERR_INVALID_STRING,
+    ERR_INVALID_NUMBER,
 
     /* Parsing errors */
     ERR_INVALID_SYNTAX,
@@ -81,27 +84,40 @@ typedef struct Diagnostic {
 // Creates a new diagnostic and initializes all members.
 Diagnostic DiagNew(DiagIssue issue, const char *message, DiagReport report);
 
+// Returns a copy of `self` with its report moved `delta` bytes (wrapping),
+// for when its source was edited.
+Diagnostic DiagShifted(const Diagnostic *self, uint32_t delta);
+
 // Renders the diagnostic as a whole to `stdout` via `printf()`.
 void DiagRender(const Diagnostic *self);
 
+DEFINE_VEC(Diagnostic)
+
 // -------------------------------------------------------------------------- //
 // MARK: Engine
 // -------------------------------------------------------------------------- //
 
 // Used to keep track of all diagnostics. Right now, it is just a wrapper
-// around `List`, but in the future will have helpful methods to sort 
+// around `DiagnosticVec`, but in the future will have helpful methods to sort 
 // diagnostics and organize them.
 // 
 // There should be one diagnostic engine per translation unit (for now).
 typedef struct DiagEngine {
-    List diagnostics;
+    DiagnosticVec diagnostics;
 } DiagEngine;
 
 DiagEngine DENew();
 
+// Same as `DENew()`, but the diagnostics are allocated from `arena` under
+// `ARENA_TAG_DIAGS`.
+DiagEngine DENewInArena(Arena *arena);
+
 // Pushes a new diagnostic to the list.
 void DEPush(DiagEngine *engine, const Diagnostic *diag);
 
 void DEPrint(FILE *ioStream, const DiagEngine *self);
 
+// Reports the bytes occupied by diagnostics to `MemStatsSetInUse()`.
+void DERecordMemStats(const DiagEngine *self);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: Hash
+// * A small wyhash style hash: 16 bytes per step, each step a single 64x64 to
+// * 128 bit multiply folded back to 64 bits. Not cryptographic, only meant
+// * for hash tables, so every match must still be confirmed by comparing.
+// -------------------------------------------------------------------------- //
+
+#define HASH_SECRET_0 0xa0761d6478bd642full
+#define HASH_SECRET_1 0xe7037ed1a0b428dbull
+#define HASH_SECRET_2 0x8ebc6af09c88c6e3ull
+
+// Multiplies `a` and `b` into 128 bits, leaving the low half in `a` and the
+// high half in `b`.
+static inline void HashMul(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t HashMix(uint64_t a, uint64_t b) {
+    HashMul(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t HashRead8(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(uint64_t));
+    return v;
+}
+
+static inline uint64_t HashRead4(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(uint32_t));
+    return v;
+}
+
+// Hashes `length` bytes of `data`. Short keys (identifiers, mostly) take the
+// `length <= 16` path, which is branch light and never loops.
+static inline uint64_t HashBytes(const void *data, size_t length) {
+    const unsigned char *p = data;
+    uint64_t seed = HASH_SECRET_0 ^ HashMix(length ^ HASH_SECRET_1,
+        HASH_SECRET_2);
+    uint64_t a, b;
+
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t mid = (length >> 3) << 2;
+            a = (HashRead4(p) << 32) | HashRead4(p + mid);
+            b = (HashRead4(p + length - 4) << 32)
+                | HashRead4(p + length - 4 - mid);
+        } else if (length > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8)
+                | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+        for (; i > 16; i -= 16, p += 16)
+            seed = HashMix(HashRead8(p) ^ HASH_SECRET_1,
+                HashRead8(p + 8) ^ seed);
+        a = HashRead8(p + i - 16);
+        b = HashRead8(p + i - 8);
+    }
+
+    a ^= HASH_SECRET_1;
+    b ^= seed;
+    HashMul(&a, &b);
+    return HashMix(a ^ HASH_SECRET_0 ^ length, b ^ HASH_SECRET_1);
+}
+
+// Folds a 64 bit hash down to the 32 bits stored in tokens and tables.
+static inline uint32_t HashFold32(uint64_t hash) {
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include "intern.h"
+#include <stdio.h>
+#include <string.h>
+
+#define INIT_SYMBOL_CAPACITY 256
+#define INIT_POOL_CAPACITY   4096
+
+// -------------------------------------------------------------------------- //
+// MARK: Helpers
+// -------------------------------------------------------------------------- //
+
+// Allocates an empty table of `capacity` slots like `vec`.
+static InternSlotVec newSlots(const InternSlotVec *vec, size_t capacity) {
+    InternSlotVec slots = InternSlotVecNewInArena(
+        vec->arena, vec->tag, MEM_SYMBOLS, capacity);
+    if (!InternSlotVecIsValid(&slots)) return slots;
+    memset(slots.data, 0, capacity * sizeof(InternSlot));
+    slots.count = capacity;
+    return slots;
+}
+
+// Doubles the table and reinserts every id. Hashes are stored in the slots,
+// so no key is rehashed.
+static bool growSlots(Interner *self) {
+    const InternSlotVec *old = &self->slots;
+    size_t capacity = old->capacity * 2;
+    InternSlotVec slots = newSlots(old, capacity);
+    if (!InternSlotVecIsValid(&slots)) {
+        fprintf(stderr, "<growSlots(): allocation failure>\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < old->count; i++) {
+        const InternSlot slot = old->data[i];
+        if (slot.id == NULL_SYMBOL_ID) continue;
+        size_t j = slot.hash & (capacity - 1);
+        while (slots.data[j].id != NULL_SYMBOL_ID) j = (j + 1) & (capacity - 1);
+        slots.data[j] = slot;
+    }
+
+    InternSlotVecFree(&self->slots);
+    self->slots = slots;
+    return true;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Implementation
+// -------------------------------------------------------------------------- //
+
+Interner InternerNew() {
+    return InternerNewInArena(NULL, ARENA_TAG_MISC);
+}
+
+Interner InternerNewInArena(Arena *arena, ArenaTag tag) {
+    const InternSlotVec like = { .arena = arena, .tag = tag };
+    Interner self = {
+        .symbols = SymbolVecNewInArena(
+            arena, tag, MEM_SYMBOLS, INIT_SYMBOL_CAPACITY),
+        .pool = charVecNewInArena(
+            arena, tag, MEM_SYMBOLS, INIT_POOL_CAPACITY),
+        .slots = newSlots(&like, INIT_SYMBOL_CAPACITY * 2),
+    };
+
+    // The sentinel takes the place of `NULL_SYMBOL_ID`
+    const Symbol sentinel = {0};
+    if (!SymbolVecIsValid(&self.symbols)
+        || SymbolVecPush(&self.symbols, &sentinel) == LIST_RES_ERR
+        || !InternerIsValid(&self))
+    {
+        InternerFree(&self);
+        return (Interner) {0};
+    }
+    return self;
+}
+
+bool InternerIsValid(const Interner *self) {
+    return self
+        && SymbolVecIsValid(&self->symbols)
+        && charVecIsValid(&self->pool)
+        && InternSlotVecIsValid(&self->slots)
+        && self->symbols.count >= 1;
+}
+
+// Returns the id of the `length` bytes at `data` if they were interned
+// before, otherwise `NULL_SYMBOL_ID` and the empty slot they would go in.
+static SymbolId find(
+    const Interner *self,
+    const char *data,
+    size_t length,
+    uint32_t hash,
+    size_t *slot
+) {
+    const InternSlot *slots = self->slots.data;
+    const size_t mask = self->slots.count - 1;
+    size_t j = hash & mask;
+    for (; slots[j].id != NULL_SYMBOL_ID; j = (j + 1) & mask) {
+        if (slots[j].hash != hash) continue;
+
+        // Only compare bytes on a full hash match
+        const Symbol *sym = SymbolVecGet(&self->symbols, slots[j].id);
+        if (sym->length == length
+            && memcmp(self->pool.data + sym->start, data, length) == 0)
+            return slots[j].id;
+    }
+    *slot = j;
+    return NULL_SYMBOL_ID;
+}
+
+// Adds a symbol for the `length` bytes at the end of the pool, in `slot`.
+static SymbolId add(Interner *self, size_t length, uint32_t hash, size_t slot) {
+    const Symbol sym = {
+        .start  = (uint32_t)(self->pool.count - length),
+        .length = (uint32_t)length,
+        .hash   = hash,
+    };
+    const SymbolId id = (SymbolId)self->symbols.count;
+    if (SymbolVecPush(&self->symbols, &sym) == LIST_RES_ERR)
+        return NULL_SYMBOL_ID;
+    self->slots.data[slot] = (InternSlot) { hash, id };
+
+    // Keep the table at most half full
+    if ((self->symbols.count - 1) * 2 > self->slots.count)
+        /* discard */ growSlots(self);
+
+    return id;
+}
+
+// Returns whether `length` more bytes still fit the 32 bit ids and offsets.
+static bool fits(const Interner *self, size_t length) {
+    if (self->symbols.count >= UINT32_MAX
+        || self->pool.count + length >= UINT32_MAX)
+    {
+        fprintf(stderr, "<InternerIntern(): too many symbols>\n");
+        return false;
+    }
+    return true;
+}
+
+SymbolId InternerIntern(
+    Interner *self,
+    const char *data,
+    size_t length,
+    uint32_t hash
+) {
+    size_t slot = 0;
+    const SymbolId found = find(self, data, length, hash, &slot);
+    if (found != NULL_SYMBOL_ID)
+        return found;
+
+    // New symbol, copy the bytes into the pool
+    if (!fits(self, length)
+        || charVecExtend(&self->pool, data, length) == LIST_RES_ERR)
+        return NULL_SYMBOL_ID;
+    return add(self, length, hash, slot);
+}
+
+char *InternerReserve(Interner *self, size_t length) {
+    if (!InternerIsValid(self) || !fits(self, length))
+        return NULL;
+
+    charVec *pool = &self->pool;
+    while (pool->capacity - pool->count < length) {
+        char *data = VecGrow(pool->data, &pool->capacity, sizeof(char),
+            pool->arena, pool->tag, pool->mem);
+        if (!data) return NULL;
+        pool->data = data;
+    }
+    return pool->data + pool->count;
+}
+
+SymbolId InternerInternReserved(Interner *self, size_t length, uint32_t hash) {
+    // @(expect) the room from `InternerReserve()` holds `length` bytes.
+    assert(self->pool.count + length <= self->pool.capacity);
+
+    size_t slot = 0;
+    const char *data = self->pool.data + self->pool.count;
+    const SymbolId found = find(self, data, length, hash, &slot);
+    if (found != NULL_SYMBOL_ID)
+        return found;
+
+    // The bytes are already in place, they just become part of the pool
+    self->pool.count += length;
+    return add(self, length, hash, slot);
+}
+
+Substring InternerGet(const Interner *self, SymbolId id) {
+    if (!self || id == NULL_SYMBOL_ID || id >= self->symbols.count)
+        return NULL_SUBSTRING;
+    const Symbol *sym = SymbolVecGet(&self->symbols, id);
+    return (Substring) {
+        .data   = self->pool.data + sym->start,
+        .length = sym->length,
+    };
+}
+
+void InternerClear(Interner *self) {
+    if (!InternerIsValid(self)) return;
+    self->symbols.count = 1;
+    self->pool.count = 0;
+    memset(self->slots.data, 0, self->slots.count * sizeof(InternSlot));
+}
+
+void InternerFree(Interner *self) {
+    if (!self) return;
+    SymbolVecFree(&self->symbols);
+    charVecFree(&self->pool);
+    InternSlotVecFree(&self->slots);
+    *self = (Interner) {0};
+}
+
+void InternerRecordMemStats(const Interner *self) {
+    if (!self) return;
+    MemStatsSetInUse(MEM_SYMBOLS,
+        self->symbols.count * sizeof(Symbol)
+        + self->pool.count
+        + (self->symbols.count - 1) * sizeof(InternSlot));
+}
@@ -0,0 +1,97 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "arena.h"
+#include "source.h"
+#include "vec.h"
+
+#define NULL_SYMBOL_ID 0
+
+// -------------------------------------------------------------------------- //
+// MARK: Interner
+// -------------------------------------------------------------------------- //
+
+// Identifies one distinct identifier. Ids are dense and start at 1, so they
+// can index arrays directly. `NULL_SYMBOL_ID` is never handed out.
+typedef uint32_t SymbolId;
+
+// - `start` where the bytes begin in the interner's pool.
+// - `length` the number of bytes.
+// - `hash` the 32 bit hash (see `HashFold32()`).
+typedef struct Symbol {
+    uint32_t start;
+    uint32_t length;
+    uint32_t hash;
+} Symbol;
+
+// One slot of the open addressed table, `NULL_SYMBOL_ID` marks it empty.
+typedef struct InternSlot {
+    uint32_t hash;
+    SymbolId id;
+} InternSlot;
+
+DEFINE_VEC(Symbol)
+DEFINE_VEC(InternSlot)
+DEFINE_VEC(char)
+
+// Maps each distinct identifier to a `SymbolId`. The bytes are copied into
+// a pool owned by the interner, so symbols outlive their source.
+// - `symbols` the symbol for each id (`symbols.data[0]` is the sentinel).
+// - `pool` the bytes of every symbol, back to back.
+// - `slots` the linear probing table, always a power of two in size and
+// at most half full. Every slot is in use, so `count == capacity`.
+typedef struct Interner {
+    SymbolVec symbols;
+    charVec pool;
+    InternSlotVec slots;
+} Interner;
+
+// Creates a new interner on the heap. Verify with `InternerIsValid()`.
+Interner InternerNew();
+
+// Same as `InternerNew()`, but everything is allocated from `arena` under
+// `tag`.
+Interner InternerNewInArena(Arena *arena, ArenaTag tag);
+
+bool InternerIsValid(const Interner *self);
+
+// Returns the id of the `length` bytes at `data`, adding them if they have
+// not been seen before. `hash` must be `HashFold32(HashBytes(data, length))`,
+// which the scanner computes once per symbol token. Returns `NULL_SYMBOL_ID`
+// on allocation failure.
+SymbolId InternerIntern(
+    Interner *self,
+    const char *data,
+    size_t length,
+    uint32_t hash
+);
+
+// Returns room for `length` bytes just past the end of the pool, so that a
+// string can be built in place and then interned with
+// `InternerInternReserved()` without a copy. Returns `NULL` on allocation
+// failure. The room is only valid until the next call into the interner.
+char *InternerReserve(Interner *self, size_t length);
+
+// Same as `InternerIntern()` for the first `length` bytes written to the
+// room from `InternerReserve()`. If they were seen before, the room is just
+// given back.
+SymbolId InternerInternReserved(Interner *self, size_t length, uint32_t hash);
+
+// Returns the bytes of a symbol, or `NULL_SUBSTRING` for an invalid id. The
+// substring is only valid until the next call to `InternerIntern()`.
+Substring InternerGet(const Interner *self, SymbolId id);
+
+// Forgets every symbol, so ids start from 1 again, but keeps the memory to
+// reuse.
+void InternerClear(Interner *self);
+
+// Frees a heap interner and poisons it.
+void InternerFree(Interner *self);
+
+// Reports the bytes occupied by symbols to `MemStatsSetInUse()`.
+void InternerRecordMemStats(const Interner *self);
+
+#endif
@@ -17,6 +17,10 @@ static inline bool mulWillOverflowSizet(size_t cap, size_t size) {
 // -------------------------------------------------------------------------- //
 
 List ListNew(size_t size, size_t capacity) {
+    return ListNewInArena(NULL, ARENA_TAG_MISC, size, capacity);
+}
+
+List ListNewInArena(Arena *arena, ArenaTag tag, size_t size, size_t capacity) {
     // Make sure the sizes and capacities are valid
     if (capacity == 0 || size == 0
         || mulWillOverflowSizet(capacity, size))
@@ -25,7 +29,9 @@ List ListNew(size_t size, size_t capacity) {
     }
 
     // Attempt allocate
-    void *data = (void *)malloc(size * capacity);
+    void *data = arena
+        ? ArenaAlloc(arena, tag, size * capacity)
+        : malloc(size * capacity);
     if (!data) {
         fprintf(stderr, "<ListNew(): allocation failure>\n");
         return NULL_LIST;
@@ -35,7 +41,9 @@ List ListNew(size_t size, size_t capacity) {
         .data = data,
         .capacity = capacity,
         .count = 0,
-        .size = size
+        .size = size,
+        .arena = arena,
+        .tag = tag,
     };
 }
 
@@ -110,7 +118,10 @@ ListResult ListPush(List *self, const void *item) {
         }
 
         // Reallocate
-        void *newData = realloc(self->data, newCapacity * self->size);
+        void *newData = self->arena
+            ? ArenaGrow(self->arena, self->tag, self->data,
+                self->capacity * self->size, newCapacity * self->size)
+            : realloc(self->data, newCapacity * self->size);
 
         // Check for errors with the allocation and update the List
         if (!newData) {
@@ -143,7 +154,8 @@ bool ListIsValid(const List *self) {
 ListResult ListFree(List *self) {
     if (!ListIsValid(self))
         return LIST_RES_NULLPTR;
-    free(self->data);
+    if (!self->arena)
+        free(self->data);
     *self = NULL_LIST;
     return LIST_RES_OK;
 }
@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include "arena.h"
 
 #define GROWTH_FACTOR 2
 #define NULL_LIST (List) {0}
@@ -33,6 +34,8 @@ typedef enum ListResult {
 // - `count` the number of elements in the list now. Remember when indexing that
 // this is always `i + 1`.
 // - `size` the size of each element in the list.
+// - `arena` the arena the list draws from, or `NULL` for the heap.
+// - `tag` the arena lifetime the list belongs to (ignored for heap lists).
 //
 // `List` uses the `ListResult` enum for many functions.
 // `List` takes pointers when appending, but will copy the actual bytes--items
@@ -43,6 +46,8 @@ typedef struct List {
     size_t capacity;
     size_t count;
     size_t size;
+    Arena *arena;
+    ArenaTag tag;
 } List;
 
 // Creates a new list with the given item size and capacity.
@@ -53,6 +58,12 @@ typedef struct List {
 // Remember to use `ListIsValid` after creating a list!
 List ListNew(size_t size, size_t capacity);
 
+// Same as `ListNew()`, but the list draws its memory from `arena` under the
+// given tag instead of the heap. Growing the list extends it in place whenever
+// it is the most recent allocation of that tag. The list lives until the tag
+// (or the whole arena) is released; `ListFree()` only poisons it.
+List ListNewInArena(Arena *arena, ArenaTag tag, size_t size, size_t capacity);
+
 void ListDumpInfo(FILE *handle, const List *self);
 
 // Used to fetch the `i` th element from a list. This will return the memory
@@ -72,7 +83,8 @@ void *ListBack(const List *self);
 // against `LIST_RESULT_OK` or `LIST_RESULT_REALLOCATED`.
 ListResult ListPush(List *self, const void *item);
 
-// Frees the list and poisons it by making it `NULL`.
+// Frees the list and poisons it by making it `NULL`. Arena backed lists are
+// only poisoned, their memory is reclaimed along with the arena.
 ListResult ListFree(List *self);
 
 // Checks if a list is valid, including checks for the actual pointer itself,
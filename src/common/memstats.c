@@ -0,0 +1,160 @@
+#include "memstats.h"
+#include <stdatomic.h>
+#include <stdio.h>
+
+// The counters are atomic so that containers can be grown from several
+// threads. They are only touched on allocation, never on a plain push.
+typedef struct Counters {
+    atomic_size_t inUse;
+    atomic_size_t reserved;
+    atomic_size_t peak;
+    atomic_size_t allocs;
+    atomic_size_t reallocs;
+} Counters;
+
+static Counters counters[MEM_SUBSYSTEM_COUNT];
+
+// -------------------------------------------------------------------------- //
+// MARK: Helpers
+// -------------------------------------------------------------------------- //
+
+static inline bool isValidSubsystem(MemSubsystem sub) {
+    return (unsigned)sub < MEM_SUBSYSTEM_COUNT;
+}
+
+static void addReserved(Counters *c, size_t bytes) {
+    size_t now = atomic_fetch_add_explicit(
+        &c->reserved, bytes, memory_order_relaxed) + bytes;
+
+    // Bump the peak if this is the new high water mark
+    size_t peak = atomic_load_explicit(&c->peak, memory_order_relaxed);
+    while (now > peak
+        && !atomic_compare_exchange_weak_explicit(
+            &c->peak, &peak, now,
+            memory_order_relaxed, memory_order_relaxed))
+    {}
+}
+
+static void subReserved(Counters *c, size_t bytes) {
+    size_t reserved = atomic_load_explicit(&c->reserved, memory_order_relaxed);
+    size_t clamped;
+    do {
+        clamped = bytes > reserved ? 0 : reserved - bytes;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &c->reserved, &reserved, clamped,
+        memory_order_relaxed, memory_order_relaxed));
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Implementation
+// -------------------------------------------------------------------------- //
+
+const char *MemSubsystemStr(MemSubsystem sub) {
+    switch (sub) {
+    #define X(name, str) case name: return str;
+    MEM_SUBSYSTEM_LIST
+    #undef X
+    default: return "<invalid MemSubsystem>";
+    }
+}
+
+void MemStatsNoteAlloc(MemSubsystem sub, size_t bytes) {
+    if (!isValidSubsystem(sub)) return;
+    Counters *c = &counters[sub];
+    atomic_fetch_add_explicit(&c->allocs, 1, memory_order_relaxed);
+    addReserved(c, bytes);
+}
+
+void MemStatsNoteRealloc(MemSubsystem sub, size_t oldBytes, size_t newBytes) {
+    if (!isValidSubsystem(sub)) return;
+    Counters *c = &counters[sub];
+    atomic_fetch_add_explicit(&c->reallocs, 1, memory_order_relaxed);
+    if (newBytes >= oldBytes) addReserved(c, newBytes - oldBytes);
+    else subReserved(c, oldBytes - newBytes);
+}
+
+void MemStatsNoteFree(MemSubsystem sub, size_t bytes) {
+    if (!isValidSubsystem(sub)) return;
+    subReserved(&counters[sub], bytes);
+}
+
+void MemStatsSetInUse(MemSubsystem sub, size_t bytes) {
+    if (!isValidSubsystem(sub)) return;
+    atomic_store_explicit(&counters[sub].inUse, bytes, memory_order_relaxed);
+}
+
+void MemStatsAddInUse(MemSubsystem sub, size_t bytes) {
+    if (!isValidSubsystem(sub)) return;
+    Counters *c = &counters[sub];
+    atomic_fetch_add_explicit(&c->inUse, bytes, memory_order_relaxed);
+}
+
+MemStats MemStatsGet(MemSubsystem sub) {
+    if (!isValidSubsystem(sub)) return (MemStats) {0};
+    Counters *c = &counters[sub];
+
+    MemStats stats = {
+        .inUse    = atomic_load_explicit(&c->inUse, memory_order_relaxed),
+        .reserved = atomic_load_explicit(&c->reserved, memory_order_relaxed),
+        .peak     = atomic_load_explicit(&c->peak, memory_order_relaxed),
+        .allocs   = atomic_load_explicit(&c->allocs, memory_order_relaxed),
+        .reallocs = atomic_load_explicit(&c->reallocs, memory_order_relaxed),
+    };
+    stats.wasted = stats.reserved > stats.inUse
+        ? stats.reserved - stats.inUse
+        : 0;
+    return stats;
+}
+
+void MemStatsReset() {
+    for (size_t i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        Counters *c = &counters[i];
+        atomic_store_explicit(&c->inUse, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->reserved, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->peak, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->allocs, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->reallocs, 0, memory_order_relaxed);
+    }
+}
+
+void MemStatsPrint(FILE *ioStream) {
+    if (!ioStream) {
+        fprintf(stderr, "<MemStatsPrint(): invalid IO stream pointer>\n");
+        return;
+    }
+
+    fprintf(ioStream, "%-12s %12s %12s %12s %12s %8s %8s\n",
+        "subsystem", "in use", "reserved", "peak", "wasted",
+        "allocs", "reallocs");
+
+    MemStats total = {0};
+    for (size_t i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        MemStats s = MemStatsGet((MemSubsystem)i);
+        fprintf(ioStream, "%-12s %12zu %12zu %12zu %12zu %8zu %8zu\n",
+            MemSubsystemStr((MemSubsystem)i), s.inUse, s.reserved, s.peak,
+            s.wasted, s.allocs, s.reallocs);
+
+        total.inUse    += s.inUse;
+        total.reserved += s.reserved;
+        total.peak     += s.peak;
+        total.wasted   += s.wasted;
+        total.allocs   += s.allocs;
+        total.reallocs += s.reallocs;
+    }
+
+    fprintf(ioStream, "%-12s %12zu %12zu %12zu %12zu %8zu %8zu\n",
+        "total", total.inUse, total.reserved, total.peak, total.wasted,
+        total.allocs, total.reallocs);
+}
+
+void MemStatsPrintArena(FILE *ioStream, const Arena *arena) {
+    if (!ioStream || !ArenaIsValid(arena)) {
+        fprintf(stderr, "<MemStatsPrintArena(): invalid stream or arena>\n");
+        return;
+    }
+
+    for (size_t i = 0; i < ARENA_TAG_COUNT; i++) {
+        fprintf(ioStream, "arena %-12s %12zu\n",
+            ArenaTagStr((ArenaTag)i), ArenaBytesUsed(arena, (ArenaTag)i));
+    }
+}
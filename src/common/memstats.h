@@ -0,0 +1,90 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "arena.h"
+
+// -------------------------------------------------------------------------- //
+// MARK: Subsystems
+// -------------------------------------------------------------------------- //
+
+// Every tracked container belongs to exactly one subsystem. Containers that
+// don't care (like scratch vecs in tests) use `MEM_UNTRACKED`.
+#define MEM_SUBSYSTEM_LIST                                                     \
+    X(MEM_UNTRACKED,  "untracked")                                             \
+    X(MEM_TOKENS,     "tokens")                                                \
+    X(MEM_AST_EXPRS,  "ast exprs")                                             \
+    X(MEM_AST_ARGS,   "ast args")                                              \
+    X(MEM_AST_PARAMS, "ast params")                                            \
+    X(MEM_DIAGS,      "diagnostics")                                           \
+    X(MEM_SUBSTRINGS, "substrings")                                            \
+    X(MEM_LINES,      "line index")                                            \
+    X(MEM_SOURCES,    "sources")                                               \
+    X(MEM_SYMBOLS,    "symbols")
+
+typedef enum MemSubsystem {
+    #define X(name, str) name,
+    MEM_SUBSYSTEM_LIST
+    #undef X
+    MEM_SUBSYSTEM_COUNT
+} MemSubsystem;
+
+// Returns the subsystem name as a string.
+const char *MemSubsystemStr(MemSubsystem sub);
+
+// -------------------------------------------------------------------------- //
+// MARK: Stats
+// -------------------------------------------------------------------------- //
+
+// A snapshot of one subsystem's memory use. All quantities are in bytes
+// except the counts.
+// - `inUse` bytes occupied by live elements (as of the last
+// `MemStatsSetInUse()`).
+// - `reserved` bytes currently allocated, i.e. total capacity.
+// - `peak` the largest `reserved` has ever been.
+// - `wasted` capacity that is allocated but not in use.
+// - `allocs` the number of fresh allocations.
+// - `reallocs` the number of times a container had to grow.
+typedef struct MemStats {
+    size_t inUse;
+    size_t reserved;
+    size_t peak;
+    size_t wasted;
+    size_t allocs;
+    size_t reallocs;
+} MemStats;
+
+// Records a fresh allocation of `bytes` for the subsystem.
+void MemStatsNoteAlloc(MemSubsystem sub, size_t bytes);
+
+// Records a container growing from `oldBytes` to `newBytes`.
+void MemStatsNoteRealloc(MemSubsystem sub, size_t oldBytes, size_t newBytes);
+
+// Records `bytes` being handed back.
+void MemStatsNoteFree(MemSubsystem sub, size_t bytes);
+
+// Sets the number of bytes occupied by live elements. Element counts change
+// on every push, so rather than paying for accounting on the hot path, the
+// owners of each container report it on demand (see `TLRecordMemStats()`,
+// `AstRecordMemStats()` and `DERecordMemStats()`).
+void MemStatsSetInUse(MemSubsystem sub, size_t bytes);
+
+// Adds to the number of bytes occupied by live elements. Used by allocations
+// that are exactly sized and never grow, like `SubstringAlloc()`.
+void MemStatsAddInUse(MemSubsystem sub, size_t bytes);
+
+// Returns a snapshot of one subsystem.
+MemStats MemStatsGet(MemSubsystem sub);
+
+// Clears every counter.
+void MemStatsReset();
+
+// Prints a table of every subsystem to the IO stream.
+void MemStatsPrint(FILE *ioStream);
+
+// Prints how many bytes of each arena tag are in use.
+void MemStatsPrintArena(FILE *ioStream, const Arena *arena);
+
+#endif
@@ -0,0 +1,86 @@
+#include "seglist.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// The first segment is capped at 2^24 elements so that `shift` plus the
+// segment index always fits in a `size_t` shift.
+#define MAX_FIRST_SHIFT 24
+
+// -------------------------------------------------------------------------- //
+// MARK: Implementation
+// -------------------------------------------------------------------------- //
+
+unsigned SegListShiftFor(size_t capacity) {
+    unsigned shift = 0;
+    while (shift < MAX_FIRST_SHIFT && ((size_t)1 << shift) < capacity)
+        shift++;
+    return shift;
+}
+
+void *SegListAllocSegment(
+    size_t seg,
+    unsigned shift,
+    size_t size,
+    Arena *arena,
+    ArenaTag tag,
+    MemSubsystem mem
+) {
+    size_t capacity = (size_t)1 << (shift + seg);
+    if (size == 0 || capacity > SIZE_MAX / size) {
+        fprintf(stderr, "<SegListAllocSegment(): overflow>\n");
+        return NULL;
+    }
+
+    void *data = arena
+        ? ArenaAlloc(arena, tag, capacity * size)
+        : malloc(capacity * size);
+    if (!data) {
+        fprintf(stderr, "<SegListAllocSegment(): allocation failure>\n");
+        return NULL;
+    }
+
+    // Adding a segment is this list's equivalent of a realloc (minus the copy)
+    if (seg == 0) MemStatsNoteAlloc(mem, capacity * size);
+    else MemStatsNoteRealloc(mem, 0, capacity * size);
+    return data;
+}
+
+void SegListFreeSegment(
+    void *segment,
+    size_t seg,
+    unsigned shift,
+    size_t size,
+    Arena *arena,
+    MemSubsystem mem
+) {
+    if (!segment)
+        return;
+
+    MemStatsNoteFree(mem, ((size_t)1 << (shift + seg)) * size);
+    if (!arena)
+        free(segment);
+}
+
+void SegListDumpInfo(
+    FILE *handle,
+    const char *name,
+    size_t size,
+    size_t count,
+    size_t segmentCount,
+    unsigned shift
+) {
+    if (!handle) {
+        fprintf(stderr, "<SegListDumpInfo(): invalid handle>\n");
+        return;
+    }
+
+    // Segments hold 2^shift, 2^(shift + 1), ... elements.
+    size_t capacity = (((size_t)1 << segmentCount) - 1) << shift;
+
+    fprintf(handle, "Dumping %s info:\n", name);
+    fprintf(handle, "  Size: %zu\n", size);
+    fprintf(handle, "  Count: %zu\n", count);
+    fprintf(handle, "  Capacity: %zu\n", capacity);
+    fprintf(handle, "  Segments: %zu\n", segmentCount);
+}
@@ -0,0 +1,204 @@
+#ifndef SEGLIST_H
+#define SEGLIST_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+#include "list.h"
+#include "memstats.h"
+
+// The maximum number of segments a seglist can have. Since every segment is
+// twice the size of the one before it, this is never the limiting factor.
+#define SEG_LIST_MAX_SEGMENTS 40
+
+// -------------------------------------------------------------------------- //
+// MARK: SegList
+// -------------------------------------------------------------------------- //
+
+// `DEFINE_SEG_LIST(T)` generates a segmented list specialized for the type
+// `T`, named `T##SegList`. Elements live in a series of power-of-two sized
+// segments, where segment `k` holds `2^(shift + k)` elements. Growing the list
+// only ever allocates a new segment, so:
+// - elements are never moved or copied once pushed.
+// - pointers from `T##SegListGet()` stay valid for the life of the list.
+//
+// Indexing is O(1): adding the size of the first segment to an index makes
+// its highest set bit name the segment and the remaining bits the offset.
+//
+// - `segments` the pointers to each allocated segment.
+// - `segmentCount` how many segments are allocated.
+// - `count` the number of elements in the list.
+// - `shift` log2 of the first segment's size.
+// - `arena` the arena the list draws from, or `NULL` for the heap.
+// - `tag` the arena lifetime the list belongs to (ignored for heap lists).
+// - `mem` the subsystem its allocations are accounted to.
+//
+// Like `Vec`, use `DECLARE_SEG_LIST(T)` and `DEFINE_SEG_LIST_METHODS(T)`
+// separately if the list is needed before `T` is complete.
+#define DEFINE_SEG_LIST(T)                                                     \
+    DECLARE_SEG_LIST(T)                                                        \
+    DEFINE_SEG_LIST_METHODS(T)
+
+#define DECLARE_SEG_LIST(T)                                                    \
+    typedef struct T##SegList {                                                \
+        T *segments[SEG_LIST_MAX_SEGMENTS];                                    \
+        size_t segmentCount;                                                   \
+        size_t count;                                                          \
+        unsigned shift;                                                        \
+        Arena *arena;                                                          \
+        ArenaTag tag;                                                          \
+        MemSubsystem mem;                                                      \
+    } T##SegList;
+
+#define DEFINE_SEG_LIST_METHODS(T)                                             \
+    static inline T##SegList T##SegListNewInArena(                             \
+        Arena *arena, ArenaTag tag, MemSubsystem mem, size_t capacity          \
+    ) {                                                                        \
+        T##SegList list = {                                                    \
+            .shift = SegListShiftFor(capacity),                                \
+            .arena = arena,                                                    \
+            .tag   = tag,                                                      \
+            .mem   = mem,                                                      \
+        };                                                                     \
+        list.segments[0] = SegListAllocSegment(                                \
+            0, list.shift, sizeof(T), arena, tag, mem);                        \
+        if (!list.segments[0]) return (T##SegList) {0};                        \
+        list.segmentCount = 1;                                                 \
+        return list;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline T##SegList T##SegListNew(size_t capacity) {                  \
+        return T##SegListNewInArena(                                           \
+            NULL, ARENA_TAG_MISC, MEM_UNTRACKED, capacity);                    \
+    }                                                                          \
+                                                                               \
+    static inline bool T##SegListIsValid(const T##SegList *self) {             \
+        return self && self->segmentCount > 0 && self->segments[0] != NULL;    \
+    }                                                                          \
+                                                                               \
+    static inline T *T##SegListGet(const T##SegList *self, size_t i) {         \
+        assert(i < self->count);                                               \
+        size_t seg, off;                                                       \
+        SegListLocate(i, self->shift, &seg, &off);                             \
+        return &self->segments[seg][off];                                      \
+    }                                                                          \
+                                                                               \
+    static inline T *T##SegListFront(const T##SegList *self) {                 \
+        assert(self->count > 0);                                               \
+        return &self->segments[0][0];                                          \
+    }                                                                          \
+                                                                               \
+    static inline T *T##SegListBack(const T##SegList *self) {                  \
+        return T##SegListGet(self, self->count - 1);                           \
+    }                                                                          \
+                                                                               \
+    static inline ListResult T##SegListPush(T##SegList *self, const T *item) { \
+        size_t seg, off;                                                       \
+        SegListLocate(self->count, self->shift, &seg, &off);                   \
+        if (seg >= self->segmentCount) {                                       \
+            if (seg >= SEG_LIST_MAX_SEGMENTS) return LIST_RES_OVERFLOW;        \
+            self->segments[seg] = SegListAllocSegment(seg, self->shift,        \
+                sizeof(T), self->arena, self->tag, self->mem);                 \
+            if (!self->segments[seg]) return LIST_RES_ERR;                     \
+            self->segmentCount++;                                              \
+        }                                                                      \
+        /* memcpy rather than assign, `T` may have const members */           \
+        memcpy(&self->segments[seg][off], item, sizeof(T));                    \
+        self->count++;                                                         \
+        return LIST_RES_OK;                                                    \
+    }                                                                          \
+                                                                               \
+    /* Appends `n` items with one memcpy per segment they land in, which is */ \
+    /* a single one unless the block crosses into a new segment. */           \
+    static inline ListResult T##SegListExtend(                                 \
+        T##SegList *self, const T *items, size_t n                             \
+    ) {                                                                        \
+        while (n > 0) {                                                        \
+            size_t seg, off;                                                   \
+            SegListLocate(self->count, self->shift, &seg, &off);               \
+            if (seg >= self->segmentCount) {                                   \
+                if (seg >= SEG_LIST_MAX_SEGMENTS) return LIST_RES_OVERFLOW;    \
+                self->segments[seg] = SegListAllocSegment(seg, self->shift,    \
+                    sizeof(T), self->arena, self->tag, self->mem);             \
+                if (!self->segments[seg]) return LIST_RES_ERR;                 \
+                self->segmentCount++;                                          \
+            }                                                                  \
+            size_t room = ((size_t)1 << (self->shift + seg)) - off;            \
+            size_t take = n < room ? n : room;                                 \
+            memcpy(&self->segments[seg][off], items, take * sizeof(T));        \
+            self->count += take;                                               \
+            items += take;                                                     \
+            n -= take;                                                         \
+        }                                                                      \
+        return LIST_RES_OK;                                                    \
+    }                                                                          \
+                                                                               \
+    /* Drops every element from `count` on, keeping the segments to reuse. */ \
+    static inline void T##SegListTruncate(T##SegList *self, size_t count) {    \
+        if (count < self->count) self->count = count;                          \
+    }                                                                          \
+                                                                               \
+    static inline void T##SegListFree(T##SegList *self) {                      \
+        for (size_t k = 0; k < self->segmentCount; k++)                        \
+            SegListFreeSegment(self->segments[k], k, self->shift, sizeof(T),   \
+                self->arena, self->mem);                                       \
+        *self = (T##SegList) {0};                                              \
+    }                                                                          \
+                                                                               \
+    static inline void T##SegListDumpInfo(                                     \
+        FILE *handle, const T##SegList *self                                   \
+    ) {                                                                        \
+        SegListDumpInfo(handle, #T "SegList", sizeof(T), self->count,          \
+            self->segmentCount, self->shift);                                  \
+    }
+
+// -------------------------------------------------------------------------- //
+// MARK: Index Math
+// -------------------------------------------------------------------------- //
+
+// Maps index `i` to its segment and the offset inside that segment.
+static inline void SegListLocate(
+    size_t i,
+    unsigned shift,
+    size_t *seg,
+    size_t *off
+) {
+    size_t j = i + ((size_t)1 << shift);
+#if defined(__GNUC__) || defined(__clang__)
+    unsigned hb = (unsigned)(sizeof(unsigned long long) * 8 - 1)
+        - (unsigned)__builtin_clzll((unsigned long long)j);
+#else
+    unsigned hb = 0;
+    while ((j >> hb) > 1) hb++;
+#endif
+    *seg = hb - shift;
+    *off = j ^ ((size_t)1 << hb);
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Out-of-line Helpers
+// * These are shared by every generated seglist and should not be called
+// * directly.
+// -------------------------------------------------------------------------- //
+
+// Returns log2 of the first segment size for the requested capacity (rounded
+// up to a power of two, and at least 1).
+unsigned SegListShiftFor(size_t capacity);
+
+// Allocates segment number `seg`, which holds `2^(shift + seg)` elements of
+// `size` bytes.
+void *SegListAllocSegment(size_t seg, unsigned shift, size_t size,
+    Arena *arena, ArenaTag tag, MemSubsystem mem);
+
+// Frees a heap backed segment. Arena backed segments are left for the arena.
+void SegListFreeSegment(void *segment, size_t seg, unsigned shift,
+    size_t size, Arena *arena, MemSubsystem mem);
+
+// Prints the count, capacity, segment count and element size of a seglist.
+void SegListDumpInfo(FILE *handle, const char *name, size_t size,
+    size_t count, size_t segmentCount, unsigned shift);
+
+#endif
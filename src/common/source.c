@@ -1,27 +1,498 @@
+#define _DEFAULT_SOURCE
 #include "source.h"
+#include "memstats.h"
+#include "seglist.h"
+#include "vec.h"
+#include "hash.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 #define STATIC_PATH_NAME "<static_data>"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// -------------------------------------------------------------------------- //
+// MARK: Source Manager
+// * Every source is registered when it is created, given a compact `FileId`
+// * and a range in the global offset space, which is what lets a span be
+// * only an offset and a length. Ids are never reused (freed sources are just
+// * marked dead), so they stay dense and the entry pointers stay stable. The
+// * offset ranges of freed sources are handed out again, `ranges` keeps the
+// * live ones sorted by base.
+// -------------------------------------------------------------------------- //
+
+// - `reserve` the number of offsets past `base` reserved for the source, its
+// contents may grow up to that many bytes without moving.
+// - `path` the canonical path, owned by the manager (managed entries only).
+// - `contentHash` hash of the data, computed the first time a duplicate is
+// looked for (if `hashed`).
+// - `canonical` the first managed file with identical contents, once
+// `resolved` (see `SMCanonicalFile()`). Its line index is shared with every
+// duplicate, which is noted in its `shared`.
+// - `managed` whether the manager owns the data, as opposed to the caller of
+// `SourceNew*()`.
+// - `firstLine` and `firstCol` the position of the first byte of `data` in
+// the whole input, for window sources (zero otherwise, see `SMSetWindow()`).
+typedef struct SourceEntry {
+    Source source;
+    uint32_t reserve;
+    char *path;
+    uint64_t contentHash;
+    FileId canonical;
+    uint32_t *lineStarts;
+    size_t lineCount;
+    size_t firstLine;
+    size_t firstCol;
+    bool hashed;
+    bool resolved;
+    bool shared;
+    bool live;
+    bool managed;
+} SourceEntry;
+
+DEFINE_SEG_LIST(SourceEntry)
+DEFINE_VEC(FileId)
+
+// Open addressed `hash -> FileId` table. An id of `NULL_FILE_ID` marks an
+// empty slot, there are no deletions (dead entries never match).
+typedef struct FileSlot {
+    uint64_t hash;
+    FileId id;
+} FileSlot;
+
+typedef struct FileTable {
+    FileSlot *slots;
+    size_t capacity;
+    size_t count;
+} FileTable;
+
+typedef struct SourceManager {
+    SourceEntrySegList entries;
+    FileIdVec ranges;
+    FileTable byPath;
+    uint32_t generation;
+} SourceManager;
+
+// Spans are resolved without any context, so there is a single manager per
+// process. Registering sources is not thread safe, resolving spans is.
+static SourceManager manager = {0};
+
+// Most lookups hit the same source as the one before. Only trusted while the
+// manager is in the generation it was cached in, which changes whenever a
+// range is released.
+static _Thread_local SourceEntry *lastHit = NULL;
+static _Thread_local uint32_t lastHitGeneration = 0;
+
+#define INIT_FILE_TABLE_CAP 64
+
+static inline SourceEntry *entryOf(FileId id) {
+    if (id == NULL_FILE_ID || id > manager.entries.count) return NULL;
+    return SourceEntrySegListGet(&manager.entries, id - 1);
+}
+
+static bool tableInsert(FileTable *self, uint64_t hash, FileId id) {
+    // Keep the load factor at or below one half
+    if ((self->count + 1) * 2 > self->capacity) {
+        size_t capacity = self->capacity ? self->capacity * 2
+            : INIT_FILE_TABLE_CAP;
+        FileSlot *slots = calloc(capacity, sizeof(FileSlot));
+        if (!slots) {
+            fprintf(stderr, "<tableInsert(): allocation failure>\n");
+            return false;
+        }
+        if (self->capacity == 0)
+            MemStatsNoteAlloc(MEM_SOURCES, capacity * sizeof(FileSlot));
+        else
+            MemStatsNoteRealloc(MEM_SOURCES, self->capacity * sizeof(FileSlot),
+                capacity * sizeof(FileSlot));
+
+        for (size_t i = 0; i < self->capacity; i++) {
+            if (self->slots[i].id == NULL_FILE_ID) continue;
+            size_t j = self->slots[i].hash & (capacity - 1);
+            while (slots[j].id != NULL_FILE_ID) j = (j + 1) & (capacity - 1);
+            slots[j] = self->slots[i];
+        }
+        free(self->slots);
+        self->slots    = slots;
+        self->capacity = capacity;
+    }
+
+    size_t j = hash & (self->capacity - 1);
+    while (self->slots[j].id != NULL_FILE_ID)
+        j = (j + 1) & (self->capacity - 1);
+    self->slots[j] = (FileSlot) { hash, id };
+    self->count++;
+    return true;
+}
+
+// Returns the first id in the table with a matching hash for which `match`
+// returns true, or `NULL_FILE_ID`.
+static FileId tableFind(
+    const FileTable *self,
+    uint64_t hash,
+    bool (*match)(const SourceEntry *entry, const void *key),
+    const void *key
+) {
+    if (self->capacity == 0) return NULL_FILE_ID;
+    for (size_t j = hash & (self->capacity - 1);
+         self->slots[j].id != NULL_FILE_ID;
+         j = (j + 1) & (self->capacity - 1))
+    {
+        if (self->slots[j].hash == hash
+            && match(entryOf(self->slots[j].id), key))
+            return self->slots[j].id;
+    }
+    return NULL_FILE_ID;
+}
+
+static void tableFree(FileTable *self) {
+    MemStatsNoteFree(MEM_SOURCES, self->capacity * sizeof(FileSlot));
+    free(self->slots);
+    *self = (FileTable) {0};
+}
+
+static bool matchPath(const SourceEntry *entry, const void *key) {
+    return entry->live && strcmp(entry->path, (const char *)key) == 0;
+}
+
+// Returns the number of live ranges with a base at or before `offset`.
+static size_t rangesUpTo(uint32_t offset) {
+    size_t lo = 0, hi = manager.ranges.count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entryOf(manager.ranges.data[mid])->source.base <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Finds the first free range of `reserve + 1` offsets, every source reserves
+// one extra offset so that a span may point just past its last byte (i.e. at
+// EOF). Base 0 is never handed out so that a zeroed span points nowhere.
+static bool findRange(size_t reserve, uint32_t *base) {
+    uint64_t start = 1;
+    for (size_t i = 0; i < manager.ranges.count; i++) {
+        const SourceEntry *next = entryOf(manager.ranges.data[i]);
+        if (next->source.base - start > reserve) break;
+        start = (uint64_t)next->source.base + next->reserve + 1;
+    }
+
+    if (reserve > UINT32_MAX || start + reserve > UINT32_MAX) {
+        fprintf(stderr, "<findRange(): sources exceed 4 GiB>\n");
+        return false;
+    }
+    *base = (uint32_t)start;
+    return true;
+}
+
+// Gives `entry` the range at `base`, which must be free.
+static bool insertRange(SourceEntry *entry, uint32_t base, size_t reserve) {
+    if (!FileIdVecIsValid(&manager.ranges)) {
+        manager.ranges = FileIdVecNewInArena(
+            NULL, ARENA_TAG_MISC, MEM_SOURCES, 16);
+        if (!FileIdVecIsValid(&manager.ranges)) return false;
+    }
+
+    const size_t at = rangesUpTo(base);
+    const FileId id = entry->source.id;
+    if (FileIdVecPush(&manager.ranges, &id) == LIST_RES_ERR) {
+        fprintf(stderr, "<insertRange(): cannot reserve offsets>\n");
+        return false;
+    }
+    FileId *ranges = manager.ranges.data;
+    memmove(&ranges[at + 1], &ranges[at],
+        (manager.ranges.count - 1 - at) * sizeof(FileId));
+    ranges[at] = id;
+
+    // Silly workaround to avoid making Source members non-const.
+    memcpy((void *)&entry->source.base, &base, sizeof(uint32_t));
+    entry->reserve = (uint32_t)reserve;
+    return true;
+}
+
+// Hands the range of `entry` back, spans into it no longer resolve.
+static void removeRange(const SourceEntry *entry) {
+    const size_t at = rangesUpTo(entry->source.base);
+    FileId *ranges = manager.ranges.data;
+    if (at == 0 || ranges[at - 1] != entry->source.id)
+        return;
+
+    memmove(&ranges[at - 1], &ranges[at],
+        (manager.ranges.count - at) * sizeof(FileId));
+    manager.ranges.count--;
+    manager.generation++;
+}
+
+// Makes room for `length` bytes in the range of `entry`. A range that is too
+// small grows in place if the offsets after it are free, and moves otherwise.
+// Either way it at least doubles, so a source that keeps growing only moves
+// a handful of times.
+static bool fitRange(SourceEntry *entry, size_t length) {
+    if (length <= entry->reserve)
+        return true;
+
+    size_t reserve = (size_t)entry->reserve * 2;
+    if (reserve < length) reserve = length;
+
+    const uint32_t base = entry->source.base;
+    const size_t after = rangesUpTo(base);
+    const uint64_t limit = after < manager.ranges.count
+        ? entryOf(manager.ranges.data[after])->source.base
+        : (uint64_t)UINT32_MAX + 1;
+    if (base + (uint64_t)reserve < limit) {
+        entry->reserve = (uint32_t)reserve;
+        return true;
+    }
+    if (base + (uint64_t)length < limit) {
+        entry->reserve = (uint32_t)length;
+        return true;
+    }
+
+    uint32_t moved = 0;
+    if (!findRange(reserve, &moved)) {
+        reserve = length;
+        if (!findRange(reserve, &moved)) return false;
+    }
+    removeRange(entry);
+    if (insertRange(entry, moved, reserve))
+        return true;
+
+    /* discard */ insertRange(entry, base, entry->reserve);
+    return false;
+}
+
+// Appends an entry for `src`, assigning its id and base, and reserves
+// `reserve` offsets for it. Returns `NULL` if the offset space is exhausted.
+static SourceEntry *addEntry(Source src, size_t reserve) {
+    if (!SourceEntrySegListIsValid(&manager.entries)) {
+        manager.entries = SourceEntrySegListNewInArena(
+            NULL, ARENA_TAG_MISC, MEM_SOURCES, 16);
+        if (!SourceEntrySegListIsValid(&manager.entries)) return NULL;
+    }
+
+    uint32_t base = 0;
+    if (!findRange(reserve, &base))
+        return NULL;
+
+    // Silly workaround to avoid making Source members non-const.
+    const FileId id = (FileId)manager.entries.count + 1;
+    memcpy((void *)&src.id, &id, sizeof(FileId));
+
+    const SourceEntry entry = { .source = src, .canonical = id, .live = true };
+    if (SourceEntrySegListPush(&manager.entries, &entry) != LIST_RES_OK) {
+        fprintf(stderr, "<addEntry(): cannot register source>\n");
+        return NULL;
+    }
+
+    SourceEntry *added = SourceEntrySegListBack(&manager.entries);
+    if (!insertRange(added, base, reserve)) {
+        SourceEntrySegListTruncate(&manager.entries, id - 1);
+        return NULL;
+    }
+    return added;
+}
+
+static Source registerSource(Source src) {
+    SourceEntry *entry = addEntry(src, src.length);
+    return entry ? entry->source : (Source) {0};
+}
+
+// Finds the live entry whose offset range contains `offset`.
+static SourceEntry *findEntry(uint32_t offset) {
+    SourceEntry *hit = lastHit;
+    if (hit
+        && lastHitGeneration == manager.generation
+        && offset >= hit->source.base
+        && offset - hit->source.base <= hit->source.length)
+        return hit;
+
+    const size_t at = rangesUpTo(offset);
+    if (at == 0)
+        return NULL;
+
+    SourceEntry *entry = entryOf(manager.ranges.data[at - 1]);
+    if (offset - entry->source.base > entry->source.length)
+        return NULL;
+
+    lastHit           = entry;
+    lastHitGeneration = manager.generation;
+    return entry;
+}
+
+static SourceEntry *findLiveEntry(const Source *src) {
+    if (!src || src->id == NULL_FILE_ID) return NULL;
+    SourceEntry *entry = entryOf(src->id);
+    if (!entry || !entry->live || entry->source.base != src->base)
+        return NULL;
+    return entry;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Line Index
+// -------------------------------------------------------------------------- //
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+// Counts the newlines in `data`, 16 bytes at a time.
+static size_t countNewlines(const char *data, size_t length) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    size_t count = 0, i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+        count += (size_t)__builtin_popcount(mask);
+    }
+    for (; i < length; i++)
+        count += data[i] == '\n';
+    return count;
+}
+
+// Writes the offset following every newline in `data` to `out`.
+static void fillLineStarts(const char *data, size_t length, uint32_t *out) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+        while (mask) {
+            *out++ = (uint32_t)(i + (size_t)__builtin_ctz(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+    for (; i < length; i++)
+        if (data[i] == '\n') *out++ = (uint32_t)(i + 1);
+}
+
+#else
+
+static size_t countNewlines(const char *data, size_t length) {
+    size_t count = 0;
+    const char *end = data + length;
+    const char *p = data;
+    while ((p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+static void fillLineStarts(const char *data, size_t length, uint32_t *out) {
+    const char *end = data + length;
+    const char *p = data;
+    while ((p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        p++;
+        *out++ = (uint32_t)(p - data);
+    }
+}
+
+#endif
+
+// Builds the line-start index of an entry if it doesn't have one yet. Line
+// `n` (zero based) begins at `lineStarts[n]`.
+static bool buildLineIndex(SourceEntry *entry) {
+    if (entry->lineStarts)
+        return true;
+
+    const Source *src = &entry->source;
+    size_t count = countNewlines(src->data, src->length) + 1;
+    uint32_t *starts = malloc(count * sizeof(uint32_t));
+    if (!starts) {
+        fprintf(stderr, "<buildLineIndex(): allocation failure>\n");
+        return false;
+    }
+
+    starts[0] = 0;
+    fillLineStarts(src->data, src->length, starts + 1);
+
+    MemStatsNoteAlloc(MEM_LINES, count * sizeof(uint32_t));
+    MemStatsAddInUse(MEM_LINES, count * sizeof(uint32_t));
+
+    entry->lineStarts = starts;
+    entry->lineCount  = count;
+    return true;
+}
+
+static void freeLineIndex(SourceEntry *entry) {
+    if (!entry->lineStarts)
+        return;
+
+    size_t bytes = entry->lineCount * sizeof(uint32_t);
+    MemStatsNoteFree(MEM_LINES, bytes);
+    MemStatsAddInUse(MEM_LINES, (size_t)0 - bytes); // wraps, i.e. subtracts
+    free(entry->lineStarts);
+    entry->lineStarts = NULL;
+    entry->lineCount  = 0;
+}
+
+static bool entryLineCol(
+    SourceEntry *entry,
+    size_t offset,
+    size_t *line,
+    size_t *col
+) {
+    if (offset > entry->source.length)
+        return false;
+
+    // Duplicates share the line index of the first file with their contents
+    entry = entryOf(entry->canonical);
+    if (!buildLineIndex(entry))
+        return false;
+
+    // Find the last line starting at or before `offset`
+    size_t lo = 0, hi = entry->lineCount;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entry->lineStarts[mid] <= offset) lo = mid;
+        else hi = mid;
+    }
+
+    // A window may begin part way through a line
+    size_t firstCol = lo == 0 ? entry->firstCol : 0;
+    if (line) *line = entry->firstLine + lo + 1;
+    if (col)  *col  = firstCol + offset - entry->lineStarts[lo] + 1;
+    return true;
+}
+
 // -------------------------------------------------------------------------- //
 // MARK: Span
 // -------------------------------------------------------------------------- //
 
+const Source *SpanSource(const Span *span) {
+    if (!span || span->offset == 0) return NULL;
+    SourceEntry *entry = findEntry(span->offset);
+    if (!entry || !entry->live) return NULL;
+    return &entry->source;
+}
+
+bool SpanLineCol(const Span *span, size_t *line, size_t *col) {
+    if (!span || span->offset == 0) return false;
+    SourceEntry *entry = findEntry(span->offset);
+    if (!entry || !entry->live) return false;
+    return entryLineCol(entry, span->offset - entry->source.base, line, col);
+}
+
 Substring SpanSubstring(const Span *span) {
-    if (!span || !span->src ) return NULL_SUBSTRING;
+    const Source *src = SpanSource(span);
+    if (!src) return NULL_SUBSTRING;
 
-    assert(span->offset + span->length <= span->src->length);
+    size_t offset = span->offset - src->base;
 
     // Check if the span is in bounds and return NULL if not.
-    if (span->offset > span->src->length
-        || span->offset + span->length > span->src->length)
+    if (offset + span->length > src->length)
         return NULL_SUBSTRING;
 
-    const char *startptr = span->src->data + span->offset;
     return (Substring) {
-        .data = startptr,
+        .data = src->data + offset,
         .length = span->length
     };
 }
@@ -32,18 +503,21 @@ size_t SpanEnd(const Span *span) {
         return 0;
     }
 
-    return span->offset + span->length;
+    return (size_t)span->offset + span->length;
 }
 
 Span SpanMerge(const Span *lhs, const Span *rhs) {
     if (!lhs || !rhs) {
         fprintf(stderr, "<NULL span pointers in SpanMerge>\n");
-        return (Span) {0};
+        return NULL_SPAN;
     }
 
-    if (lhs->src != rhs->src) {
+    // Offsets are global, spans of different sources never touch. Checking
+    // that both ends land in the same source is just a range check.
+    const SourceEntry *lhsEntry = findEntry(lhs->offset);
+    if (!lhsEntry || lhsEntry != findEntry(rhs->offset)) {
         fprintf(stderr, "<cannot merge spans of different sources>\n");
-        return (Span) {0};
+        return NULL_SPAN;
     }
 
     // Store whichever span comes "first" in the file.
@@ -56,15 +530,9 @@ Span SpanMerge(const Span *lhs, const Span *rhs) {
 
     assert(end >= min->offset);
 
-    // Then compute the length from that.
-    size_t length = end - min->offset;
-
     return (Span) {
-        .src = min->src,
         .offset = min->offset,
-        .length = length,
-        .x = min->x,
-        .y = min->y,
+        .length = (uint32_t)(end - min->offset),
     };
 }
 
@@ -73,13 +541,440 @@ Span SpanMerge(const Span *lhs, const Span *rhs) {
 // -------------------------------------------------------------------------- //
 
 Source SourceNewFromData(const char *data) {
-    return (Source) {
+    if (!data) return (Source) {0};
+    return registerSource((Source) {
         .data = data,
         .path = STATIC_PATH_NAME,
-        .length = strlen(data)
+        .length = strlen(data),
+        .mapLength = 0,
+    });
+}
+
+Source SourceNewFromBuffer(const char *data, size_t length, const char *path) {
+    if (!data) return (Source) {0};
+    return registerSource((Source) {
+        .data = data,
+        .path = path ? path : STATIC_PATH_NAME,
+        .length = length,
+        .mapLength = 0,
+    });
+}
+
+#ifdef _WIN32
+
+// No `mmap`, read the file into a zero padded buffer instead.
+static Source loadFile(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "<SourceNewFromFile(): cannot open '%s'>\n", path);
+        return (Source) {0};
+    }
+
+    // Find the file size
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0 || (uint64_t)size > SIZE_MAX - SOURCE_GUARD_SIZE) {
+        fclose(file);
+        return (Source) {0};
+    }
+
+    size_t mapLength = (size_t)size + SOURCE_GUARD_SIZE;
+    char *data = calloc(mapLength, 1);
+    if (!data || fread(data, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "<SourceNewFromFile(): cannot read '%s'>\n", path);
+        free(data);
+        fclose(file);
+        return (Source) {0};
+    }
+    fclose(file);
+
+    return (Source) {
+        .data = data,
+        .path = path,
+        .length = (size_t)size,
+        .mapLength = mapLength,
     };
 }
 
+static void unloadFile(const Source *src) {
+    if (src->mapLength > 0)
+        free((void *)src->data);
+}
+
+static char *canonicalPath(const char *path) {
+    char *canon = _fullpath(NULL, path, 0);
+    if (!canon)
+        fprintf(stderr, "<SMOpenFile(): cannot resolve '%s'>\n", path);
+    return canon;
+}
+
+#else
+
+static Source loadFile(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "<SourceNewFromFile(): cannot open '%s'>\n", path);
+        return (Source) {0};
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "<SourceNewFromFile(): '%s' is not a file>\n", path);
+        close(fd);
+        return (Source) {0};
+    }
+
+    //
+    // Reserve the file length plus the guard region as anonymous zero pages,
+    // then map the file over the front of it. The tail of the last file page
+    // is zero filled by the kernel and the guard pages are anonymous, so
+    // everything past `length` reads as zero.
+    //
+    size_t length    = (size_t)st.st_size;
+    size_t pageSize  = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapLength =
+        (length + SOURCE_GUARD_SIZE + pageSize - 1) / pageSize * pageSize;
+
+    char *base = mmap(NULL, mapLength, PROT_READ,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "<SourceNewFromFile(): cannot map '%s'>\n", path);
+        close(fd);
+        return (Source) {0};
+    }
+
+    if (length > 0) {
+        void *file = mmap(base, length, PROT_READ,
+            MAP_PRIVATE | MAP_FIXED, fd, 0);
+        if (file == MAP_FAILED) {
+            fprintf(stderr, "<SourceNewFromFile(): cannot map '%s'>\n", path);
+            munmap(base, mapLength);
+            close(fd);
+            return (Source) {0};
+        }
+
+        // The scanner reads front to back
+        madvise(base, length, MADV_SEQUENTIAL);
+    }
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+
+    return (Source) {
+        .data = base,
+        .path = path,
+        .length = length,
+        .mapLength = mapLength,
+    };
+}
+
+static void unloadFile(const Source *src) {
+    if (src->mapLength > 0)
+        munmap((void *)src->data, src->mapLength);
+}
+
+static char *canonicalPath(const char *path) {
+    char *canon = realpath(path, NULL);
+    if (!canon)
+        fprintf(stderr, "<SMOpenFile(): cannot resolve '%s'>\n", path);
+    return canon;
+}
+
+#endif
+
+Source SourceNewFromFile(const char *path) {
+    if (!path) return (Source) {0};
+
+    Source file = loadFile(path);
+    if (!SourceIsValid(&file)) return (Source) {0};
+
+    Source src = registerSource(file);
+    if (!SourceIsValid(&src)) unloadFile(&file);
+    return src;
+}
+
+void SourceFree(Source *self) {
+    if (!self) return;
+
+    // Managed sources are released by `SMCloseFile()` or `SMRelease()`
+    SourceEntry *entry = findLiveEntry(self);
+    if (entry && !entry->managed) {
+        freeLineIndex(entry);
+        removeRange(entry);
+        entry->live = false;
+        unloadFile(self);
+    } else if (!entry) {
+        unloadFile(self);
+    }
+
+    // Silly workaround to avoid making Source members non-const.
+    const Source poison = {0};
+    memcpy(self, &poison, sizeof(Source));
+}
+
+bool SourceIsValid(const Source *self) {
+    return self && self->data != NULL && self->path != NULL;
+}
+
+bool SourceLineCol(
+    const Source *self,
+    size_t offset,
+    size_t *line,
+    size_t *col
+) {
+    SourceEntry *entry = findLiveEntry(self);
+    if (!entry) {
+        fprintf(stderr, "<SourceLineCol(): unregistered source>\n");
+        return false;
+    }
+    return entryLineCol(entry, offset, line, col);
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Source Manager API
+// -------------------------------------------------------------------------- //
+
+// Registers a source owned by the manager under the canonical `path`, which
+// is taken over.
+static FileId manage(const Source *file, char *path) {
+    const Source src = {
+        .data = file->data,
+        .path = path,
+        .length = file->length,
+        .mapLength = file->mapLength,
+    };
+
+    SourceEntry *entry = addEntry(src, src.length);
+    if (!entry) {
+        unloadFile(&src);
+        free(path);
+        return NULL_FILE_ID;
+    }
+
+    entry->path    = path;
+    entry->managed = true;
+    FileId id = entry->source.id;
+
+    /* discard */ tableInsert(&manager.byPath, HashBytes(path, strlen(path)),
+        id);
+    return id;
+}
+
+static uint64_t contentHashOf(SourceEntry *entry) {
+    if (!entry->hashed) {
+        entry->contentHash = HashBytes(entry->source.data, entry->source.length);
+        entry->hashed = true;
+    }
+    return entry->contentHash;
+}
+
+// Looks for the first live managed entry with the same contents as `entry`.
+// Only entries of the same length are hashed, each at most once for as long
+// as its contents stay the same.
+static void resolveCanonical(SourceEntry *entry) {
+    const FileId id = entry->source.id;
+    for (FileId other = 1; other < id; other++) {
+        SourceEntry *candidate = entryOf(other);
+        if (!candidate->live || !candidate->managed
+            || candidate->source.length != entry->source.length
+            || contentHashOf(candidate) != contentHashOf(entry)
+            || memcmp(candidate->source.data, entry->source.data,
+                entry->source.length) != 0)
+            continue;
+
+        entry->canonical  = other;
+        candidate->shared = true;
+        break;
+    }
+    entry->resolved = true;
+}
+
+// The contents of `entry` are about to change (or go away), so are its hash
+// and whichever files were found to be duplicates of it.
+static void forgetContents(SourceEntry *entry) {
+    const FileId id = entry->source.id;
+    for (size_t i = 0; entry->shared && i < manager.entries.count; i++) {
+        SourceEntry *other = SourceEntrySegListGet(&manager.entries, i);
+        if (other == entry || other->canonical != id) continue;
+        other->canonical = other->source.id;
+        other->resolved  = false;
+    }
+
+    entry->canonical = id;
+    entry->hashed    = false;
+    entry->resolved  = false;
+    entry->shared    = false;
+}
+
+static char *copyString(const char *str) {
+    size_t length = strlen(str) + 1;
+    char *copy = malloc(length);
+    if (copy) memcpy(copy, str, length);
+    return copy;
+}
+
+FileId SMOpenFile(const char *path) {
+    if (!path) return NULL_FILE_ID;
+
+    char *canon = canonicalPath(path);
+    if (!canon) return NULL_FILE_ID;
+
+    // Already loaded?
+    FileId id = tableFind(&manager.byPath, HashBytes(canon, strlen(canon)),
+        matchPath, canon);
+    if (id != NULL_FILE_ID) {
+        free(canon);
+        return id;
+    }
+
+    const Source src = loadFile(canon);
+    if (!SourceIsValid(&src)) {
+        free(canon);
+        return NULL_FILE_ID;
+    }
+    return manage(&src, canon);
+}
+
+FileId SMAddBuffer(const char *data, size_t length, const char *path) {
+    if (!data) return NULL_FILE_ID;
+    char *name = copyString(path ? path : STATIC_PATH_NAME);
+    if (!name) return NULL_FILE_ID;
+
+    // Buffers are named, not resolved, the name is the identity
+    FileId id = tableFind(&manager.byPath, HashBytes(name, strlen(name)),
+        matchPath, name);
+    if (id != NULL_FILE_ID) {
+        free(name);
+        return SMReplaceBuffer(id, data, length) ? id : NULL_FILE_ID;
+    }
+
+    const Source src = { .data = data, .path = name, .length = length };
+    return manage(&src, name);
+}
+
+bool SMReplaceBuffer(FileId id, const char *data, size_t length) {
+    SourceEntry *entry = entryOf(id);
+    if (!data || !entry || !entry->live || !entry->managed) {
+        fprintf(stderr, "<SMReplaceBuffer(): not a managed source>\n");
+        return false;
+    }
+    if (!fitRange(entry, length))
+        return false;
+
+    // The old line index and hash describe the old data
+    forgetContents(entry);
+    freeLineIndex(entry);
+    unloadFile(&entry->source);
+
+    // Silly workaround to avoid making Source members non-const.
+    const size_t mapLength = 0;
+    memcpy((void *)&entry->source.data, &data, sizeof(const char *));
+    memcpy((void *)&entry->source.length, &length, sizeof(size_t));
+    memcpy((void *)&entry->source.mapLength, &mapLength, sizeof(size_t));
+    return true;
+}
+
+void SMCloseFile(FileId id) {
+    SourceEntry *entry = entryOf(id);
+    if (!entry || !entry->live || !entry->managed)
+        return;
+
+    forgetContents(entry);
+    freeLineIndex(entry);
+    removeRange(entry);
+    unloadFile(&entry->source);
+    free(entry->path);
+    entry->path = NULL;
+    entry->live = false;
+}
+
+const Source *SMGetSource(FileId id) {
+    const SourceEntry *entry = entryOf(id);
+    if (!entry || !entry->live) return NULL;
+    return &entry->source;
+}
+
+FileId SMCanonicalFile(FileId id) {
+    SourceEntry *entry = entryOf(id);
+    if (!entry || !entry->live) return NULL_FILE_ID;
+    if (entry->managed && !entry->resolved)
+        resolveCanonical(entry);
+    return entry->canonical;
+}
+
+FileId SMLocate(uint32_t offset, size_t *localOffset) {
+    const SourceEntry *entry = offset ? findEntry(offset) : NULL;
+    if (!entry || !entry->live) return NULL_FILE_ID;
+    if (localOffset) *localOffset = offset - entry->source.base;
+    return entry->source.id;
+}
+
+FileId SMAddWindow(const char *path, size_t reserve) {
+    const Source src = {
+        .data = "",
+        .path = path ? path : STATIC_PATH_NAME,
+        .length = 0,
+    };
+    SourceEntry *entry = addEntry(src, reserve);
+    return entry ? entry->source.id : NULL_FILE_ID;
+}
+
+bool SMSetWindow(
+    FileId id,
+    const char *data,
+    size_t length,
+    size_t firstLine,
+    size_t firstCol
+) {
+    SourceEntry *entry = entryOf(id);
+    if (!entry || !entry->live || entry->managed) {
+        fprintf(stderr, "<SMSetWindow(): not a window source>\n");
+        return false;
+    }
+
+    // The window may not grow into the next source's offsets
+    if (length > entry->reserve) {
+        fprintf(stderr, "<SMSetWindow(): window exceeds its reservation>\n");
+        return false;
+    }
+
+    // The old line index describes the old data
+    freeLineIndex(entry);
+    if (!data) {
+        removeRange(entry);
+        entry->live = false;
+        return true;
+    }
+
+    // Silly workaround to avoid making Source members non-const.
+    memcpy((void *)&entry->source.data, &data, sizeof(const char *));
+    memcpy((void *)&entry->source.length, &length, sizeof(size_t));
+    entry->firstLine = firstLine;
+    entry->firstCol  = firstCol;
+    return true;
+}
+
+size_t SMFileCount() {
+    return manager.entries.count;
+}
+
+void SMRelease() {
+    for (size_t i = 0; i < manager.entries.count; i++) {
+        SourceEntry *entry = SourceEntrySegListGet(&manager.entries, i);
+        freeLineIndex(entry);
+        if (entry->managed && entry->live) {
+            unloadFile(&entry->source);
+            free(entry->path);
+        }
+    }
+
+    SourceEntrySegListFree(&manager.entries);
+    FileIdVecFree(&manager.ranges);
+    tableFree(&manager.byPath);
+    manager = (SourceManager) { .generation = manager.generation + 1 };
+}
+
 bool SubstringIsNull(const Substring *str) {
     return str == NULL || str->length == 0 || str->data == NULL;
 }
@@ -137,6 +1032,9 @@ char *SubstringAlloc(const Substring *self) {
     char *data = malloc(sizeof(char) * allocatedLength);
     if (!data) return NULL;
 
+    MemStatsNoteAlloc(MEM_SUBSTRINGS, allocatedLength);
+    MemStatsAddInUse(MEM_SUBSTRINGS, allocatedLength);
+
     // Copy data
     memcpy(data, self->data, self->length);
 
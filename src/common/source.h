@@ -2,29 +2,82 @@
 #define SOURCE_H
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #define NULL_SUBSTRING (Substring) { .data = NULL, .length = 0 }
 
+// The number of zero bytes guaranteed to follow the data of a file backed
+// source. Lets the scanner read a little past the end without checks.
+#define SOURCE_GUARD_SIZE 64
+
 // -------------------------------------------------------------------------- //
 // MARK: Source
 // -------------------------------------------------------------------------- //
 
+// A compact handle to a registered source. Ids are dense and start at 1,
+// `NULL_FILE_ID` refers to no file.
+typedef uint32_t FileId;
+
+#define NULL_FILE_ID 0
+
 // Contains the information for a single translation unit's source code,
 // including the source code in bytes, the path name, and the size of the
 // source code.
-// 
-// Sources made from a static string (like for testing) have `NULL` path.
+// - `mapLength` is the number of bytes mapped (or allocated) for `data`,
+// including the guard region. It is zero when the source does not own
+// `data`, i.e. for static strings.
+// - `base` is where the source begins in the global offset space shared by
+// every span (see `Span`). Assigned when the source is created, and only
+// moved when its contents are replaced by more than fit its reservation
+// (see `SMReplaceBuffer()`).
+// - `id` the file id the source was registered under.
+//
+// `data` is not required to be null terminated, always use `length`.
+// Sources made from a static string (like for testing) have a placeholder
+// path.
 typedef struct Source {
     const char * data;
     const char * path;
     const size_t length;
+    const size_t mapLength;
+    const uint32_t base;
+    const FileId id;
 } Source;
 
 /* Creates a new source from the provided static string.
  */
 Source SourceNewFromData(const char *data);
 
+// Creates a new source from `length` bytes of static data. Unlike
+// `SourceNewFromData()`, `data` does not need to be null terminated.
+// If `path` is `NULL` a placeholder is used.
+Source SourceNewFromBuffer(const char *data, size_t length, const char *path);
+
+// Creates a new source by memory mapping the file at `path` read-only. The
+// file is never copied: pages are loaded on demand and shared with any other
+// process mapping the same file. The mapping is followed by at least
+// `SOURCE_GUARD_SIZE` zero bytes.
+//
+// `path` is borrowed and must outlive the source. Check the result with
+// `SourceIsValid()`, and release it with `SourceFree()`.
+Source SourceNewFromFile(const char *path);
+
+// Unmaps (or frees) the data of a file backed source and poisons it. Does
+// nothing to the data of static sources, or of sources owned by the source
+// manager.
+void SourceFree(Source *self);
+
+// Returns whether or not the source has data.
+bool SourceIsValid(const Source *self);
+
+// Computes the user facing line and column (both nonzero, the column in
+// bytes) of a byte offset local to the source. The line-start index is built
+// on the first call, every call after that is a binary search. Returns false
+// if the offset is out of bounds.
+bool SourceLineCol(const Source *self, size_t offset, size_t *line,
+    size_t *col);
+
 // -------------------------------------------------------------------------- //
 // MARK: Substring
 // -------------------------------------------------------------------------- //
@@ -63,22 +116,98 @@ void SubstringPrint(FILE *ioStream, const Substring *self);
 // The pointer returned is a null-terminated sequence of bytes.
 char *SubstringAlloc(const Substring *self);
 
+// -------------------------------------------------------------------------- //
+// MARK: Source Manager
+// * One per process. Owns every source loaded through it until it is closed
+// * (or until `SMRelease()`), so that spans, caches and diagnostics can refer
+// * to files with a `FileId` alone. Loading is not thread safe, reading is.
+// -------------------------------------------------------------------------- //
+
+// Loads the file at `path` and returns its id. Paths are canonicalized, so
+// loading the same file twice (by any path) returns the same id. The file is
+// not read, a file with the same contents as one already loaded is only
+// found by `SMCanonicalFile()`. Returns `NULL_FILE_ID` on failure.
+FileId SMOpenFile(const char *path);
+
+// Registers `length` bytes of borrowed data named `path` (a placeholder if
+// `NULL`) and returns its id. A name that is already registered keeps its id
+// and has its contents replaced, see `SMReplaceBuffer()`. `data` must outlive
+// its registration.
+FileId SMAddBuffer(const char *data, size_t length, const char *path);
+
+// Replaces the contents of a file or buffer with `length` bytes of borrowed
+// data, keeping its id. The base stays put while the contents fit the offsets
+// reserved for it, otherwise the source moves (and its reservation at least
+// doubles). Either way spans into the old contents are stale. Returns false
+// if `id` is not a live file or buffer, or the offset space is exhausted.
+bool SMReplaceBuffer(FileId id, const char *data, size_t length);
+
+// Releases a file or buffer, its id is dead and its offsets are handed out
+// again.
+void SMCloseFile(FileId id);
+
+// Returns the source registered under `id`, or `NULL`.
+const Source *SMGetSource(FileId id);
+
+// Returns the first file loaded with the same contents as `id` (which is
+// `id` itself for unique files). Anything derived only from the contents
+// can be cached under this id. Files are hashed on the first call that
+// needs them, and again after their contents are replaced.
+FileId SMCanonicalFile(FileId id);
+
+// Maps a global offset to the file it falls in and, if `localOffset` is not
+// `NULL`, the offset within that file. Returns `NULL_FILE_ID` if the offset
+// does not fall in a live file.
+FileId SMLocate(uint32_t offset, size_t *localOffset);
+
+// Registers a source named `path` whose data is supplied a window at a time
+// with `SMSetWindow()`, and reserves `reserve` offsets for it (the largest
+// window it will ever have). The caller owns the data. Used by
+// `SourceStream`.
+FileId SMAddWindow(const char *path, size_t reserve);
+
+// Points a window source at `length` bytes of `data`, whose first byte is on
+// line `firstLine + 1` and column `firstCol + 1` of the whole input. Spans
+// into the previous window no longer resolve correctly. `NULL` data retires
+// the source.
+bool SMSetWindow(FileId id, const char *data, size_t length,
+    size_t firstLine, size_t firstCol);
+
+// Returns the number of ids handed out so far.
+size_t SMFileCount();
+
+// Releases every source owned by the manager and forgets every registered
+// source, every span is invalid afterwards. Must not race with any other
+// use of spans or sources.
+void SMRelease();
+
 // -------------------------------------------------------------------------- //
 // MARK: Span
 // -------------------------------------------------------------------------- //
 
+#define NULL_SPAN (Span) { .offset = 0, .length = 0 }
+
 // Used to represent some amount of bytes in the original source code.
 // `offset` and `length` quantities are measured in bytes.
-// - `x` is the user-facing column number (nonzero).
-// - `y` is the user-facing line number (nonzero).
+// - `offset` is in the global offset space: every source reserves at least
+// `[base, base + length]`, so the offset alone identifies the source as well
+// as the position inside it. Use `SpanSource()` to recover it.
+//
+// Spans are 8 bytes. Line and column numbers are not stored, they are
+// recovered on demand with `SpanLineCol()`.
 typedef struct Span {
-    const Source *src;
-    const size_t offset;
-    const size_t length;
-    const size_t x;
-    const size_t y;
+    const uint32_t offset;
+    const uint32_t length;
 } Span;
 
+// Returns the source the span points into, or `NULL` if there is none (i.e.
+// the source was freed, or the span is `NULL_SPAN`).
+const Source *SpanSource(const Span *span);
+
+// Computes the user facing line and column of the start of the span. Returns
+// false if the span does not point into a live source.
+bool SpanLineCol(const Span *span, size_t *line, size_t *col);
+
 // Returns a `Substring` of the bytes pointed to by `span`. Will return 
 // `NULL_SUBSTRING` if there is out of bounds access or null arguments.
 // Use `SubstringIsNull()` to confirm.
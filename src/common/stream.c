@@ -0,0 +1,174 @@
+#include "stream.h"
+#include "memstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#define read _read
+#define open _open
+#define close _close
+#define STDIN_FILENO 0
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// -------------------------------------------------------------------------- //
+// MARK: Helpers
+// -------------------------------------------------------------------------- //
+
+// Moves the line and column of the window start past `length` bytes.
+static void advancePosition(SourceStream *self, size_t length) {
+    const char *p = self->buffer;
+    const char *end = p + length;
+    const char *nl;
+    while ((nl = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        self->line++;
+        self->col = 0;
+        p = nl + 1;
+    }
+    self->col += (size_t)(end - p);
+    self->position += length;
+}
+
+// Reads until the window is full or the input ends.
+static bool readMore(SourceStream *self) {
+    while (!self->eof && self->length < self->capacity) {
+        long got = (long)read(self->fd, self->buffer + self->length,
+            (unsigned)(self->capacity - self->length));
+#ifndef _WIN32
+        if (got < 0 && errno == EINTR) continue;
+#endif
+        if (got < 0) {
+            fprintf(stderr, "<SourceStreamFill(): cannot read '%s'>\n",
+                SourceStreamSource(self)->path);
+            return false;
+        }
+        if (got == 0) self->eof = true;
+        self->length += (size_t)got;
+    }
+
+    // Keep the scanner's guarantee of zero bytes past the end
+    memset(self->buffer + self->length, 0, SOURCE_GUARD_SIZE);
+    return true;
+}
+
+// Doubles the window, for a token that does not fit in it.
+static bool growWindow(SourceStream *self) {
+    size_t capacity = self->capacity * 2;
+    if (capacity > SOURCE_STREAM_MAX_WINDOW) {
+        fprintf(stderr, "<SourceStreamFill(): token exceeds %u bytes>\n",
+            SOURCE_STREAM_MAX_WINDOW);
+        return false;
+    }
+
+    char *buffer = realloc(self->buffer, capacity + SOURCE_GUARD_SIZE);
+    if (!buffer) {
+        fprintf(stderr, "<SourceStreamFill(): allocation failure>\n");
+        return false;
+    }
+    MemStatsNoteRealloc(MEM_SOURCES, self->capacity + SOURCE_GUARD_SIZE,
+        capacity + SOURCE_GUARD_SIZE);
+
+    self->buffer   = buffer;
+    self->capacity = capacity;
+    return true;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Implementation
+// -------------------------------------------------------------------------- //
+
+SourceStream SourceStreamNew(int fd, const char *path, size_t window) {
+    if (fd < 0) return (SourceStream) {0};
+    if (window == 0) window = SOURCE_STREAM_WINDOW;
+    if (window > SOURCE_STREAM_MAX_WINDOW) window = SOURCE_STREAM_MAX_WINDOW;
+
+    // Reserve offsets for the largest window up front, so spans into the
+    // window never run into the next source.
+    FileId id = SMAddWindow(path, SOURCE_STREAM_MAX_WINDOW);
+    char *buffer = malloc(window + SOURCE_GUARD_SIZE);
+    if (id == NULL_FILE_ID || !buffer) {
+        fprintf(stderr, "<SourceStreamNew(): cannot create stream>\n");
+        free(buffer);
+        return (SourceStream) {0};
+    }
+    MemStatsNoteAlloc(MEM_SOURCES, window + SOURCE_GUARD_SIZE);
+
+    SourceStream self = {
+        .fd       = fd,
+        .buffer   = buffer,
+        .capacity = window,
+        .id       = id,
+    };
+    if (!SourceStreamFill(&self, 0)) {
+        SourceStreamFree(&self);
+        return (SourceStream) {0};
+    }
+    return self;
+}
+
+SourceStream SourceStreamOpen(const char *path, size_t window) {
+    if (!path) return (SourceStream) {0};
+    if (strcmp(path, "-") == 0)
+        return SourceStreamNew(STDIN_FILENO, "<stdin>", window);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "<SourceStreamOpen(): cannot open '%s'>\n", path);
+        return (SourceStream) {0};
+    }
+
+    SourceStream self = SourceStreamNew(fd, path, window);
+    if (!SourceStreamIsValid(&self)) {
+        close(fd);
+        return self;
+    }
+    self.ownsFd = true;
+    return self;
+}
+
+bool SourceStreamIsValid(const SourceStream *self) {
+    return self && self->buffer != NULL && self->id != NULL_FILE_ID;
+}
+
+const Source *SourceStreamSource(const SourceStream *self) {
+    return self ? SMGetSource(self->id) : NULL;
+}
+
+bool SourceStreamFill(SourceStream *self, size_t keep) {
+    if (!self || !self->buffer || keep > self->length) {
+        fprintf(stderr, "<SourceStreamFill(): invalid stream or keep>\n");
+        return false;
+    }
+
+    // Slide the unconsumed tail to the front
+    advancePosition(self, keep);
+    memmove(self->buffer, self->buffer + keep, self->length - keep);
+    self->length -= keep;
+
+    // Nothing was consumed from a full window, one token spans all of it
+    if (!self->eof && self->length == self->capacity && !growWindow(self))
+        return false;
+
+    if (!readMore(self))
+        return false;
+    return SMSetWindow(self->id, self->buffer, self->length, self->line,
+        self->col);
+}
+
+void SourceStreamFree(SourceStream *self) {
+    if (!self) return;
+    if (self->id != NULL_FILE_ID)
+        /* discard */ SMSetWindow(self->id, NULL, 0, 0, 0);
+    if (self->buffer)
+        MemStatsNoteFree(MEM_SOURCES, self->capacity + SOURCE_GUARD_SIZE);
+    if (self->ownsFd)
+        close(self->fd);
+    free(self->buffer);
+    *self = (SourceStream) {0};
+}
@@ -0,0 +1,67 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "source.h"
+
+// The default window size.
+#define SOURCE_STREAM_WINDOW (1u << 20)
+
+// The largest a window may grow to hold a single token.
+#define SOURCE_STREAM_MAX_WINDOW (64u << 20)
+
+// -------------------------------------------------------------------------- //
+// MARK: Source Stream
+// -------------------------------------------------------------------------- //
+
+// Reads a file, pipe or stdin a fixed size window at a time, so input of any
+// size is scanned in bounded memory. The window is registered with the source
+// manager as a window source (see `SMAddWindow()`): spans into it work as
+// usual, but only until the next `SourceStreamFill()`.
+//
+// - `buffer` the window, followed by `SOURCE_GUARD_SIZE` zero bytes.
+// - `capacity` the size of the window. Only grows (up to
+// `SOURCE_STREAM_MAX_WINDOW`) if a single token does not fit.
+// - `length` the number of bytes in the window.
+// - `position` the offset of `buffer[0]` in the whole input.
+// - `line` and `col` the zero based line and column of `buffer[0]`.
+// - `id` the window source.
+// - `eof` whether the end of the input has been read into the window.
+typedef struct SourceStream {
+    int fd;
+    bool ownsFd;
+    char *buffer;
+    size_t capacity;
+    size_t length;
+    uint64_t position;
+    size_t line;
+    size_t col;
+    FileId id;
+    bool eof;
+} SourceStream;
+
+// Creates a stream reading from `fd` (which is borrowed) named `path`, with
+// windows of `window` bytes (zero uses `SOURCE_STREAM_WINDOW`). The first
+// window is filled before returning. Verify with `SourceStreamIsValid()`.
+SourceStream SourceStreamNew(int fd, const char *path, size_t window);
+
+// Same as `SourceStreamNew()`, but opens `path`, or reads stdin if `path` is
+// `"-"`.
+SourceStream SourceStreamOpen(const char *path, size_t window);
+
+bool SourceStreamIsValid(const SourceStream *self);
+
+// Returns the window source, valid until the stream is freed.
+const Source *SourceStreamSource(const SourceStream *self);
+
+// Drops the first `keep` bytes of the window, moves the rest to the front and
+// reads more input behind them. Returns false on a read error, or if the
+// window is full and cannot grow.
+bool SourceStreamFill(SourceStream *self, size_t keep);
+
+// Closes the stream (and the file if it opened it) and retires its source.
+void SourceStreamFree(SourceStream *self);
+
+#endif
@@ -0,0 +1,97 @@
+#include "vec.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+static inline bool mulWillOverflowSizet(size_t cap, size_t size) {
+    return cap > SIZE_MAX / size;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Implementation
+// -------------------------------------------------------------------------- //
+
+void *VecAlloc(
+    size_t capacity,
+    size_t size,
+    Arena *arena,
+    ArenaTag tag,
+    MemSubsystem mem
+) {
+    if (capacity == 0 || size == 0 || mulWillOverflowSizet(capacity, size))
+        return NULL;
+
+    void *data = arena
+        ? ArenaAlloc(arena, tag, capacity * size)
+        : malloc(capacity * size);
+    if (!data) {
+        fprintf(stderr, "<VecAlloc(): allocation failure>\n");
+        return NULL;
+    }
+
+    MemStatsNoteAlloc(mem, capacity * size);
+    return data;
+}
+
+void *VecGrow(
+    void *data,
+    size_t *capacity,
+    size_t size,
+    Arena *arena,
+    ArenaTag tag,
+    MemSubsystem mem
+) {
+    if (!capacity || size == 0) {
+        fprintf(stderr, "<VecGrow(): null capacity or zero size>\n");
+        return NULL;
+    }
+
+    // Check for overflow
+    if (mulWillOverflowSizet(*capacity, GROWTH_FACTOR)
+        || mulWillOverflowSizet(*capacity * GROWTH_FACTOR, size))
+    {
+        fprintf(stderr, "<VecGrow(): overflow>\n");
+        return NULL;
+    }
+
+    size_t oldCapacity = *capacity;
+    size_t newCapacity = oldCapacity == 0 ? 1 : oldCapacity * GROWTH_FACTOR;
+
+    void *newData = arena
+        ? ArenaGrow(arena, tag, data, oldCapacity * size, newCapacity * size)
+        : realloc(data, newCapacity * size);
+    if (!newData) {
+        fprintf(stderr, "<VecGrow(): allocation failure>\n");
+        return NULL;
+    }
+
+    MemStatsNoteRealloc(mem, oldCapacity * size, newCapacity * size);
+    *capacity = newCapacity;
+    return newData;
+}
+
+void VecFree(void *data, size_t bytes, Arena *arena, MemSubsystem mem) {
+    if (!data)
+        return;
+
+    MemStatsNoteFree(mem, bytes);
+    if (!arena)
+        free(data);
+}
+
+void VecDumpInfo(
+    FILE *handle,
+    const char *name,
+    size_t size,
+    size_t count,
+    size_t capacity
+) {
+    if (!handle) {
+        fprintf(stderr, "<VecDumpInfo(): invalid handle>\n");
+        return;
+    }
+    fprintf(handle, "Dumping %s info:\n", name);
+    fprintf(handle, "  Size: %zu\n", size);
+    fprintf(handle, "  Count: %zu\n", count);
+    fprintf(handle, "  Capacity: %zu\n", capacity);
+}
@@ -0,0 +1,150 @@
+#ifndef VEC_H
+#define VEC_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+#include "list.h"
+#include "memstats.h"
+
+// -------------------------------------------------------------------------- //
+// MARK: Vec
+// -------------------------------------------------------------------------- //
+
+// `DEFINE_VEC(T)` generates a growable array specialized for the type `T`,
+// named `T##Vec`. Unlike `List`, the element size is known at compile time
+// and every accessor is `static inline`, so hot loops over a `Vec` compile
+// down to plain pointer arithmetic. Bounds checks are `assert()`s, meaning
+// they only exist in debug builds (without `NDEBUG`).
+//
+// - `data` the pointer to the first element.
+// - `count` the number of elements in the vec.
+// - `capacity` the number of elements that fit before the vec must grow.
+// - `arena` the arena the vec draws from, or `NULL` for the heap.
+// - `tag` the arena lifetime the vec belongs to (ignored for heap vecs).
+// - `mem` the subsystem its allocations are accounted to.
+//
+// Growth goes through the out-of-line `VecGrow()`, which keeps the push fast
+// path small enough to inline. Pushes return a `ListResult` just like
+// `ListPush()`. `T##VecExtend()` appends `n` elements with a single copy.
+//
+// If `T` is needed in a struct before it is complete, use `DECLARE_VEC(T)`
+// where the struct is declared and `DEFINE_VEC_METHODS(T)` once `T` is
+// complete. `DEFINE_VEC(T)` does both.
+#define DEFINE_VEC(T)                                                          \
+    DECLARE_VEC(T)                                                             \
+    DEFINE_VEC_METHODS(T)
+
+#define DECLARE_VEC(T)                                                         \
+    typedef struct T##Vec {                                                    \
+        T *data;                                                               \
+        size_t count;                                                          \
+        size_t capacity;                                                       \
+        Arena *arena;                                                          \
+        ArenaTag tag;                                                          \
+        MemSubsystem mem;                                                      \
+    } T##Vec;
+
+#define DEFINE_VEC_METHODS(T)                                                  \
+    static inline T##Vec T##VecNewInArena(                                     \
+        Arena *arena, ArenaTag tag, MemSubsystem mem, size_t capacity          \
+    ) {                                                                        \
+        T *data = VecAlloc(capacity, sizeof(T), arena, tag, mem);              \
+        if (!data) return (T##Vec) {0};                                        \
+        return (T##Vec) { data, 0, capacity, arena, tag, mem };                \
+    }                                                                          \
+                                                                               \
+    static inline T##Vec T##VecNew(size_t capacity) {                          \
+        return T##VecNewInArena(NULL, ARENA_TAG_MISC, MEM_UNTRACKED, capacity);\
+    }                                                                          \
+                                                                               \
+    static inline bool T##VecIsValid(const T##Vec *self) {                     \
+        return self && self->data != NULL && self->capacity > 0;               \
+    }                                                                          \
+                                                                               \
+    static inline T *T##VecGet(const T##Vec *self, size_t i) {                 \
+        assert(i < self->count);                                               \
+        return &self->data[i];                                                 \
+    }                                                                          \
+                                                                               \
+    static inline T *T##VecFront(const T##Vec *self) {                         \
+        assert(self->count > 0);                                               \
+        return &self->data[0];                                                 \
+    }                                                                          \
+                                                                               \
+    static inline T *T##VecBack(const T##Vec *self) {                          \
+        assert(self->count > 0);                                               \
+        return &self->data[self->count - 1];                                   \
+    }                                                                          \
+                                                                               \
+    static inline ListResult T##VecPush(T##Vec *self, const T *item) {         \
+        ListResult res = LIST_RES_OK;                                          \
+        if (self->count >= self->capacity) {                                   \
+            T *data = VecGrow(self->data, &self->capacity, sizeof(T),          \
+                self->arena, self->tag, self->mem);                            \
+            if (!data) return LIST_RES_ERR;                                    \
+            self->data = data;                                                 \
+            res = LIST_RES_REALLOC;                                            \
+        }                                                                      \
+        /* memcpy rather than assign, `T` may have const members */           \
+        memcpy(&self->data[self->count++], item, sizeof(T));                   \
+        return res;                                                            \
+    }                                                                          \
+                                                                               \
+    static inline ListResult T##VecExtend(                                     \
+        T##Vec *self, const T *items, size_t n                                 \
+    ) {                                                                        \
+        ListResult res = LIST_RES_OK;                                          \
+        while (self->capacity - self->count < n) {                             \
+            T *data = VecGrow(self->data, &self->capacity, sizeof(T),          \
+                self->arena, self->tag, self->mem);                            \
+            if (!data) return LIST_RES_ERR;                                    \
+            self->data = data;                                                 \
+            res = LIST_RES_REALLOC;                                            \
+        }                                                                      \
+        if (n > 0) memcpy(&self->data[self->count], items, n * sizeof(T));     \
+        self->count += n;                                                      \
+        return res;                                                            \
+    }                                                                          \
+                                                                               \
+    static inline void T##VecClear(T##Vec *self) {                             \
+        self->count = 0;                                                       \
+    }                                                                          \
+                                                                               \
+    static inline void T##VecFree(T##Vec *self) {                              \
+        VecFree(self->data, self->capacity * sizeof(T),                        \
+            self->arena, self->mem);                                           \
+        *self = (T##Vec) {0};                                                  \
+    }                                                                          \
+                                                                               \
+    static inline void T##VecDumpInfo(FILE *handle, const T##Vec *self) {      \
+        VecDumpInfo(handle, #T "Vec", sizeof(T), self->count, self->capacity); \
+    }
+
+// -------------------------------------------------------------------------- //
+// MARK: Out-of-line Helpers
+// * These are shared by every generated vec and should not be called
+// * directly.
+// -------------------------------------------------------------------------- //
+
+// Allocates room for `capacity` elements of `size` bytes. Returns `NULL` if
+// either is zero, the product overflows, or the allocation fails.
+void *VecAlloc(size_t capacity, size_t size, Arena *arena, ArenaTag tag,
+    MemSubsystem mem);
+
+// Grows `data` by `GROWTH_FACTOR` and updates `capacity`. Returns the new
+// data pointer, or `NULL` (leaving `data` untouched) on overflow or failure.
+void *VecGrow(void *data, size_t *capacity, size_t size, Arena *arena,
+    ArenaTag tag, MemSubsystem mem);
+
+// Frees heap backed vec data. Arena backed data is left for the arena.
+void VecFree(void *data, size_t bytes, Arena *arena, MemSubsystem mem);
+
+// Prints the count, capacity and element size of a vec.
+void VecDumpInfo(FILE *handle, const char *name, size_t size, size_t count,
+    size_t capacity);
+
+#endif
@@ -0,0 +1,169 @@
+#include "driver.h"
+#include "../parsing/parser.h"
+#include "../scanning/scanner.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: Helpers
+// -------------------------------------------------------------------------- //
+
+// The state of a streamed compile, carried from one window to the next.
+// - `parser` parses the scanner's token list, made with the first window.
+// - `split` finds the items, `first` is the first token of the one being
+// collected (`SIZE_MAX` before the first), and `seen` how many tokens
+// `split` has already stepped past.
+// - `taken` how many of the scanner's diagnostics went to an item.
+typedef struct Compile {
+    const Source *src;
+    CompileSink sink;
+    void *ctx;
+
+    Ast ast;
+    DiagEngine diags;
+    Parser parser;
+
+    ItemSplit split;
+    size_t first;
+    size_t seen;
+    size_t taken;
+    size_t index;
+    bool success;
+} Compile;
+
+// Parses the item `[first, end)` of `tokens`, hands it to the sink and
+// clears it out again. The item takes the scanner's diagnostics up to the
+// token after it, or all of them if it is the `last`.
+static void dispatch(
+    Compile *self,
+    const TokenList *tokens,
+    const DiagEngine *scanDiags,
+    const ParseItem *range,
+    bool last
+) {
+    const DiagnosticVec *scanned = &scanDiags->diagnostics;
+    const uint32_t until = TLSpan(tokens, range->end).offset;
+    for (; self->taken < scanned->count; self->taken++) {
+        const Diagnostic *diag = DiagnosticVecGet(scanned, self->taken);
+        if (!last && diag->report.span.offset >= until)
+            break;
+        DEPush(&self->diags, diag);
+    }
+
+    // Diagnostics of a file without any items still get an item of their own
+    ExprId root = NULL_AST_ID;
+    if (range->first < range->end) {
+        // Its diagnostics say whether it parsed
+        bool parsed = false;
+        ParseItemOf(&self->parser, range, &parsed);
+        root = AstItemAt(&self->ast, AstItemCount(&self->ast) - 1).root;
+    }
+
+    const CompileItem item = {
+        .src    = self->src,
+        .ast    = &self->ast,
+        .root   = root,
+        .tokens = tokens,
+        .first  = range->first,
+        .end    = range->end,
+        .diags  = &self->diags,
+        .index  = self->index++,
+    };
+    if (self->sink) self->sink(self->ctx, &item);
+
+    self->success = self->success && self->diags.diagnostics.count == 0;
+    AstClear(&self->ast);
+    DiagnosticVecClear(&self->diags.diagnostics);
+}
+
+// Collects the tokens of each window into items, see `ScanSink`. An item
+// is complete once the next one starts (or the input ends), and the one
+// still being collected is held over to the next window.
+static size_t collect(void *ctx, TokenList *tokens, DiagEngine *diags) {
+    Compile *self = ctx;
+    if (tokens->count == 0)
+        return 0;
+    if (!self->parser.tokenList) {
+        const Parser parser = ParserNew(
+            self->src, &self->ast, &self->diags, tokens);
+        // Silly workaround to avoid making Token members non-const.
+        memcpy(&self->parser, &parser, sizeof(Parser));
+    }
+
+    for (size_t i = self->seen; i < tokens->count; i++) {
+        const TokenKind kind = TLKind(tokens, i);
+        if (kind == TK_EOF) {
+            const size_t first = self->first == SIZE_MAX ? i : self->first;
+            const ParseItem range = { first, i };
+            if (first < i || self->taken < diags->diagnostics.count)
+                dispatch(self, tokens, diags, &range, true);
+            self->first = SIZE_MAX;
+            break;
+        }
+
+        if (!ItemSplitStep(&self->split, kind))
+            continue;
+        if (self->first != SIZE_MAX) {
+            const ParseItem range = { self->first, i };
+            dispatch(self, tokens, diags, &range, false);
+        }
+        self->first = i;
+    }
+
+    // What's left of the window moves to the front of the next one
+    const size_t done = self->first == SIZE_MAX ? tokens->count : self->first;
+    self->seen  = tokens->count - done;
+    self->first = self->first == SIZE_MAX ? SIZE_MAX : 0;
+    self->taken = 0;
+    return done;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Implementation
+// -------------------------------------------------------------------------- //
+
+void CompileStream(
+    SourceStream *stream,
+    CompileSink sink,
+    void *ctx,
+    bool *success
+) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
+    }
+
+    const Source *src = SourceStreamSource(stream);
+    DiagEngine scanDiags = DENew();
+    TokenList  tokens = TLNew();
+    Scanner scanner = ScannerNew(src, &scanDiags, &tokens);
+    Compile self = {
+        .src     = src,
+        .sink    = sink,
+        .ctx     = ctx,
+        .ast     = AstNew(),
+        .diags   = DENew(),
+        .first   = SIZE_MAX,
+        .success = true,
+    };
+
+    bool scanSuccess = false;
+    if (SourceStreamIsValid(stream)
+        && ScannerIsValid(&scanner)
+        && AstIsValid(&self.ast)
+        && DiagnosticVecIsValid(&self.diags.diagnostics))
+    {
+        ScanStream(&scanner, stream, collect, &self, &scanSuccess);
+    } else {
+        fprintf(stderr, "<invalid stream in CompileStream()>\n");
+    }
+    *success = scanSuccess && self.success;
+
+    ParserFree(&self.parser);
+    AstFree(&self.ast);
+    DiagnosticVecFree(&self.diags.diagnostics);
+    DiagnosticVecFree(&scanDiags.diagnostics);
+    TLFree(&tokens);
+}
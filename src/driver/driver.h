@@ -0,0 +1,52 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "../common/diag.h"
+#include "../common/source.h"
+#include "../common/stream.h"
+#include "../parsing/ast.h"
+#include "../scanning/token.h"
+#include <stdbool.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: Streaming Compile
+// * A streamed file is compiled a top-level item at a time. An item is
+// * parsed as soon as the first token of the next one is scanned, handed to
+// * the caller, and then its nodes are cleared out of the AST and its tokens
+// * and bytes let go of. Nothing outlives its item, so memory is bounded by
+// * the largest item (and the stream's window), not by the size of the file.
+// -------------------------------------------------------------------------- //
+
+// One top-level item, only valid until the sink returns.
+// - `src` the stream's window source, which the spans point into.
+// - `ast` an AST with just this item's nodes and symbols in it.
+// - `root` the item's expression, or `NULL_AST_ID` if it was empty or had
+// errors.
+// - `tokens` the tokens it was parsed from, its own are `[first, end)`.
+// - `diags` what scanning and parsing it reported.
+// - `index` how many items came before it.
+typedef struct CompileItem {
+    const Source *src;
+    const Ast *ast;
+    ExprId root;
+    const TokenList *tokens;
+    size_t first;
+    size_t end;
+    const DiagEngine *diags;
+    size_t index;
+} CompileItem;
+
+// Receives each item of a streamed compile, in order. This is where the
+// item is printed, evaluated or emitted, anything it needs afterwards has
+// to be copied out.
+typedef void (*CompileSink)(void *ctx, const CompileItem *item);
+
+// Scans and parses `stream` an item at a time, and hands each one to
+// `sink`. The AST and diagnostics of one item are cleared before the next
+// is parsed, and tokens are dropped with the window they were scanned from,
+// unless an item is still using them. `*success` is whether there were no
+// errors in any item.
+void CompileStream(SourceStream *stream, CompileSink sink, void *ctx,
+    bool *success);
+
+#endif
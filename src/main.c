@@ -1,70 +1,296 @@
 #include "common/list.h"
+#include "common/arena.h"
+#include "common/memstats.h"
 #include "common/source.h"
+#include "common/stream.h"
 #include "common/ansi.h"
 #include "common/diag.h"
+#include "driver/driver.h"
 #include "parsing/ast.h"
 #include "parsing/parser.h"
 #include "parsing/printer.h"
 #include "scanning/token.h"
+#include "scanning/pipe.h"
 #include "scanning/scanner.h"
 #include <stdio.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: Streaming
+// -------------------------------------------------------------------------- //
+
+typedef struct StreamTotals {
+    size_t tokens;
+    size_t diagnostics;
+} StreamTotals;
+
+// Diagnostics are rendered while their window is still around to show them.
+static size_t streamSink(void *ctx, TokenList *tokens, DiagEngine *diags) {
+    StreamTotals *totals = ctx;
+    totals->tokens      += tokens->count;
+    totals->diagnostics += diags->diagnostics.count;
+    DEPrint(stderr, diags);
+    return tokens->count;
+}
+
+// Scans `path` (or stdin for `-`) a window at a time and reports the token
+// count. Memory use is bounded by the window, not the input.
+static int scanStream(const char *path, bool memStats) {
+    SourceStream stream = SourceStreamOpen(path, SOURCE_STREAM_WINDOW);
+    if (!SourceStreamIsValid(&stream)) return 1;
+
+    DiagEngine de = DENew();
+    TokenList  tl = TLNew();
+    Scanner scanner = ScannerNew(SourceStreamSource(&stream), &de, &tl);
+    if (!ScannerIsValid(&scanner)) return 1;
+
+    StreamTotals totals = {0};
+    bool scanSuccess = false;
+    ScanStream(&scanner, &stream, streamSink, &totals, &scanSuccess);
+    printf("%zu\n", totals.tokens);
+
+    if (memStats) {
+        TLRecordMemStats(&tl);
+        DERecordMemStats(&de);
+        MemStatsPrint(stderr);
+    }
+
+    TLFree(&tl);
+    DiagnosticVecFree(&de.diagnostics);
+    SourceStreamFree(&stream);
+    return scanSuccess ? 0 : 1;
+}
+
+// Prints each item while its window is still around to print it from.
+static void printItem(void *ctx, const CompileItem *item) {
+    size_t *items = ctx;
+    (*items)++;
+    DEPrint(stderr, item->diags);
+    if (item->root == NULL_AST_ID) return;
+
+    AstPrinter astPrinter = AstPrinterNew(item->src, item->ast);
+    AstPrintExpr(&astPrinter, item->root);
+}
+
+// Scans and parses `path` (or stdin for `-`) an item at a time, printing
+// each one. Memory use is bounded by the largest item, not the input.
+static int compileStream(const char *path, bool memStats) {
+    SourceStream stream = SourceStreamOpen(path, SOURCE_STREAM_WINDOW);
+    if (!SourceStreamIsValid(&stream)) return 1;
+
+    size_t items = 0;
+    bool success = false;
+    CompileStream(&stream, printItem, &items, &success);
+    printf("Item Count: %zu\n", items);
+
+    // Only the peaks mean anything, everything was freed on the way out
+    if (memStats)
+        MemStatsPrint(stderr);
+
+    SourceStreamFree(&stream);
+    return success ? 0 : 1;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Pulled Tokens
+// -------------------------------------------------------------------------- //
+
+// Parses `source` with the scanner running only as far ahead as the parser,
+// so the token list never holds more than a token or two. With `piped`, the
+// scanner runs on its own thread, up to a pipe's worth of tokens ahead.
+static int parsePulled(const Source *source, bool piped, bool memStats) {
+    Arena arena = ArenaNew(ARENA_CHUNK_SIZE);
+    DiagEngine de = DENewInArena(&arena);
+    Ast ast = AstNewInArena(&arena);
+
+    // The scanner keeps its own lists, off the arena, so it can run on
+    // another thread
+    DiagEngine scanDiags = DENew();
+    TokenList  tl = TLNew();
+    Scanner scanner = ScannerNew(source, &scanDiags, &tl);
+    TokenSource tokens = ScannerTokenSource(&scanner);
+
+    TokenPipe pipe = piped ? TokenPipeNew(0) : (TokenPipe) {0};
+    if (piped && TokenPipeStart(&pipe, tokens))
+        tokens = TokenPipeSource(&pipe);
+
+    Parser parser = ParserNewFromSource(source, &ast, &de, tokens);
+    bool parseSuccess = false;
+    if (ParserIsValid(&parser))
+        Parse(&parser, &parseSuccess);
+    else
+        fprintf(stderr, "<invalid parser in parsePulled()>\n");
+
+    // Stops the scanner, if the parser finished early
+    TokenPipeFree(&pipe);
+
+    if (memStats) {
+        TLRecordMemStats(&tl);
+        AstRecordMemStats(&ast);
+        DERecordMemStats(&de);
+        MemStatsPrint(stderr);
+    }
+
+    DEPrint(stderr, &scanDiags);
+    DEPrint(stderr, &de);
+    printf("Expr Count: %zu\n", ast.exprs.count);
+
+    const bool scanSuccess = scanner.success;
+    const bool parserValid = ParserIsValid(&parser);
+    ParserFree(&parser);
+    TLFree(&tl);
+    DiagnosticVecFree(&scanDiags.diagnostics);
+    ArenaRelease(&arena);
+    return scanSuccess && parserValid ? 0 : 1;
+}
 
 // -------------------------------------------------------------------------- //
 // MARK: Main
 // -------------------------------------------------------------------------- //
 
+// The most threads `--threads` accepts.
+#define MAX_THREADS 1024
+
 int main(int argc, char **argv) {
     InitConsoleColors();
 
-    const Source source = SourceNewFromData("x = y");
-    DiagEngine de = DENew();
-    TokenList  tl = TLNew();
+    // Parse flags
+    bool memStats = false;
+    bool stream   = false;
+    bool items    = false;
+    bool pulled   = false;
+    bool piped    = false;
+    long threads  = -1;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mem-stats") == 0) {
+            memStats = true;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (strcmp(argv[i], "--stream-parse") == 0) {
+            items = true;
+        } else if (strcmp(argv[i], "--pull") == 0) {
+            pulled = true;
+        } else if (strcmp(argv[i], "--pipe") == 0) {
+            pulled = piped = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // `0` picks one thread per CPU
+            char *end = NULL;
+            threads = strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0'
+                || threads < 0 || threads > MAX_THREADS)
+            {
+                fprintf(stderr, "unknown argument: '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if ((argv[i][0] != '-' || strcmp(argv[i], "-") == 0)
+            && !path)
+        {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "unknown argument: '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // Only scan, a window at a time (stdin if there is no path)
+    if (stream)
+        return scanStream(path ? path : "-", memStats);
+
+    // Scan and parse an item at a time, printing each one as it's done
+    if (items)
+        return compileStream(path ? path : "-", memStats);
+
+    // Read the file if there is one, otherwise use a static test string
+    const char *text = "x = y";
+    FileId file = path
+        ? SMOpenFile(path)
+        : SMAddBuffer(text, strlen(text), NULL);
+    const Source *source = SMGetSource(file);
+    if (!SourceIsValid(source)) return 1;
+
+    // Scan and parse together, without a token list
+    if (pulled) {
+        const int status = parsePulled(source, piped, memStats);
+        SMRelease();
+        return status;
+    }
+
+    // Everything for this translation unit comes from one arena.
+    Arena arena = ArenaNew(ARENA_CHUNK_SIZE);
+    DiagEngine de = DENewInArena(&arena);
+    TokenList  tl = TLNewInArena(&arena);
     
-    if (!ListIsValid(&tl.tokens) || !ListIsValid(&de.diagnostics)) return 1;
+    if (!TLIsValid(&tl)
+        || !DiagnosticVecIsValid(&de.diagnostics)) return 1;
     
     // Make a new scanner
-    Scanner scanner = ScannerNew(&source, &de, &tl);
+    Scanner scanner = ScannerNew(source, &de, &tl);
     if (!ScannerIsValid(&scanner)) return 1;
 
-    // Scan tokens
+    // Scan tokens, on several threads if asked to
     bool scanSuccess = false;
-    Scan(&scanner, &scanSuccess);
+    if (threads >= 0)
+        ScanParallel(&scanner, (size_t)threads, 0, &scanSuccess);
+    else
+        Scan(&scanner, &scanSuccess);
     if (!scanSuccess) {
         TLPrint(stderr, &tl);
         DEPrint(stderr, &de);
         return 1;
     }
 
-    printf("%zu\n", tl.tokens.count);
+    printf("%zu\n", tl.count);
     assert(de.diagnostics.count == 0);
 
     TLPrint(stderr, &tl);
     DEPrint(stderr, &de);
 
-    // assert(((Token*)ListGet(&tl.tokens, 0))->kind == TK_INT);
+    // assert(TLKind(&tl, 0) == TK_INT);
 
-    Ast ast = AstNew();
+    Ast ast = AstNewInArena(&arena);
     if (!AstIsValid(&ast)) {
         fprintf(stderr, "<invalid AST in main()>\n");
         return 1;
     }
 
-    Parser parser = ParserNew(&source, &ast, &de, &tl);
+    Parser parser = ParserNew(source, &ast, &de, &tl);
     if (!ParserIsValid(&parser)) {
         fprintf(stderr, "<invalid parser in main()>\n");
         return 1;
     }
 
+    // Parse items, on several threads if asked to
     bool parseSuccess = false;
-    Parse(&parser, &parseSuccess);
+    if (threads >= 0)
+        ParseParallel(&parser, (size_t)threads, 0, &parseSuccess);
+    else
+        Parse(&parser, &parseSuccess);
+
+    // Report memory use while every structure is still alive.
+    if (memStats) {
+        TLRecordMemStats(&tl);
+        AstRecordMemStats(&ast);
+        DERecordMemStats(&de);
+        MemStatsPrint(stderr);
+        MemStatsPrintArena(stderr, &arena);
+    }
+
+    // The tokens are not needed once the AST is built.
+    ArenaReleaseTag(&arena, ARENA_TAG_TOKENS);
 
     DEPrint(stderr, &de);
     printf("Expr Count: %zu\n", parser.ast->exprs.count);
 
-    AstPrinter astPrinter = AstPrinterNew(&source, &ast);
-    AstPrintExpr(&astPrinter, 3);
+    AstPrinter astPrinter = AstPrinterNew(source, &ast);
+    for (size_t i = 0; i < AstItemCount(&ast); i++)
+        AstPrintItem(&astPrinter, i);
 
+    ParserFree(&parser);
+    ArenaRelease(&arena);
+    SMRelease();
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "ast.h"
 #include "expr.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 #define INIT_EXPR_CAPACITY   512
 #define INIT_STMT_CAPACITY   128
@@ -8,26 +9,43 @@
 #define INIT_ROOT_CAPACITY   64
 #define INIT_ARGS_CAPACITY   32
 #define INIT_PARAMS_CAPACITY 16
+#define INIT_ITEMS_CAPACITY  64
 
 // -------------------------------------------------------------------------- //
 // MARK: AST
 // -------------------------------------------------------------------------- //
 
 Ast AstNew() {
+    return AstNewInArena(NULL);
+}
+
+Ast AstNewInArena(Arena *arena) {
+    const ArenaTag tag = ARENA_TAG_AST;
+
     // Allocate the 4 lists
-    List exprList   = ListNew(sizeof(Expression), INIT_EXPR_CAPACITY);
-    List stmtList   = ListNew(sizeof(Expression), INIT_STMT_CAPACITY);
-    List declList   = ListNew(sizeof(Expression), INIT_DECL_CAPACITY);
-    List rootList   = ListNew(sizeof(Expression), INIT_ROOT_CAPACITY);
-    List argsList   = ListNew(sizeof(Argument), INIT_ARGS_CAPACITY);
-    List paramsList = ListNew(sizeof(ExprId), INIT_PARAMS_CAPACITY);
-
-    printf("exprs valid: %d\n", ListIsValid(&exprList));
+    ExpressionSegList exprList = ExpressionSegListNewInArena(
+        arena, tag, MEM_AST_EXPRS, INIT_EXPR_CAPACITY);
+    List stmtList   = ListNewInArena(
+        arena, tag, sizeof(Expression), INIT_STMT_CAPACITY);
+    List declList   = ListNewInArena(
+        arena, tag, sizeof(Expression), INIT_DECL_CAPACITY);
+    ExprIdSegList rootList = ExprIdSegListNewInArena(
+        arena, tag, MEM_UNTRACKED, INIT_ROOT_CAPACITY);
+    ArgumentSegList argsList = ArgumentSegListNewInArena(
+        arena, tag, MEM_AST_ARGS, INIT_ARGS_CAPACITY);
+    ExprIdSegList paramsList = ExprIdSegListNewInArena(
+        arena, tag, MEM_AST_PARAMS, INIT_PARAMS_CAPACITY);
+    AstItemSegList itemList = AstItemSegListNewInArena(
+        arena, tag, MEM_UNTRACKED, INIT_ITEMS_CAPACITY);
+    Interner symbols = InternerNewInArena(arena, tag);
+    Interner strings = InternerNewInArena(arena, tag);
+
+    printf("exprs valid: %d\n", ExpressionSegListIsValid(&exprList));
     printf("stmts valid: %d\n", ListIsValid(&stmtList));
     printf("decls valid: %d\n", ListIsValid(&declList));
-    printf("root valid: %d\n", ListIsValid(&rootList));
-    printf("args valid:  %d\n", ListIsValid(&argsList));
-    printf("params valid: %d\n", ListIsValid(&paramsList));
+    printf("root valid: %d\n", ExprIdSegListIsValid(&rootList));
+    printf("args valid:  %d\n", ArgumentSegListIsValid(&argsList));
+    printf("params valid: %d\n", ExprIdSegListIsValid(&paramsList));
 
     Ast ast = {
         .exprs  = exprList,
@@ -36,6 +54,10 @@ Ast AstNew() {
         .root   = rootList,
         .args   = argsList,
         .params = paramsList,
+        .items  = itemList,
+        .symbols = symbols,
+        .strings = strings,
+        .rootGap = NULL_AST_ID + 1,
     };
 
     // Seed each list with the sentinel node, this will take the place of
@@ -44,10 +66,11 @@ Ast AstNew() {
     // Statement sentinelStmt = (Statement) {0};
     // Declration sentinelDecl = (Declaration) {0};
 
-    /* discard */ ListPush(&ast.exprs, &sentinelExpr);
+    /* discard */ ExpressionSegListPush(&ast.exprs, &sentinelExpr);
     /* discard */ ListPush(&ast.stmts, &sentinelExpr);
     /* discard */ ListPush(&ast.decls, &sentinelExpr);
-    /* discard */ ListPush(&ast.root, &sentinelExpr);
+    const ExprId sentinelRoot = NULL_AST_ID;
+    /* discard */ ExprIdSegListPush(&ast.root, &sentinelRoot);
     // /* discard */ ListPush(&ast.stmts, &sentinelStmt);
     // /* discard */ ListPush(&ast.decls, &sentinelDecl);
 
@@ -68,12 +91,15 @@ bool AstIsValid(const Ast *self) {
     if (!self) return false;
 
     bool listsValid = (
-        ListIsValid(&self->exprs)
+        ExpressionSegListIsValid(&self->exprs)
         && ListIsValid(&self->stmts)
         && ListIsValid(&self->decls)
-        && ListIsValid(&self->root)
-        && ListIsValid(&self->args)
-        && ListIsValid(&self->params)
+        && ExprIdSegListIsValid(&self->root)
+        && ArgumentSegListIsValid(&self->args)
+        && ExprIdSegListIsValid(&self->params)
+        && AstItemSegListIsValid(&self->items)
+        && InternerIsValid(&self->symbols)
+        && InternerIsValid(&self->strings)
     );
 
     bool listsHaveSentinels = (
@@ -86,9 +112,287 @@ bool AstIsValid(const Ast *self) {
     return (listsValid && listsHaveSentinels);
 }
 
+void AstClear(Ast *self) {
+    if (!AstIsValid(self)) return;
+    ExpressionSegListTruncate(&self->exprs, 1);
+    self->stmts.count = 1;
+    self->decls.count = 1;
+    ExprIdSegListTruncate(&self->root, 1);
+    ArgumentSegListTruncate(&self->args, 0);
+    ExprIdSegListTruncate(&self->params, 0);
+    AstItemSegListTruncate(&self->items, 0);
+    InternerClear(&self->symbols);
+    InternerClear(&self->strings);
+    self->itemGap   = 0;
+    self->itemHole  = 0;
+    self->rootGap   = NULL_AST_ID + 1;
+    self->rootHole  = 0;
+    self->gapTokens = 0;
+    self->gapDiags  = 0;
+    self->gapDelta  = 0;
+    self->deadExprs = 0;
+    self->deadArgs  = 0;
+}
+
+void AstFree(Ast *self) {
+    if (!self) return;
+    ExpressionSegListFree(&self->exprs);
+    /* discard */ ListFree(&self->stmts);
+    /* discard */ ListFree(&self->decls);
+    ExprIdSegListFree(&self->root);
+    ArgumentSegListFree(&self->args);
+    ExprIdSegListFree(&self->params);
+    AstItemSegListFree(&self->items);
+    InternerFree(&self->symbols);
+    InternerFree(&self->strings);
+    *self = (Ast) {0};
+}
+
+void AstRecordMemStats(const Ast *self) {
+    if (!self) return;
+    MemStatsSetInUse(MEM_AST_EXPRS, self->exprs.count * sizeof(Expression));
+    MemStatsSetInUse(MEM_AST_ARGS, self->args.count * sizeof(Argument));
+    MemStatsSetInUse(MEM_AST_PARAMS, self->params.count * sizeof(ExprId));
+    InternerRecordMemStats(&self->symbols);
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Items
+// -------------------------------------------------------------------------- //
+
+// The least the holes in `items` and `root` grow by.
+#define MIN_HOLE 16
+
+// Makes room for more items at the gap, moving the ones after it up. The
+// hole grows by an eighth of the items, so that it rarely has to.
+static bool widenItems(Ast *self) {
+    AstItemSegList *items = &self->items;
+    const size_t count = items->count;
+    const size_t grow = count / 8 > MIN_HOLE ? count / 8 : MIN_HOLE;
+    const AstItem none = {0};
+    for (size_t i = 0; i < grow; i++) {
+        if (AstItemSegListPush(items, &none) != LIST_RES_OK) {
+            AstItemSegListTruncate(items, count);
+            return false;
+        }
+    }
+
+    for (size_t i = count; i > self->itemGap; i--)
+        *AstItemSegListGet(items, i - 1 + grow) =
+            *AstItemSegListGet(items, i - 1);
+    self->itemHole += grow;
+    return true;
+}
+
+// Same as `widenItems()`, for the roots.
+static bool widenRoots(Ast *self) {
+    ExprIdSegList *root = &self->root;
+    const size_t count = root->count;
+    const size_t grow = count / 8 > MIN_HOLE ? count / 8 : MIN_HOLE;
+    const ExprId none = NULL_AST_ID;
+    for (size_t i = 0; i < grow; i++) {
+        if (ExprIdSegListPush(root, &none) != LIST_RES_OK) {
+            ExprIdSegListTruncate(root, count);
+            return false;
+        }
+    }
+
+    for (size_t i = count; i > self->rootGap; i--)
+        *ExprIdSegListGet(root, i - 1 + grow) = *ExprIdSegListGet(root, i - 1);
+    self->rootHole += grow;
+    return true;
+}
+
+bool AstPushItem(Ast *self, const AstItem *item) {
+    const bool rooted = item->root != NULL_AST_ID;
+    if (self->itemHole == 0 && self->itemGap < self->items.count
+        && !widenItems(self))
+    {
+        return false;
+    }
+    if (rooted && self->rootHole == 0 && self->rootGap < self->root.count
+        && !widenRoots(self))
+    {
+        return false;
+    }
+
+    if (self->itemHole > 0) {
+        *AstItemSegListGet(&self->items, self->itemGap) = *item;
+        self->itemHole--;
+    } else if (AstItemSegListPush(&self->items, item) != LIST_RES_OK) {
+        return false;
+    }
+    self->itemGap++;
+
+    if (!rooted)
+        return true;
+    if (self->rootHole > 0) {
+        *ExprIdSegListGet(&self->root, self->rootGap) = item->root;
+        self->rootHole--;
+    } else if (ExprIdSegListPush(&self->root, &item->root) != LIST_RES_OK) {
+        // Take the item back out, so both lists still agree
+        self->itemGap--;
+        self->itemHole++;
+        return false;
+    }
+    self->rootGap++;
+    return true;
+}
+
+void AstSeekItem(Ast *self, size_t at) {
+    AstItemSegList *items = &self->items;
+    ExprIdSegList *root = &self->root;
+
+    // Items crossing the gap take on or drop its lag, their roots just move
+    while (self->itemGap > at) {
+        self->itemGap--;
+        AstItem item = *AstItemSegListGet(items, self->itemGap);
+        item.first -= self->gapTokens;
+        item.end   -= self->gapTokens;
+        item.diag  -= self->gapDiags;
+        item.base  -= self->gapDelta;
+        *AstItemSegListGet(items, self->itemGap + self->itemHole) = item;
+
+        if (item.root != NULL_AST_ID) {
+            self->rootGap--;
+            *ExprIdSegListGet(root, self->rootGap + self->rootHole) =
+                item.root;
+        }
+    }
+    while (self->itemGap < at) {
+        const AstItem item = AstItemAt(self, self->itemGap);
+        *AstItemSegListGet(items, self->itemGap) = item;
+        self->itemGap++;
+
+        if (item.root != NULL_AST_ID) {
+            *ExprIdSegListGet(root, self->rootGap) = item.root;
+            self->rootGap++;
+        }
+    }
+}
+
+void AstDropItems(Ast *self, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const AstItem *item = AstItemSegListGet(
+            &self->items, self->itemGap + self->itemHole);
+        self->itemHole++;
+        self->rootHole += item->root != NULL_AST_ID;
+
+        // The last item parsed gives its nodes straight back
+        if (item->exprs + item->exprCount == self->exprs.count
+            && item->args + item->argCount == self->args.count)
+        {
+            ExpressionSegListTruncate(&self->exprs, item->exprs);
+            ArgumentSegListTruncate(&self->args, item->args);
+        } else {
+            self->deadExprs += item->exprCount;
+            self->deadArgs  += item->argCount;
+        }
+    }
+}
+
+void AstMoveItems(
+    Ast *self,
+    size_t tokens,
+    size_t diags,
+    uint32_t headDelta,
+    uint32_t delta
+) {
+    self->gapTokens += tokens;
+    self->gapDiags  += diags;
+    self->gapDelta  += delta;
+    if (headDelta == 0)
+        return;
+    for (size_t i = 0; i < self->itemGap; i++)
+        AstItemSegListGet(&self->items, i)->base += headDelta;
+}
+
+// An item's nodes, to sort them by where they are.
+typedef struct ItemRun {
+    ExprId exprs;
+    size_t row;
+} ItemRun;
+
+static int byExprs(const void *lhs, const void *rhs) {
+    const ExprId a = ((const ItemRun *)lhs)->exprs;
+    const ExprId b = ((const ItemRun *)rhs)->exprs;
+    return (a > b) - (a < b);
+}
+
+bool AstCompact(Ast *self) {
+    if (!AstIsValid(self))
+        return false;
+
+    // The runs of nodes and arguments are in the same order, as an item only
+    // gives its nodes back when both are the last ones
+    const size_t count = AstItemCount(self);
+    ItemRun *runs = malloc((count + 1) * sizeof(ItemRun));
+    if (!runs)
+        return false;
+    for (size_t i = 0; i < count; i++) {
+        const size_t row = i < self->itemGap ? i : i + self->itemHole;
+        const AstItem *item = AstItemSegListGet(&self->items, row);
+        runs[i] = (ItemRun) { item->exprs, row };
+    }
+    qsort(runs, count, sizeof(ItemRun), byExprs);
+
+    // Slide every run down to the end of the one before
+    ExprId nextExpr = NULL_AST_ID + 1;
+    size_t nextArg  = 0;
+    for (size_t i = 0; i < count; i++) {
+        AstItem *item = AstItemSegListGet(&self->items, runs[i].row);
+        const ExprRemap by = {
+            .exprs = nextExpr - item->exprs,
+            .args  = nextArg - item->args,
+        };
+        for (size_t k = 0; (by.exprs || by.args) && k < item->exprCount; k++) {
+            const Expression moved = ExprRemapped(
+                ExpressionSegListGet(&self->exprs, item->exprs + k), &by);
+            // Silly workaround to avoid making Expression members non-const.
+            memcpy(ExpressionSegListGet(&self->exprs, nextExpr + k),
+                &moved, sizeof(Expression));
+        }
+        for (size_t k = 0; (by.exprs || by.args) && k < item->argCount; k++) {
+            const Argument moved = ArgumentRemapped(
+                ArgumentSegListGet(&self->args, item->args + k), &by);
+            memcpy(ArgumentSegListGet(&self->args, nextArg + k),
+                &moved, sizeof(Argument));
+        }
+
+        if (item->root != NULL_AST_ID) item->root += by.exprs;
+        item->exprs = nextExpr;
+        item->args  = nextArg;
+        nextExpr += item->exprCount;
+        nextArg  += item->argCount;
+    }
+    free(runs);
+
+    // The roots are the items' own, in order
+    size_t root = NULL_AST_ID + 1;
+    for (size_t i = 0; i < count; i++) {
+        const ExprId id = AstItemAt(self, i).root;
+        if (id == NULL_AST_ID)
+            continue;
+        const size_t row = root < self->rootGap ? root : root + self->rootHole;
+        *ExprIdSegListGet(&self->root, row) = id;
+        root++;
+    }
+
+    ExpressionSegListTruncate(&self->exprs, nextExpr);
+    ArgumentSegListTruncate(&self->args, nextArg);
+    self->deadExprs = 0;
+    self->deadArgs  = 0;
+    return true;
+}
+
+Span AstItemSpan(const AstItem *item, Span span) {
+    if (!item) return span;
+    return (Span) { item->base + span.offset, span.length };
+}
+
 void AstPrintArgList(const Ast *self) {
     for (size_t i = 0; i < self->args.count; i++) {
-        const Argument *arg = ListGet(&self->args, i);
+        const Argument *arg = ArgumentSegListGet(&self->args, i);
         printf("Arg(labeled: %s, value: %zu)\n",
             arg->hasLabel ? "yes" : "no", arg->value);
     }
@@ -2,7 +2,10 @@
 #define AST_H
 
 #include "../common/list.h"
+#include "../common/arena.h"
+#include "../common/seglist.h"
 #include "../common/source.h"
+#include "../common/intern.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -25,36 +28,176 @@ typedef size_t DeclId;
 // MARK: Non-Hierarchy Nodes
 // -------------------------------------------------------------------------- //
 
+// A call argument. `label` is interned in `Ast.symbols`, and `span` is
+// relative to its item like the spans of nodes.
 typedef struct Argument {
     const bool hasLabel;
-    const Substring label;
+    const SymbolId label;
     const ExprId value;
     const Span span;
 } Argument;
 
+// Where a top-level item came from, so that `ParseEdit()` can reuse it.
+// - `first` and `end` its tokens, `[first, end)`.
+// - `base` the offset of its first token. The spans of its nodes and
+// arguments are relative to it, so they never change when it moves.
+// - `exprs` and `args` its first node and argument, and `exprCount` and
+// `argCount` how many of them it pushed, in one run from there.
+// - `diag` its first diagnostic and `diags` how many parsing it reported.
+// - `root` its expression, or `NULL_AST_ID` if it was empty or had errors.
+typedef struct AstItem {
+    size_t first;
+    size_t end;
+    uint32_t base;
+    ExprId exprs;
+    size_t exprCount;
+    size_t args;
+    size_t argCount;
+    size_t diag;
+    size_t diags;
+    ExprId root;
+} AstItem;
+
+DEFINE_SEG_LIST(Argument)
+DEFINE_SEG_LIST(ExprId)
+DEFINE_SEG_LIST(AstItem)
+
+// Defined in `expr.h`, which also defines the `ExpressionSegList` methods.
+typedef struct Expression Expression;
+DECLARE_SEG_LIST(Expression)
+
 // -------------------------------------------------------------------------- //
 // MARK: AST
 // -------------------------------------------------------------------------- //
 
 // Stores all the data/information for an abstract syntax tree. This is source
 // agnostics and only holds lists of nodes.
+//
+// The node lists and side tables are `SegList`s, so nodes never move once
+// pushed and passes may hold on to `Expression *` across pushes. Symbols are
+// interned in `symbols`, so the AST does not refer back to the source text
+// for names. The spans of nodes are relative to their item (see `AstItem`),
+// and so is the text of string literals, unless they had escapes to decode,
+// then they are interned in `strings`.
+//
+// `root` holds the top-level items in source order. Only expressions are
+// parsed so far, so each item is an `ExprId`. `items` has every item,
+// empty ones and ones with errors too, with where it came from. Both are
+// gap buffers, read them with `AstItemAt()` and `AstRootAt()`.
+// - `itemGap` where the unused records are: items from `itemGap` on are
+// kept `itemHole` records further on, and their roots `rootHole` further on
+// from `rootGap`. The gap stays at the end unless the AST is edited.
+// - `gapTokens`, `gapDiags` and `gapDelta` added (wrapping) to the tokens,
+// diagnostics and `base` of the items kept past the gap.
+// - `deadExprs` and `deadArgs` nodes and arguments no item uses any more,
+// reclaimed by `AstCompact()`.
 typedef struct Ast {
-    List exprs;  // `List<Expression>`
+    ExpressionSegList exprs;
     List stmts;  // `List<Statement>`
     List decls;  // `List<Declaration>`
-    List root;   // `List<Declaration>` (ordered)
+    ExprIdSegList root;
     // --------- Side Tables ---------
-    List args;   // `List<Argument>`
-    List params; // `List<ExprId>`
+    ArgumentSegList args;
+    ExprIdSegList params;
+    AstItemSegList items;
+    Interner symbols;
+    Interner strings; // String literals that had escapes, decoded
+    // ------------- Gap -------------
+    size_t itemGap;
+    size_t itemHole;
+    size_t rootGap;
+    size_t rootHole;
+    size_t gapTokens;
+    size_t gapDiags;
+    uint32_t gapDelta;
+    size_t deadExprs;
+    size_t deadArgs;
 } Ast;
 
 // Creates a new blank AST. Please verify allocation with `AstIsValid()`.
 Ast AstNew();
 
+// Same as `AstNew()`, but every list is allocated from `arena` under
+// `ARENA_TAG_AST` instead of with its own `malloc`.
+Ast AstNewInArena(Arena *arena);
+
 // Checks that every list in the AST is valid and that each one has a
 // successfully allocated sentinel on the front.
 bool AstIsValid(const Ast *self);
 
+// Drops every node, item and symbol, leaving just the sentinels, but keeps
+// the memory, so that the AST can be reused without allocating again.
+void AstClear(Ast *self);
+
+// Frees a heap AST from `AstNew()` and poisons it. The lists of an arena
+// AST are left for the arena.
+void AstFree(Ast *self);
+
+// Reports the bytes occupied by each node list to `MemStatsSetInUse()`.
+void AstRecordMemStats(const Ast *self);
+
 void AstPrintArgList(const Ast *self);
 
+// -------------------------------------------------------------------------- //
+// MARK: Items
+// * `Parse()` pushes items at the end, `ParseEdit()` moves the gap to the
+// * items it parses again and replaces them there, so an edit only moves the
+// * items between it and the one before.
+// -------------------------------------------------------------------------- //
+
+// Returns how many items there are.
+static inline size_t AstItemCount(const Ast *self) {
+    return self->items.count - self->itemHole;
+}
+
+// Returns how many items have a root, plus the `NULL_AST_ID` sentinel.
+static inline size_t AstRootCount(const Ast *self) {
+    return self->root.count - self->rootHole;
+}
+
+// Returns item `i`, with its tokens, diagnostics and base where they are now.
+static inline AstItem AstItemAt(const Ast *self, size_t i) {
+    if (i < self->itemGap)
+        return *AstItemSegListGet(&self->items, i);
+
+    AstItem item = *AstItemSegListGet(&self->items, i + self->itemHole);
+    item.first += self->gapTokens;
+    item.end   += self->gapTokens;
+    item.diag  += self->gapDiags;
+    item.base  += self->gapDelta;
+    return item;
+}
+
+// Returns the root of the `i`th item that has one, `i` starting at 1.
+static inline ExprId AstRootAt(const Ast *self, size_t i) {
+    const size_t row = i < self->rootGap ? i : i + self->rootHole;
+    return *ExprIdSegListGet(&self->root, row);
+}
+
+// Inserts `item` at the gap, and its root if it has one. Returns `false` if
+// either list could not grow.
+bool AstPushItem(Ast *self, const AstItem *item);
+
+// Moves the gap to just before item `at`.
+void AstSeekItem(Ast *self, size_t at);
+
+// Drops the `count` items after the gap. Their nodes and arguments are given
+// back if they were the last ones pushed, and are dead otherwise.
+void AstDropItems(Ast *self, size_t count);
+
+// Adds `tokens`, `diags` and `delta` (all wrapping) to the items after the
+// gap, and `headDelta` to the base of the items before it.
+void AstMoveItems(Ast *self, size_t tokens, size_t diags, uint32_t headDelta,
+    uint32_t delta);
+
+// Moves the nodes and arguments of every item down over the dead ones, and
+// drops the rest. Returns `false` if memory ran out, leaving the AST as it
+// was.
+bool AstCompact(Ast *self);
+
+// Returns `span`, of one of the nodes or arguments of `item`, where it is in
+// the source. Spans of nodes parsed outside of any item are left as they are
+// for a `NULL` item.
+Span AstItemSpan(const AstItem *item, Span span);
+
 #endif
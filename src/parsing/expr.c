@@ -16,7 +16,7 @@ ExprId AstExprPush(Ast *ast, const Expression *expr) {
         return 0;
     }
     
-    ListResult res = ListPush(&ast->exprs, expr);
+    ListResult res = ExpressionSegListPush(&ast->exprs, expr);
     if (res != LIST_RES_OK && res != LIST_RES_REALLOC) {
         fprintf(stderr, "<error allocating an AST expression: %p>\n", expr);
         return 0;
@@ -25,5 +25,76 @@ ExprId AstExprPush(Ast *ast, const Expression *expr) {
 }
 
 Expression *AstExprGet(const Ast *self, ExprId id) {
-    return ListGet(&self->exprs, id);
-}
\ No newline at end of file
+    if (id >= self->exprs.count) {
+        fprintf(stderr, "<AstExprGet(): %zu is out of bounds>\n", id);
+        return NULL;
+    }
+    return ExpressionSegListGet(&self->exprs, id);
+}
+
+Substring ExprStringGet(
+    const Ast *ast,
+    const AstItem *item,
+    const ExprString *self
+) {
+    if (!ast || !self)
+        return NULL_SUBSTRING;
+    if (self->decoded != NULL_SYMBOL_ID)
+        return InternerGet(&ast->strings, self->decoded);
+    const Span text = AstItemSpan(item, self->text);
+    return SpanSubstring(&text);
+}
+
+// Only real ids move, `NULL_AST_ID` stays null.
+static inline ExprId remapId(ExprId id, const ExprRemap *by) {
+    return id == NULL_AST_ID ? NULL_AST_ID : id + by->exprs;
+}
+
+Expression ExprRemapped(const Expression *self, const ExprRemap *by) {
+    ExprData data = self->data;
+    switch (self->kind) {
+    case EXPR_SYMBOL:
+        if (by->symbols)
+            data.exprSymbol = by->symbols[data.exprSymbol];
+        break;
+    case EXPR_STR:
+        if (by->strings && data.exprString.decoded != NULL_SYMBOL_ID)
+            data.exprString.decoded = by->strings[data.exprString.decoded];
+        break;
+    case EXPR_CALL:
+        data.exprCall.callee = remapId(data.exprCall.callee, by);
+        data.exprCall.argid += by->args;
+        break;
+    case EXPR_POSTFIX:
+    case EXPR_PREFIX:
+        data.exprUnary.operand = remapId(data.exprUnary.operand, by);
+        break;
+    case EXPR_BINARY:
+    case EXPR_LOGICAL:
+    case EXPR_COMPARE:
+    case EXPR_EQUALITY:
+    case EXPR_ASSIGN:
+        data.exprBinary.lhs = remapId(data.exprBinary.lhs, by);
+        data.exprBinary.rhs = remapId(data.exprBinary.rhs, by);
+        break;
+    default:
+        break;
+    }
+
+    return (Expression) {
+        .span = self->span,
+        .kind = self->kind,
+        .data = data,
+    };
+}
+
+Argument ArgumentRemapped(const Argument *self, const ExprRemap *by) {
+    return (Argument) {
+        .hasLabel = self->hasLabel,
+        .label    = self->hasLabel && by->symbols
+            ? by->symbols[self->label]
+            : self->label,
+        .value    = remapId(self->value, by),
+        .span     = self->span,
+    };
+}
@@ -31,6 +31,21 @@ typedef struct ExprBinary {
     const char *op;
 } ExprBinary;
 
+// The contents of a string literal, without its quotes. Literals without
+// escapes are read straight from the source (zero copy) at `text`, which is
+// relative to their item like spans are. The others were decoded once into
+// `Ast.strings` as `decoded`.
+typedef struct ExprString {
+    Span     text;
+    SymbolId decoded;
+} ExprString;
+
+// Returns the contents of a string literal of `item` (`NULL` outside of
+// items), wherever they are. Decoded ones are only valid until the next
+// string is interned.
+Substring ExprStringGet(const Ast *ast, const AstItem *item,
+    const ExprString *self);
+
 // -------------------------------------------------------------------------- //
 // MARK: Variants
 // -------------------------------------------------------------------------- //
@@ -66,11 +81,11 @@ const char *ExprKindStr(const ExprKind kind);
 // Holds some data for an expression. Which variant to use is determined by the
 // `kind` of the expression.
 typedef union ExprData {
-    Substring    exprSymbol;
+    SymbolId     exprSymbol;
     int64_t      exprInt;
     double       exprFloat;
     bool         exprBool;
-    Substring    exprString;
+    ExprString   exprString;
     ExprCall     exprCall;
     ExprUnary    exprUnary;
     ExprBinary   exprBinary;
@@ -88,10 +103,29 @@ typedef struct Expression {
     const ExprData data;
 } Expression;
 
+DEFINE_SEG_LIST_METHODS(Expression)
+
 // Pushes the given expression to the AST (copies the data in the pointer)
 // and returns the index of said expression in the list.
 ExprId AstExprPush(Ast *ast, const Expression *expr);
 
+// How to move expressions and arguments from one AST into another.
+// - `exprs` and `args` are added to every expression id and argument index.
+// - `symbols` and `strings` map the old AST's symbol ids and decoded string
+// ids to the new one's, indexed by the old id, or are `NULL` to keep them.
+typedef struct ExprRemap {
+    size_t exprs;
+    size_t args;
+    const SymbolId *symbols;
+    const SymbolId *strings;
+} ExprRemap;
+
+// Returns a copy of `self` with every id in it remapped by `by`.
+Expression ExprRemapped(const Expression *self, const ExprRemap *by);
+
+// Returns a copy of `self` with its value remapped by `by`.
+Argument ArgumentRemapped(const Argument *self, const ExprRemap *by);
+
 // Returns te expression given by the provided index. Will fatally error if
 // the index is invalid or out of bounds.
 Expression *AstExprGet(const Ast *self, ExprId id);
@@ -1,5 +1,7 @@
 #include "parser.h"
 #include "../common/list.h"
+#include "../common/hash.h"
+#include "../scanning/literal.h"
 #include "../scanning/token.h"
 #include "ast.h"
 #include "expr.h"
@@ -12,13 +14,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#define POISON(id) if ((id) == NULL_AST_ID) return NULL_AST_ID
-
-#define STATUS(parser, msg)                                                    \
-    fprintf(stderr, "STATUS: '%s'", (msg));                                    \
-    fprintf(stderr, "\n  GET(0): %s",TokenKindAsString(get((parser),0)->kind));\
-    fprintf(stderr, "\n  GET(1): %s",TokenKindAsString(get((parser),1)->kind));\
-    fprintf(stderr, "\n");
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #ifdef LOG_PARSER
 #define LOG(fmt, ...) fprintf(stderr, fmt __VA_OPT__(,) __VA_ARGS__)
@@ -27,167 +26,113 @@
 #endif
 
 // -------------------------------------------------------------------------- //
-// MARK: Converters
+// MARK: Parser Helpers
 // -------------------------------------------------------------------------- //
 
-// Note: In the future, I may write a custom method to replace the length + 1
-// position with zero while the conversion is taking place, to trick strtoll
-// into thinking there is a null terminator, then replace it with the original
-// value when its done. This would be to avoid heap allocations.
-bool convertIntLiteral(const Span *span, int64_t *valout, Diagnostic *errout) {
-    char *endptr;
-    int errno = 0;
-
-    // Get the substring from the span
-    const Substring str = SpanSubstring(span);
-    if (SubstringIsNull(&str)) {
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "integer token in convertIntLiteral() yielded a null substring",
-            (DiagReport) { *span, "" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
-    }
-
-    // Allocate the substring
-    const char *allocString = SubstringAlloc(&str);
-    if (!allocString) {
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "integer token in convertIntLiteral() failed to allocate substring",
-            (DiagReport) { *span, "this span failed on its allocation attempt" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
-    }
-
-    // Attempt to do the conversion
-    long long result = strtoll(allocString, &endptr, 10);
-
-    // Check for errors
-    if (endptr == allocString) {
-        // No digits were in the string
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "integer token in convertIntLiteral() has span with no digits!",
-            (DiagReport) { *span, "" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
-    } else if (*endptr != 0) {
-        // Invalid characters in the string
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "integer token in convertIntLiteral() has span with non-digits!",
-            (DiagReport) { *span, "" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
-    } else {
-        // Everything worked
-        *valout = (int64_t)result;
-        return true;
-    }
+// Returns the number of tokens in this parser's token list.
+size_t count(const Parser *self) {
+    return self->tokenList->count;
 }
 
-bool convertFloatLiteral(const Span *span, double *valout, Diagnostic *errout) {
-    char *endptr;
-    int errno = 0;
+// Returns the window slot of the token at `index`.
+static inline Token *slot(Parser *self, size_t index) {
+    return &self->window[index & (PARSER_WINDOW - 1)];
+}
 
-    // Get the substring from the span
-    const Substring str = SpanSubstring(span);
-    if (SubstringIsNull(&str)) {
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "float token in convertFloatLiteral() yielded a null substring",
-            (DiagReport) { *span, "" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
-    }
+// Pulls tokens into the window until it holds the token at `index`, and
+// returns it. Past `TK_EOF`, returns the `TK_EOF` token. Stops at the first
+// token of the next item, which is returned for anything past it.
+static Token *pullTo(Parser *self, size_t index) {
+    // @(expect) the token is not behind the window.
+    assert(index + PARSER_WINDOW > self->pulled);
 
-    // Allocate the substring
-    const char *allocString = SubstringAlloc(&str);
-    if (!allocString) {
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "float token in convertFloatLiteral()"
-            "failed to allocate substring",
-            (DiagReport) { *span, "this span failed on its allocation attempt" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
+    while (self->pulled <= index && self->pulled <= self->itemEnd
+        && !self->pulledEnd
+    ) {
+        const size_t at = self->pulled++;
+        Token *token = slot(self, at);
+        self->tokens.pull(self->tokens.ctx, token);
+        self->pulledEnd = token->kind == TK_EOF;
+        if (ItemSplitStep(&self->split, token->kind) && at > self->itemStart)
+            self->itemEnd = at;
     }
 
-    // Attempt to do the conversion
-    double result = strtod(allocString, &endptr);
+    if (index >= self->pulled)
+        return slot(self, self->pulled - 1);
+    return slot(self, index);
+}
 
-    // Check for errors
-    if (endptr == allocString) {
-        // No digits were in the string
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "float token in convertFloatLiteral() has span with no digits!",
-            (DiagReport) { *span, "" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
-    } else if (*endptr != 0) {
-        // Invalid characters in the string
-        const Diagnostic diag = DiagNew(
-            ERR_INTERNAL,
-            "float token in convertFloatLiteral() has span with non-digits!",
-            (DiagReport) { *span, "" }
-        );
-        // Silly workaround to avoid making Diagnostic members non-const.
-        memcpy(errout, &diag, sizeof(Diagnostic));
-        return false;
-    } else {
-        // Everything worked
-        *valout = result;
-        return true;
+// Returns the kind of the token `k` ahead of the cursor, `TK_EOF` past the
+// end of the item. Only reads the kind array of a token list, so loops over
+// kinds stay in very few cache lines.
+TokenKind getKind(Parser *self, size_t k) {
+    // @(expect) never looks further ahead than the window allows.
+    assert(k <= PARSER_LOOKAHEAD);
+
+    const size_t index = self->cursor + k;
+    if (!self->tokenList) {
+        const TokenKind kind = pullTo(self, index)->kind;
+        return index >= self->itemEnd ? TK_EOF : kind;
     }
+    return index >= self->itemEnd
+        ? TK_EOF
+        : TLKind(self->tokenList, index);
 }
 
-// -------------------------------------------------------------------------- //
-// MARK: Parser Helpers
-// -------------------------------------------------------------------------- //
-
-// Returns the number of tokens in this parser's token list.
-size_t count(const Parser *self) {
-    return self->tokenList->tokens.count;
+// Returns the span of the token `k` ahead of the cursor. Past the end of
+// the item, that's the span of the token just after it.
+Span getSpan(Parser *self, size_t k) {
+    // @(expect) never looks further ahead than the window allows.
+    assert(k <= PARSER_LOOKAHEAD);
+
+    const size_t index = self->cursor + k;
+    if (!self->tokenList)
+        return pullTo(self, index)->span;
+    return TLSpan(self->tokenList,
+        index >= self->itemEnd ? self->itemEnd : index);
 }
 
-// The token pointer returned from this function is guaraunteed to not be `NULL`
-Token *get(const Parser *self, size_t k) {
-    if (self->cursor + k >= count(self)) {
-        return ((Token *)ListBack(&self->tokenList->tokens));
-    }
-    return (Token *)ListGet(&self->tokenList->tokens, self->cursor + k);
+// Returns the whole token `k` ahead of the cursor.
+Token get(Parser *self, size_t k) {
+    // @(expect) never looks further ahead than the window allows.
+    assert(k <= PARSER_LOOKAHEAD);
+
+    if (getKind(self, k) == TK_EOF)
+        return (Token) { .kind = TK_EOF, .span = getSpan(self, k) };
+    if (!self->tokenList)
+        return *pullTo(self, self->cursor + k);
+    return TLGet(self->tokenList, self->cursor + k);
 }
 
-// The token pointer returned from this function is guaraunteed to not be `NULL`
-Token *getBack(const Parser *self, size_t k) {
-    if (self->cursor <= k) {
-        return ((Token *)ListFront(&self->tokenList->tokens));
-    }
-    return (Token *)ListGet(&self->tokenList->tokens, self->cursor - k);
+// Returns the span of the token `k` behind the cursor, or of the first token
+// if there aren't that many behind it.
+Span getBackSpan(Parser *self, size_t k) {
+    // @(expect) never looks further behind than the window allows.
+    assert(k <= PARSER_LOOKBEHIND);
+
+    const size_t index = self->cursor <= k ? 0 : self->cursor - k;
+    if (!self->tokenList)
+        return pullTo(self, index)->span;
+    return TLSpan(self->tokenList, index);
 }
 
 // Advances the parser `k` tokens ahead. Will automatically prevent `cursor`
-// from being greater than the token list count.
+// from going past the end of the item.
 void next(Parser *self, size_t k) {
-    // Prevent the cursor from overflowing the length of the token list
-    if (self->cursor + k >= count(self)) {
-        self->cursor = count(self);
+    // A pulled stream has no count until `TK_EOF`, the tokens skipped here
+    // are pulled by the next `get()`.
+    if (!self->tokenList) {
+        self->cursor += k;
+        if (self->pulledEnd && self->cursor > self->pulled)
+            self->cursor = self->pulled;
+        if (self->cursor > self->itemEnd)
+            self->cursor = self->itemEnd;
+        return;
+    }
+
+    // Prevent the cursor from overflowing the item
+    if (self->cursor + k >= self->itemEnd) {
+        self->cursor = self->itemEnd;
         return;
     }
     self->cursor += k;
@@ -197,16 +142,16 @@ void next(Parser *self, size_t k) {
 // Will advance the parser `k` tokens in this case.
 // If not, will push a diagnostic and use `what` in the error report.
 bool expect(Parser *self, size_t k, TokenKind kind, const char *what) {
-    Token *tk = get(self, k);
+    const Token tk = get(self, k);
 
-    if (tk->kind == kind) {
+    if (tk.kind == kind) {
         next(self, 1);
         return true;
     }
 
     // Create a diagnostic
     const DiagReport report = (DiagReport) {
-        .span = tk->span,
+        .span = tk.span,
         .message = ""
     };
 
@@ -226,7 +171,7 @@ bool expect(Parser *self, size_t k, TokenKind kind, const char *what) {
 // Intended to be used to avoid causing problems when complicated parsers run
 // into errors that could propagate throughout entire AST structures.
 void recover(Parser *self) {
-    while (get(self, 0)->kind != TK_EOF && get(self, 0)->kind != TK_SEMICOLON) {
+    while (getKind(self, 0) != TK_EOF && getKind(self, 0) != TK_SEMICOLON) {
         next(self, 1);
     }
 }
@@ -237,6 +182,21 @@ void recover(Parser *self) {
 
 ExprId expression(Parser *self);
 
+// Returns `span` relative to the item being parsed.
+static inline Span itemSpan(const Parser *self, Span span) {
+    return (Span) { span.offset - self->itemBase, span.length };
+}
+
+// Pushes `expr` to the AST with its span made relative to the item.
+static ExprId pushExpr(Parser *self, const Expression *expr) {
+    const Expression relative = {
+        .span = itemSpan(self, expr->span),
+        .kind = expr->kind,
+        .data = expr->data,
+    };
+    return AstExprPush(self->ast, &relative);
+}
+
 // MARK: expr: atom()
 
 // Parses an atomic expression, most generally a literal of some kind.
@@ -247,8 +207,8 @@ ExprId expression(Parser *self);
 // * Boolean
 ExprId atom(Parser *self) {
     LOG("atom()\n");
-    const TokenKind kind = get(self, 0)->kind;
-    const Span      span = get(self, 0)->span;
+    const TokenKind kind = getKind(self, 0);
+    const Span      span = getSpan(self, 0);
 
     switch (kind) {
 
@@ -256,48 +216,33 @@ ExprId atom(Parser *self) {
     // ---------------------------- //
     case TK_INT: {
         LOG(". int\n");
-        Diagnostic diag = {0};
-        int64_t    value = 0;
-
-        // Attempt the conversion here
-        if (!convertIntLiteral(&span, &value, &diag)) {
-            DEPush(self->diagEngine, &diag);
-            break; // return null
-        }
 
+        // The scanner already decoded the value (and reported it if it
+        // couldn't)
         const Expression expr = {
             .span = span,
             .kind = EXPR_INT,
-            .data = { .exprInt = value }
+            .data = { .exprInt = get(self, 0).value.i }
         };
 
         // Advance and return
         next(self, 1);
-        return AstExprPush(self->ast, &expr);
+        return pushExpr(self, &expr);
     }
 
     // float
     // ---------------------------- //
     case TK_FLOAT: {
         LOG(". float\n");
-        Diagnostic diag  = {0};
-        double     value = 0;
-
-        // Attempt the conversion here
-        if (!convertFloatLiteral(&span, &value, &diag)) {
-            DEPush(self->diagEngine, &diag);
-            break; // return null
-        }
-
         const Expression expr = {
             .span = span,
             .kind = EXPR_FLOAT,
-            .data = { .exprFloat = value }
+            .data = { .exprFloat = get(self, 0).value.f }
         };
 
         // Advance and return
         next(self, 1);
-        return AstExprPush(self->ast, &expr);
+        return pushExpr(self, &expr);
     }
 
     // string
@@ -316,28 +261,57 @@ ExprId atom(Parser *self) {
         }
 
         //
-        // Update the span of the substring so that we exclude the `"`.
+        // Update the span of the substring so that we exclude the quotes.
         //
+        const Token token = get(self, 0);
+        const size_t open = token.hash & TOKEN_STR_RAW ? 2 : 1;
 
         // Make sure it's actually long enough to do our chopping.
-        if (substring.length < 2) {
+        if (substring.length < open + 1) {
             const Diagnostic diag = DiagNew(
                 ERR_INTERNAL,
-                "string token span yielded a substring shorter than 2 chars!",
+                "string token span yielded a substring without its quotes!",
                 (DiagReport) { span, "strings should be at least `\"\"`" }
             );
             DEPush(self->diagEngine, &diag);
             break; // return null
         }
 
-        // Make of a copy of this pointer so I can increment it without mutating
-        // the original substring.
-        const char *ptrcpy = substring.data;
-        const Substring string = {
-            .data = ptrcpy++,               // chop prefix  `"`
-            .length = substring.length - 1, // chop postfix `"`
+        const Substring text = {
+            .data   = substring.data + open,       // chop prefix  `"`
+            .length = substring.length - open - 1, // chop postfix `"`
+        };
+        const Span textSpan = {
+            .offset = span.offset + (uint32_t)open,
+            .length = (uint32_t)text.length,
+        };
+
+        // Most strings have no escapes and stay where they are, the others
+        // are decoded straight into the string pool
+        SymbolId decoded = NULL_SYMBOL_ID;
+        if (token.hash & TOKEN_STR_ESCAPED) {
+            Interner *strings = &self->ast->strings;
+            char *room = InternerReserve(strings, text.length);
+            if (!room) {
+                const Diagnostic diag = DiagNew(
+                    ERR_INTERNAL,
+                    "string literal could not be decoded into the pool",
+                    (DiagReport) { span, "" }
+                );
+                DEPush(self->diagEngine, &diag);
+                break; // return null
+            }
+
+            const size_t length = LiteralDecodeString(
+                text.data, text.length, room);
+            const uint32_t hash = HashFold32(HashBytes(room, length));
+            decoded = InternerInternReserved(strings, length, hash);
+        }
+
+        const ExprString string = {
+            .text    = decoded ? NULL_SPAN : itemSpan(self, textSpan),
+            .decoded = decoded,
         };
-        assert(string.length >= 2);
 
         const Expression expr = {
             .span = span,
@@ -347,7 +321,7 @@ ExprId atom(Parser *self) {
 
         // Advance and return
         next(self, 1);
-        return AstExprPush(self->ast, &expr);
+        return pushExpr(self, &expr);
     }
 
     // symbol
@@ -355,10 +329,14 @@ ExprId atom(Parser *self) {
     case TK_SYMBOL: {
         LOG(". symbol\n");
         const Substring symbol = SpanSubstring(&span);
-        if (SubstringIsNull(&symbol)) {
+        const SymbolId id = SubstringIsNull(&symbol)
+            ? NULL_SYMBOL_ID
+            : InternerIntern(&self->ast->symbols, symbol.data,
+                symbol.length, get(self, 0).hash);
+        if (id == NULL_SYMBOL_ID) {
             const Diagnostic diag = DiagNew(
                 ERR_INTERNAL,
-                "symbol token span yielded a null substring",
+                "symbol token span yielded a null substring or symbol",
                 (DiagReport) { span, "" }
             );
             DEPush(self->diagEngine, &diag);
@@ -368,12 +346,12 @@ ExprId atom(Parser *self) {
         const Expression expr = {
             .span = span,
             .kind = EXPR_SYMBOL,
-            .data = { .exprSymbol = symbol }
+            .data = { .exprSymbol = id }
         };
 
         // Advance and return
         next(self, 1);
-        return AstExprPush(self->ast, &expr);
+        return pushExpr(self, &expr);
     }
 
     // booleans
@@ -388,7 +366,7 @@ ExprId atom(Parser *self) {
 
         // Advance and return
         next(self, 1);
-        return AstExprPush(self->ast, &expr);
+        return pushExpr(self, &expr);
     }
     case TK_FALSE: {
         LOG(". false\n");
@@ -400,7 +378,7 @@ ExprId atom(Parser *self) {
 
         // Advance and return
         next(self, 1);
-        return AstExprPush(self->ast, &expr);
+        return pushExpr(self, &expr);
     }
 
     default: {
@@ -420,628 +398,988 @@ ExprId atom(Parser *self) {
     return NULL_AST_ID;
 }
 
-// MARK: expr: call()
-
-ExprId call(Parser *self) {
-    LOG("call()\n");
-    const TokenKind kind = get(self, 0)->kind;
-    const Span startSpan = get(self, 0)->span;
+// MARK: expr: binding powers
+
+// The levels of GRAMMAR.md, loosest first. `PREC_PREFIX` is how tightly a
+// prefix operator holds its operand, so `-x ** 2` negates the power.
+typedef enum Precedence {
+    PREC_NONE,
+    PREC_ASSIGNMENT,
+    PREC_LOGICAL_OR,
+    PREC_LOGICAL_AND,
+    PREC_EQUALITY,
+    PREC_COMPARISON,
+    PREC_TERM,
+    PREC_FACTOR,
+    PREC_PREFIX,
+    PREC_POWER,
+    PREC_POSTFIX,
+} Precedence;
+
+// An infix or postfix operator. It takes the expression on its left when
+// that was parsed with a minimum of at most `left`, and parses its right
+// operand with a minimum of `right`. Each level has two powers, so `right`
+// can be just above `left` (left associative) or just below (right
+// associative).
+typedef struct InfixOp {
+    uint8_t     left;
+    uint8_t     right;
+    ExprKind    kind;
+    const char *op;
+} InfixOp;
 
-    ExprId callee = atom(self);
-    POISON(callee);
+#define LEFT_ASSOC(prec)  (prec) * 2, (prec) * 2 + 1
+#define RIGHT_ASSOC(prec) (prec) * 2 + 1, (prec) * 2
 
-    //
-    // Look for the opening of a function call
-    //
-    if (get(self, 0)->kind == TK_LPAR) {
-        STATUS(self, "found fn call");
-        size_t argc  = 0;
-        size_t argid = self->ast->args.count;
-        printf(". argid initialized to: %zu\n", argid);
+// Every other kind is zeroed, with a `left` too low to ever be taken.
+static const InfixOp infixOps[TK_EOF + 1] = {
+    [TK_EQ]              = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "="   },
+    [TK_PLUS_EQ]         = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "+="  },
+    [TK_MIN_EQ]          = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "-="  },
+    [TK_STAR_EQ]         = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "*="  },
+    [TK_SLASH_EQ]        = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "/="  },
+    [TK_STAR_STAR_EQ]    = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "**=" },
+    [TK_SLASH_SLASH_EQ]  = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "//=" },
+    [TK_PERCENT_EQ]      = { RIGHT_ASSOC(PREC_ASSIGNMENT), EXPR_ASSIGN, "%="  },
 
-        // Eat the LPAR
-        next(self, 1);
+    [TK_PIPE_PIPE]       = { LEFT_ASSOC(PREC_LOGICAL_OR),  EXPR_LOGICAL, "||" },
+    [TK_AND_AND]         = { LEFT_ASSOC(PREC_LOGICAL_AND), EXPR_LOGICAL, "&&" },
 
-        // This condition will skip the whole loop if the thing immediately
-        // following the LPAR is an RPAR (i.e. the case where there is no args)
-        bool parsing = get(self, 0)->kind != TK_RPAR;
+    [TK_EQ_EQ]           = { LEFT_ASSOC(PREC_EQUALITY), EXPR_EQUALITY, "==" },
+    [TK_BANG_EQ]         = { LEFT_ASSOC(PREC_EQUALITY), EXPR_EQUALITY, "!=" },
 
-        STATUS(self, "before entering loop");
+    [TK_LT]              = { LEFT_ASSOC(PREC_COMPARISON), EXPR_COMPARE, "<"  },
+    [TK_LT_EQ]           = { LEFT_ASSOC(PREC_COMPARISON), EXPR_COMPARE, "<=" },
+    [TK_GT]              = { LEFT_ASSOC(PREC_COMPARISON), EXPR_COMPARE, ">"  },
+    [TK_GT_EQ]           = { LEFT_ASSOC(PREC_COMPARISON), EXPR_COMPARE, ">=" },
 
-        //
-        // Parse arguments
-        //
-        while (parsing) {
-            LOG(". parsing arg\n");
-            STATUS(self, "after entering loop");
-
-            bool   hasLabel = false;
-            Substring label = NULL_SUBSTRING;
-            const Span argSpan = get(self, 0)->span;
-
-            //
-            // Labeled Argument
-            //
-            if (get(self, 0)->kind == TK_SYMBOL
-                && get(self, 1)->kind == TK_COLON
-            ) {
-                LOG(".. arg has a label\n");
-                STATUS(self, "labeled argument");
-
-                const Substring substring = SpanSubstring(&argSpan);
-                if (SubstringIsNull(&substring)) {
-                    fprintf(
-                        stderr,
-                        "<call(): null substring in argument label>\n"
-                    );
-                }
-
-                // Eat the colon and go to what's after it
-                next(self, 2);
-
-                // Bullshit to work around const members of Substring
-                memcpy(&label, &substring, sizeof(Substring));
-                hasLabel = true;
-            }
+    [TK_PLUS]            = { LEFT_ASSOC(PREC_TERM), EXPR_BINARY, "+" },
+    [TK_MIN]             = { LEFT_ASSOC(PREC_TERM), EXPR_BINARY, "-" },
 
-            //
-            // Argument expression
-            //
-            const ExprId value = expression(self);
-            STATUS(self, "after arg expr parse");
+    [TK_STAR]            = { LEFT_ASSOC(PREC_FACTOR), EXPR_BINARY, "*"  },
+    [TK_SLASH]           = { LEFT_ASSOC(PREC_FACTOR), EXPR_BINARY, "/"  },
+    [TK_SLASH_SLASH]     = { LEFT_ASSOC(PREC_FACTOR), EXPR_BINARY, "//" },
+    [TK_PERCENT]         = { LEFT_ASSOC(PREC_FACTOR), EXPR_BINARY, "%"  },
 
-            // COMMA -> keep parsing
-            if (get(self, 0)->kind == TK_COMMA) {
-                next(self, 1);
+    [TK_STAR_STAR]       = { RIGHT_ASSOC(PREC_POWER), EXPR_BINARY, "**" },
 
-            // RPAR -> quit parsing
-            } else if (get(self, 0)->kind == TK_RPAR) {
-                next(self, 1);
-                parsing = false;
+    [TK_PLUS_PLUS]       = { LEFT_ASSOC(PREC_POSTFIX), EXPR_POSTFIX, "++" },
+    [TK_MIN_MIN]         = { LEFT_ASSOC(PREC_POSTFIX), EXPR_POSTFIX, "--" },
+};
 
-            // Anything else -> error
-            } else {
-                STATUS(self, "whoops, error!");
-                const Diagnostic diag = DiagNew(
-                    ERR_INVALID_SYNTAX,
-                    "expected either `,` to continue arguments or `)` to end"
-                    " function call",
-                    (DiagReport) { get(self, 0)->span, "" }
-                );
-                DEPush(self->diagEngine, &diag);
-                recover(self);
-                return NULL_AST_ID;
-            }
+#undef LEFT_ASSOC
+#undef RIGHT_ASSOC
 
-            // Don't add this arguemnt if it's invalid
-            if (value == NULL_AST_ID) {
-                STATUS(self, "null arg expr");
-                continue;
-            }
+// MARK: expr: stacks
 
-            // Compute the span of the argument
-            const Span previousSpan = getBack(self, 1)->span;
-            const Span span = SpanMerge(&argSpan, &previousSpan);
+// Returns the text of the prefix operator `kind`, or `NULL` if it isn't one.
+static const char *prefixOp(TokenKind kind) {
+    switch (kind) {
+    case TK_PLUS_PLUS: return "++";
+    case TK_MIN_MIN:   return "--";
+    case TK_BANG:      return "!";
+    case TK_MIN:       return "-";
+    default:           return NULL;
+    }
+}
 
-            printf("valueId: %zu\n", value);
+static bool pushOperand(Parser *self, ExprId id, Span start) {
+    const ParseOperand operand = { id, start };
+    return id != NULL_AST_ID
+        && ParseOperandVecPush(&self->operands, &operand) != LIST_RES_ERR;
+}
 
-            Argument arg = (Argument) {
-                .span = span,
-                .hasLabel = hasLabel,
-                .label = label,
-                .value = value,
-            };
+static ParseOperand popOperand(Parser *self) {
+    // @(expect) every operator and call has its operands on the stack.
+    assert(self->operands.count > 0);
+    return self->operands.data[--self->operands.count];
+}
 
-            // Push the argument to the list
-            ListPush(&self->ast->args, &arg);
-            argc++;
-        } // end with cursor -> RPAR
+// Returns the innermost frame opened since `base`, or `NULL`.
+static ParseFrame *topFrame(Parser *self, size_t base) {
+    if (self->frames.count <= base)
+        return NULL;
+    return ParseFrameVecBack(&self->frames);
+}
 
-        STATUS(self, "after loop");
-        printf("!argid: %zu, !argc: %zu\n", argid, argc);
+// Completes the pending operators (since `base`) whose right operand binds
+// tighter than `left`, innermost first, up to the first open `(` or call.
+// `left` is the power of the operator that follows, zero completes them all.
+static bool reduce(Parser *self, size_t base, unsigned left) {
+    ParseFrame *frame;
+    while ((frame = topFrame(self, base))
+        && (frame->kind == FRAME_PREFIX || frame->kind == FRAME_BINARY)
+        && frame->right > left
+    ) {
+        const ParseFrame op = *frame;
+        self->frames.count--;
+
+        ExprData data;
+        if (op.kind == FRAME_PREFIX) {
+            data.exprUnary = (ExprUnary) { popOperand(self).id, op.op };
+        } else {
+            const ParseOperand rhs = popOperand(self);
+            const ParseOperand lhs = popOperand(self);
+            data.exprBinary = (ExprBinary) { lhs.id, rhs.id, op.op };
+        }
 
-        // Put it all together
-        const Span *endSpan = &get(self, 0)->span;
-        //                     ^~~~~~~~~~~ this should point to the RPAR
+        const Span endSpan = getBackSpan(self, 1);
         const Expression expr = {
-            .span = SpanMerge(&startSpan, endSpan),
-            .kind = EXPR_CALL,
-            .data = { .exprCall =
-                { .callee = callee, .argc = argc, .argid = argid } }
+            .span = SpanMerge(&op.start, &endSpan),
+            .kind = op.exprKind,
+            .data = data
         };
-
-        // Advance and return
-        next(self, 1);
-        return AstExprPush(self->ast, &expr);
+        if (!pushOperand(self, pushExpr(self, &expr), op.start))
+            return false;
     }
-
-    //
-    // If there is not a function call, then return the expr up the call stack
-    //
-    return callee;
+    return true;
 }
 
-// MARK: expr: postfix()
+// Opens the next argument of `call` at the cursor, eating its label first
+// if it has one.
+static void openArgument(Parser *self, ParseFrame *call) {
+    // Silly workaround to avoid making Span members non-const.
+    const Span start = getSpan(self, 0);
+    memcpy(&call->argStart, &start, sizeof(Span));
+
+    call->hasLabel = getKind(self, 0) == TK_SYMBOL
+        && getKind(self, 1) == TK_COLON;
+    call->label = NULL_SYMBOL_ID;
+    if (call->hasLabel) {
+        LOG(".. arg has a label\n");
+        const Substring label = SpanSubstring(&start);
+        if (!SubstringIsNull(&label))
+            call->label = InternerIntern(&self->ast->symbols, label.data,
+                label.length, get(self, 0).hash);
+        if (call->label == NULL_SYMBOL_ID)
+            fprintf(stderr, "<openArgument(): label was not interned>\n");
+        next(self, 2);
+    }
+}
 
-ExprId postfix(Parser *self) {
-    const Span startSpan = get(self, 0)->span;
-    ExprId operand = call(self);
-    POISON(operand);
+// Closes the argument of `call` that is on top of the operand stack. It
+// spans from its label (if any) to the token before the cursor.
+static bool closeArgument(Parser *self, ParseFrame *call) {
+    const ParseOperand value = popOperand(self);
+    const Span endSpan = getBackSpan(self, 1);
+    const Span span = SpanMerge(&call->argStart, &endSpan);
+
+    const Argument arg = {
+        .span     = itemSpan(self, span),
+        .hasLabel = call->hasLabel,
+        .label    = call->label,
+        .value    = value.id,
+    };
+    if (ArgumentVecPush(&self->argScratch, &arg) == LIST_RES_ERR)
+        return false;
+    call->argc++;
+    return true;
+}
 
-    //
-    // Look for a postfix operator AFTER the operand is parsed
-    //
-    const char *op;
-    const TokenKind kind = get(self, 0)->kind;
-    switch (kind) {
-    case TK_PLUS_PLUS:
-        op = "++";
-        break;
-    case TK_MIN_MIN:
-        op = "--";
-        break;
-    default:
-        return operand;
+// Completes the call on top of the frame stack, with the cursor on its `)`,
+// and moves its arguments off the scratch stack into the AST in one block.
+static bool closeCall(Parser *self) {
+    const ParseFrame call = *ParseFrameVecBack(&self->frames);
+    self->frames.count--;
+
+    // @(expect) the call's arguments are the top of the scratch stack.
+    assert(self->argScratch.count == call.argBase + call.argc);
+    const size_t argid = self->ast->args.count;
+    if (call.argc > 0) {
+        const ListResult res = ArgumentSegListExtend(&self->ast->args,
+            &self->argScratch.data[call.argBase], call.argc);
+        if (res != LIST_RES_OK)
+            return false;
     }
+    self->argScratch.count = call.argBase;
 
-    //
-    // Complete the expression
-    //
-    const Span endSpan = getBack(self, 1)->span;
+    const Span endSpan = getSpan(self, 0);
     const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_POSTFIX,
-        .data = { .exprUnary = { operand, op } }
+        .span = SpanMerge(&call.start, &endSpan),
+        .kind = EXPR_CALL,
+        .data = { .exprCall = {
+            .callee = call.callee, .argc = call.argc, .argid = argid } }
     };
-
-    // Advance and return
     next(self, 1);
-    return AstExprPush(self->ast, &expr);
+    return pushOperand(self, pushExpr(self, &expr), call.start);
 }
 
-// MARK: expr: prefix()
+// MARK: expr: expression()
+
+// Parses an expression with the shunting-yard algorithm. Operands and the
+// operators, parentheses and calls still open around them wait on the
+// parser's stacks, and an operator completes the ones before it that bind
+// tighter (see `infixOps`). It alternates between expecting an operand
+// (with prefix operators and `(` before it) and an operator (or a call, `,`
+// or `)`) after one.
+ExprId expression(Parser *self) {
+    LOG("expression()\n");
+    const size_t operandBase = self->operands.count;
+    const size_t frameBase   = self->frames.count;
+    const size_t argBase     = self->argScratch.count;
+
+    // Whether the operand on top can be called, i.e. it's an atom, a call or
+    // in parentheses
+    bool callable = false;
+    bool operand  = true;
+    bool ok       = true;
+
+    while (ok) {
+        const TokenKind kind = getKind(self, 0);
+        const Span      span = getSpan(self, 0);
 
-ExprId prefix(Parser *self) {
-    LOG("prefix()\n");
-    const Span startSpan = get(self, 0)->span;
-    const TokenKind kind = get(self, 0)->kind;
+        //
+        // Operands, and what can come before one
+        //
+        if (operand) {
+            const char *op = prefixOp(kind);
+            if (op) {
+                LOG(". prefix op: %s\n", op);
+                const ParseFrame frame = {
+                    .kind = FRAME_PREFIX, .exprKind = EXPR_PREFIX,
+                    .right = PREC_PREFIX * 2, .op = op, .start = span,
+                };
+                ok = ParseFrameVecPush(&self->frames, &frame) != LIST_RES_ERR;
+                next(self, 1);
+            } else if (kind == TK_LPAR) {
+                LOG(". group\n");
+                const ParseFrame frame = { .kind = FRAME_GROUP, .start = span };
+                ok = ParseFrameVecPush(&self->frames, &frame) != LIST_RES_ERR;
+                next(self, 1);
+            } else {
+                ok = pushOperand(self, atom(self), span);
+                callable = true;
+                operand  = false;
+            }
+            continue;
+        }
 
-    //
-    // Look for a postfix operator BEFORE the operand is parsed
-    //
-    const char *op;
-    switch (kind) {
-    case TK_PLUS_PLUS:
-        LOG(". op: ++\n");
-        op = "++";
-        break;
-    case TK_MIN_MIN:
-        LOG(". op: --\n");
-        op = "--";
-        break;
-    case TK_BANG:
-        LOG(". op: !\n");
-        op = "!";
-        break;
-    case TK_MIN:
-        LOG(". op: -\n");
-        op = "-";
-        break;
-    default:
-        return postfix(self);
-    }
+        //
+        // Calls, which take the operand right before them
+        //
+        if (kind == TK_LPAR && callable) {
+            LOG(". call\n");
+            const ParseOperand callee = popOperand(self);
+            const ParseFrame frame = {
+                .kind    = FRAME_CALL,
+                .start   = callee.start,
+                .callee  = callee.id,
+                .argBase = self->argScratch.count,
+            };
+            ok = ParseFrameVecPush(&self->frames, &frame) != LIST_RES_ERR;
+            next(self, 1);
+
+            if (ok && getKind(self, 0) == TK_RPAR) {
+                ok = closeCall(self);
+            } else if (ok) {
+                openArgument(self, ParseFrameVecBack(&self->frames));
+                operand = true;
+            }
+            continue;
+        }
 
-    next(self, 1);
+        //
+        // Infix and postfix operators
+        //
+        const InfixOp *op = &infixOps[kind];
+        if (op->left > 0) {
+            LOG(". op: %s\n", op->op);
+            ok = reduce(self, frameBase, op->left);
+            if (!ok)
+                break;
+
+            const Span start = ParseOperandVecBack(&self->operands)->start;
+            next(self, 1);
+
+            // Postfix operators complete right away
+            if (op->kind == EXPR_POSTFIX) {
+                const ExprId operand = popOperand(self).id;
+                const Span endSpan = getBackSpan(self, 1);
+                const Expression expr = {
+                    .span = SpanMerge(&start, &endSpan),
+                    .kind = EXPR_POSTFIX,
+                    .data = { .exprUnary = { operand, op->op } }
+                };
+                ok = pushOperand(self, pushExpr(self, &expr), start);
+                callable = false;
+                continue;
+            }
 
-    //
-    // Then parse the operand
-    //
-    ExprId operand = postfix(self);
-    POISON(operand);
-    LOG(". good operand\n");
+            const ParseFrame frame = {
+                .kind = FRAME_BINARY, .exprKind = op->kind,
+                .right = op->right, .op = op->op, .start = start,
+            };
+            ok = ParseFrameVecPush(&self->frames, &frame) != LIST_RES_ERR;
+            operand = true;
+            continue;
+        }
+
+        //
+        // `,` and `)` close what's inside the innermost `(` or call
+        //
+        if (kind != TK_COMMA && kind != TK_RPAR)
+            break;
+        ok = reduce(self, frameBase, 0);
+        ParseFrame *frame = topFrame(self, frameBase);
+        if (!ok || !frame)
+            break;
+
+        if (frame->kind == FRAME_GROUP && kind == TK_RPAR) {
+            // The inner expression now starts at the `(`. Silly workaround
+            // to avoid making Span members non-const.
+            memcpy(&ParseOperandVecBack(&self->operands)->start,
+                &frame->start, sizeof(Span));
+            self->frames.count--;
+            next(self, 1);
+            callable = true;
+        } else if (frame->kind == FRAME_CALL) {
+            ok = closeArgument(self, frame);
+            if (ok && kind == TK_RPAR) {
+                ok = closeCall(self);
+                callable = true;
+            } else if (ok) {
+                next(self, 1);
+                openArgument(self, frame);
+                operand = true;
+            }
+        } else {
+            break;
+        }
+    }
 
     //
-    // Complete the expression
+    // The end of the expression, unless something is still open
     //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_PREFIX,
-        .data = { .exprUnary = { operand, op } }
-    };
+    if (ok)
+        ok = reduce(self, frameBase, 0);
 
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
-}
+    const ParseFrame *open = topFrame(self, frameBase);
+    if (ok && open) {
+        const Diagnostic diag = DiagNew(
+            ERR_INVALID_SYNTAX,
+            open->kind == FRAME_CALL
+                ? "expected either `,` to continue arguments or `)` to end"
+                  " function call"
+                : "expected `)` to close the parentheses",
+            (DiagReport) { getSpan(self, 0), "" }
+        );
+        DEPush(self->diagEngine, &diag);
+        recover(self);
+        ok = false;
+    }
 
-// MARK: expr: factor()
+    const ExprId result = ok
+        ? ParseOperandVecGet(&self->operands, operandBase)->id
+        : NULL_AST_ID;
+    self->operands.count   = operandBase;
+    self->frames.count     = frameBase;
+    self->argScratch.count = argBase;
+    return result;
+}
 
-ExprId factor(Parser *self) {
-    LOG("factor()\n");
-    const Span startSpan = get(self, 0)->span;
+// -------------------------------------------------------------------------- //
+// MARK: Top-Level Items
+// -------------------------------------------------------------------------- //
 
-    const ExprId lhs = prefix(self);
-    POISON(lhs);
+// Parses the item from the cursor to `self->itemEnd` and adds it to the
+// root. Whatever is left of it after an error is skipped.
+static void item(Parser *self) {
+    LOG("item()\n");
+    Ast *ast = self->ast;
+    const size_t first     = self->cursor;
+    const ExprId exprs     = ast->exprs.count;
+    const size_t args      = ast->args.count;
+    const size_t diagCount = self->diagEngine->diagnostics.count;
+    self->itemBase = getSpan(self, 0).offset;
+
+    // An empty item is just a `;`
+    ExprId expr = NULL_AST_ID;
+    if (getKind(self, 0) != TK_SEMICOLON)
+        expr = expression(self);
 
-    //
-    // Look for a binary infix operator BEFORE the RHS is parsed
-    //
-    const char *op;
-    switch (get(self, 0)->kind) {
-    case TK_STAR:
-        LOG(". op: *\n");
-        op = "*";
-        break;
-    case TK_SLASH:
-        LOG(". op: /\n");
-        op = "/";
-        break;
-    default:
-        return lhs;
+    if (expr != NULL_AST_ID) {
+        if (getKind(self, 0) == TK_SEMICOLON)
+            next(self, 1);
+        if (getKind(self, 0) != TK_EOF) {
+            const Diagnostic diag = DiagNew(
+                ERR_INVALID_SYNTAX,
+                "expected `;` after an expression",
+                (DiagReport) { getSpan(self, 0), "" }
+            );
+            DEPush(self->diagEngine, &diag);
+        }
     }
 
-    next(self, 1);
+    while (getKind(self, 0) != TK_EOF)
+        next(self, 1);
 
-    // Parse the RHS expression
-    const ExprId rhs = expression(self);
-    POISON(rhs);
-    LOG(". good rhs\n");
+    // Its diagnostics follow those of the item before it
+    size_t diag = 0;
+    if (ast->itemGap > 0) {
+        const AstItem *prev = AstItemSegListGet(&ast->items, ast->itemGap - 1);
+        diag = prev->diag + prev->diags;
+    }
 
-    //
-    // Complete the expression
-    //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_BINARY,
-        .data = { .exprBinary = { lhs, rhs, op } }
+    const AstItem record = {
+        .first     = first,
+        .end       = self->cursor,
+        .base      = self->itemBase,
+        .exprs     = exprs,
+        .exprCount = ast->exprs.count - exprs,
+        .args      = args,
+        .argCount  = ast->args.count - args,
+        .diag      = diag,
+        .diags     = self->diagEngine->diagnostics.count - diagCount,
+        .root      = expr,
     };
+    /* discard */ AstPushItem(ast, &record);
+    self->itemBase = 0;
+}
 
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
+// Parses one item of a token list.
+static void parseItem(Parser *self, const ParseItem *range) {
+    self->cursor    = range->first;
+    self->itemStart = range->first;
+    self->itemEnd   = range->end;
+    item(self);
 }
 
-// MARK: expr: term()
+bool ParseFindItems(const TokenList *tokens, ParseItemVec *items) {
+    ItemSplit split = {0};
+    size_t first = SIZE_MAX;
+    size_t i = 0;
+    for (; i < tokens->count && TLKind(tokens, i) != TK_EOF; i++) {
+        if (!ItemSplitStep(&split, TLKind(tokens, i)))
+            continue;
+        if (first != SIZE_MAX) {
+            const ParseItem item = { first, i };
+            if (ParseItemVecPush(items, &item) == LIST_RES_ERR)
+                return false;
+        }
+        first = i;
+    }
 
-ExprId term(Parser *self) {
-    LOG("term()\n");
-    const Span startSpan = get(self, 0)->span;
+    if (first == SIZE_MAX)
+        return true;
+    const ParseItem item = { first, i };
+    return ParseItemVecPush(items, &item) != LIST_RES_ERR;
+}
 
-    const ExprId lhs = factor(self);
-    POISON(lhs);
+// -------------------------------------------------------------------------- //
+// MARK: Parser API
+// -------------------------------------------------------------------------- //
 
-    //
-    // Look for a binary infix operator BEFORE the RHS is parsed
-    //
-    const char *op;
-    switch (get(self, 0)->kind) {
-    case TK_PLUS:
-        LOG(". op: +\n");
-        op = "+";
-        break;
-    case TK_MIN:
-        LOG(". op: -\n");
-        op = "-";
-        break;
-    default:
-        return lhs;
+Parser ParserNew(
+    const Source *src,
+    Ast *ast,
+    DiagEngine *diagEngine,
+    const TokenList *tokenList
+) {
+    if (!src
+        || !ast
+        || !diagEngine
+        || !tokenList
+        || tokenList->count == 0
+    ) {
+        return (Parser) {0};
     }
 
-    next(self, 1);
+    return (Parser) {
+        .src = src,
+        .diagEngine = diagEngine,
+        .tokenList = tokenList,
+        .ast = ast,
+        .cursor = 0,
+        .itemEnd = tokenList->count - 1,
+    };
+}
 
-    // Parse the RHS expression
-    const ExprId rhs = expression(self);
-    POISON(rhs);
-    LOG(". good rhs\n");
+Parser ParserNewFromSource(
+    const Source *src,
+    Ast *ast,
+    DiagEngine *diagEngine,
+    TokenSource tokens
+) {
+    if (!src || !ast || !diagEngine || !TokenSourceIsValid(&tokens))
+        return (Parser) {0};
 
-    //
-    // Complete the expression
-    //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_BINARY,
-        .data = { .exprBinary = { lhs, rhs, op } }
+    return (Parser) {
+        .src = src,
+        .diagEngine = diagEngine,
+        .tokenList = NULL,
+        .tokens = tokens,
+        .ast = ast,
+        .cursor = 0,
+        .pulled = 0,
+        .pulledEnd = false,
+        .itemEnd = SIZE_MAX,
     };
-
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
 }
 
-// MARK: expr: comparison()
+bool ParserIsValid(const Parser *self) {
+    return (self
+        && self->ast
+        && self->diagEngine
+        && (self->tokenList
+            ? TLIsValid(self->tokenList)
+            : TokenSourceIsValid(&self->tokens))
+        && DiagnosticVecIsValid(&self->diagEngine->diagnostics)
+        && AstIsValid(self->ast)
+    );
+}
 
-ExprId comparison(Parser *self) {
-    LOG("comparison()\n");
-    const Span startSpan = get(self, 0)->span;
+void ParserFree(Parser *self) {
+    if (!self)
+        return;
+    ParseOperandVecFree(&self->operands);
+    ParseFrameVecFree(&self->frames);
+    ArgumentVecFree(&self->argScratch);
+}
 
-    const ExprId lhs = term(self);
-    POISON(lhs);
+void Parse(Parser *self, bool *success) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
+    }
 
-    //
-    // Look for a binary infix operator BEFORE the RHS is parsed
-    //
-    const char *op;
-    switch (get(self, 0)->kind) {
-    case TK_LT:
-        LOG(". op: <\n");
-        op = "<";
-        break;
-    case TK_LT_EQ:
-        LOG(". op: <=\n");
-        op = "<=";
-        break;
-    case TK_GT:
-        LOG(". op: >\n");
-        op = ">";
-        break;
-    case TK_GT_EQ:
-        LOG(". op: >=\n");
-        op = ">=";
-        break;
-    default:
-        return lhs;
+    const size_t diagCount = self->diagEngine->diagnostics.count;
+    if (self->tokenList) {
+        ParseItemVec items = {0};
+        *success = ParseFindItems(self->tokenList, &items);
+        for (size_t i = 0; *success && i < items.count; i++)
+            parseItem(self, &items.data[i]);
+        ParseItemVecFree(&items);
+    } else {
+        // The items of a pulled stream are found as it's pulled
+        *success = true;
+        while (true) {
+            self->itemStart = self->cursor;
+            self->itemEnd   = SIZE_MAX;
+            if (getKind(self, 0) == TK_EOF)
+                break;
+            item(self);
+        }
     }
 
-    next(self, 1);
+    *success = *success
+        && self->diagEngine->diagnostics.count == diagCount;
+}
 
-    // Parse the RHS expression
-    const ExprId rhs = expression(self);
-    POISON(rhs);
-    LOG(". good rhs\n");
+void ParseItemOf(Parser *self, const ParseItem *item, bool *success) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
+    }
 
-    //
-    // Complete the expression
-    //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_COMPARE,
-        .data = { .exprBinary = { lhs, rhs, op } }
-    };
+    // @(expect) the item is followed by at least the `TK_EOF` token.
+    if (!self->tokenList || item->end >= count(self)) {
+        *success = false;
+        return;
+    }
 
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
+    const size_t diagCount = self->diagEngine->diagnostics.count;
+    parseItem(self, item);
+    *success = self->diagEngine->diagnostics.count == diagCount;
 }
 
-// MARK: expr: equality()
+// -------------------------------------------------------------------------- //
+// MARK: Parallel Parse
+// * Items are parsed independently of each other, so runs of them can be
+// * parsed on their own threads. The first run goes straight into the AST,
+// * the others into ASTs of their own, which are then appended in order with
+// * their ids moved up past what's already there. Symbols are interned again
+// * in the order of their ids, which is the order they were first seen in,
+// * so they get the same ids `Parse()` would have given them.
+// -------------------------------------------------------------------------- //
+
+typedef struct ParseChunk {
+    const Parser *whole;
+    const ParseItem *items;
+    size_t count;
+    Ast ast;
+    DiagEngine diags;
+    bool valid;
+#ifndef _WIN32
+    pthread_t thread;
+    bool started;
+#endif
+} ParseChunk;
 
-ExprId equality(Parser *self) {
-    LOG("equality()\n");
-    const Span startSpan = get(self, 0)->span;
+static size_t cpuCount() {
+#ifdef _WIN32
+    return 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#endif
+}
 
-    const ExprId lhs = comparison(self);
-    POISON(lhs);
+static void *parseChunk(void *arg) {
+    ParseChunk *chunk = arg;
+    Parser parser = ParserNew(chunk->whole->src, &chunk->ast, &chunk->diags,
+        chunk->whole->tokenList);
+    if (!ParserIsValid(&parser))
+        return NULL;
+
+    for (size_t i = 0; i < chunk->count; i++)
+        parseItem(&parser, &chunk->items[i]);
+    ParserFree(&parser);
+    chunk->valid = true;
+    return NULL;
+}
 
-    //
-    // Look for a binary infix operator BEFORE the RHS is parsed
-    //
-    const char *op;
-    switch (get(self, 0)->kind) {
-    case TK_EQ_EQ:
-        LOG(". op: ==\n");
-        op = "==";
-        break;
-    case TK_BANG_EQ:
-        LOG(". op: !=\n");
-        op = "!=";
-        break;
-    default:
-        return lhs;
+// Re-interns every symbol of `from` into `into`, in id order, and returns
+// the new id of each old one (indexed by the old id), or `NULL`.
+static SymbolId *remapSymbols(Interner *into, const Interner *from) {
+    const SymbolVec *symbols = &from->symbols;
+    SymbolId *map = calloc(symbols->count, sizeof(SymbolId));
+    if (!map)
+        return NULL;
+
+    for (size_t id = NULL_SYMBOL_ID + 1; id < symbols->count; id++) {
+        const Substring text = InternerGet(from, (SymbolId)id);
+        map[id] = InternerIntern(
+            into, text.data, text.length, symbols->data[id].hash);
+        if (map[id] == NULL_SYMBOL_ID) {
+            free(map);
+            return NULL;
+        }
     }
+    return map;
+}
 
-    next(self, 1);
+// Appends the nodes, arguments, items and diagnostics of a chunk's AST to
+// the parser's, with every id moved to where it lands.
+static bool takeChunk(Parser *self, const ParseChunk *chunk) {
+    Ast *ast = self->ast;
+    const Ast *from = &chunk->ast;
+
+    SymbolId *symbols = remapSymbols(&ast->symbols, &from->symbols);
+    SymbolId *strings = remapSymbols(&ast->strings, &from->strings);
+    bool ok = symbols && strings;
+
+    // Node 1 of the chunk lands just past the last node of the AST
+    const ExprRemap by = {
+        .exprs   = ast->exprs.count - 1,
+        .args    = ast->args.count,
+        .symbols = symbols,
+        .strings = strings,
+    };
 
-    // Parse the RHS expression
-    const ExprId rhs = expression(self);
-    POISON(rhs);
-    LOG(". good rhs\n");
+    for (size_t i = NULL_AST_ID + 1; ok && i < from->exprs.count; i++) {
+        const Expression expr = ExprRemapped(
+            ExpressionSegListGet(&from->exprs, i), &by);
+        ok = ExpressionSegListPush(&ast->exprs, &expr) == LIST_RES_OK;
+    }
+    for (size_t i = 0; ok && i < from->args.count; i++) {
+        const Argument arg = ArgumentRemapped(
+            ArgumentSegListGet(&from->args, i), &by);
+        ok = ArgumentSegListPush(&ast->args, &arg) == LIST_RES_OK;
+    }
+    // Its items' diagnostics follow those already there
+    size_t diag = 0;
+    if (AstItemCount(ast) > 0) {
+        const AstItem last = AstItemAt(ast, AstItemCount(ast) - 1);
+        diag = last.diag + last.diags;
+    }
+    for (size_t i = 0; ok && i < AstItemCount(from); i++) {
+        AstItem item = AstItemAt(from, i);
+        item.exprs += by.exprs;
+        item.args  += by.args;
+        item.diag  += diag;
+        if (item.root != NULL_AST_ID) item.root += by.exprs;
+        ok = AstPushItem(ast, &item);
+    }
 
-    //
-    // Complete the expression
-    //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_EQUALITY,
-        .data = { .exprBinary = { lhs, rhs, op } }
-    };
+    const DiagnosticVec *diags = &chunk->diags.diagnostics;
+    if (ok && diags->count > 0)
+        ok = DiagnosticVecExtend(&self->diagEngine->diagnostics,
+            diags->data, diags->count) != LIST_RES_ERR;
 
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
+    free(symbols);
+    free(strings);
+    return ok;
 }
 
-// MARK: expr: logicalOr()
+void ParseParallel(
+    Parser *self,
+    size_t threads,
+    size_t minChunk,
+    bool *success
+) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
+    }
 
-ExprId logicalOr(Parser *self) {
-    LOG("logicalOr()\n");
-    const Span startSpan = get(self, 0)->span;
+    if (!self->tokenList) {
+        Parse(self, success);
+        return;
+    }
 
-    const ExprId lhs = equality(self);
-    POISON(lhs);
+    const TokenList *tokens = self->tokenList;
+    if (threads == 0) threads = cpuCount();
+    if (minChunk == 0) minChunk = PARSE_MIN_CHUNK;
+    size_t count = tokens->count / minChunk;
+    if (count > threads) count = threads;
+
+    ParseItemVec items = {0};
+    ParseChunk *chunks = count > 1 ? calloc(count, sizeof(ParseChunk)) : NULL;
+    if (!chunks || !ParseFindItems(tokens, &items) || items.count < 2) {
+        free(chunks);
+        ParseItemVecFree(&items);
+        Parse(self, success);
+        return;
+    }
 
     //
-    // Look for the operator and return if it isn't there
+    // Cut the items into runs of about the same number of tokens. An item
+    // longer than a run swallows the next run.
     //
-    if (get(self, 0)->kind != TK_PIPE_PIPE) {
-        return lhs;
+    size_t first = 0;
+    for (size_t i = 0; i < count; i++) {
+        const size_t start  = items.data[first].first;
+        const size_t target = start + (tokens->count - start) / (count - i);
+        size_t end = first + 1;
+        while (end < items.count && items.data[end].first < target) end++;
+        if (i + 1 == count) end = items.count;
+
+        chunks[i] = (ParseChunk) {
+            .whole = self,
+            .items = &items.data[first],
+            .count = end - first,
+        };
+        if (i > 0) {
+            chunks[i].ast   = AstNew();
+            chunks[i].diags = DENew();
+        }
+        first = end;
+        if (end == items.count) {
+            count = i + 1;
+            break;
+        }
     }
-    const char *op = "||";
-    next(self, 1);
 
-    LOG(". op: ||\n");
+    // Chunk 0 is parsed here, straight into the AST, the rest on their own
+    // threads when possible
+#ifndef _WIN32
+    for (size_t i = 1; i < count; i++)
+        chunks[i].started = pthread_create(
+            &chunks[i].thread, NULL, parseChunk, &chunks[i]) == 0;
+#endif
+    const size_t diagCount = self->diagEngine->diagnostics.count;
+    for (size_t i = 0; i < chunks[0].count; i++)
+        parseItem(self, &chunks[0].items[i]);
+    for (size_t i = 1; i < count; i++) {
+#ifndef _WIN32
+        if (chunks[i].started) continue;
+#endif
+        /* discard */ parseChunk(&chunks[i]);
+    }
+#ifndef _WIN32
+    for (size_t i = 1; i < count; i++)
+        if (chunks[i].started) pthread_join(chunks[i].thread, NULL);
+#endif
 
-    // Parse the RHS expression
-    const ExprId rhs = expression(self);
-    POISON(rhs);
-    LOG(". good rhs\n");
+    // Append the chunks in order, so everything comes out as `Parse()`
+    // would have made it
+    bool ok = true;
+    for (size_t i = 1; i < count; i++)
+        ok = ok && chunks[i].valid && takeChunk(self, &chunks[i]);
 
-    //
-    // Complete the expression
-    //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_LOGICAL,
-        .data = { .exprBinary = { lhs, rhs, op } }
-    };
+    for (size_t i = 1; i < count; i++) {
+        AstFree(&chunks[i].ast);
+        DiagnosticVecFree(&chunks[i].diags.diagnostics);
+    }
+    free(chunks);
+    ParseItemVecFree(&items);
 
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
+    *success = ok && self->diagEngine->diagnostics.count == diagCount;
 }
 
-// MARK: expr: logicalAnd()
-
-ExprId logicalAnd(Parser *self) {
-    LOG("logicalAnd()\n");
-    const Span startSpan = get(self, 0)->span;
-
-    const ExprId lhs = logicalOr(self);
-    POISON(lhs);
+// -------------------------------------------------------------------------- //
+// MARK: Incremental Parse
+// * An item only depends on its own tokens and the one after it (which ends
+// * it), and every item starts the splitter over at depth zero. So every item
+// * ending before the edit can be kept, parsing can restart at the first one
+// * that doesn't, and once an item boundary after the edit lines up with one
+// * of the old parse, the rest of the old parse is still right.
+// * The AST is edited in place. The gap of `items` is moved to the first item
+// * parsed again, and the old items are dropped from there as parsing passes
+// * them, so the new ones take their place. The items kept are never
+// * touched: the spans of their nodes are relative to the item, and moving
+// * them by the edit is done to the whole gap at once. The nodes of the old
+// * items are handed back if they were the last ones, and otherwise left dead
+// * until there are more dead nodes than live ones, then `AstCompact()`
+// * packs them, so that it costs no more than the edits that left them.
+// * The diagnostics are only shifted, with the old items' ones replaced. If
+// * memory runs out the AST is left half edited, and has to be parsed again.
+// -------------------------------------------------------------------------- //
 
-    //
-    // Look for the operator and return if it isn't there
-    //
-    if (get(self, 0)->kind != TK_AND_AND) {
-        return lhs;
+// Returns the first of the items `[lo, hi)` whose `first` token is at least
+// `token`, or `hi`.
+static size_t findItem(const Ast *ast, size_t lo, size_t hi, size_t token) {
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (AstItemAt(ast, mid).first < token) lo = mid + 1;
+        else hi = mid;
     }
-    const char *op = "&&";
-    next(self, 1);
-
-    LOG(". op: &&\n");
-
-    // Parse the RHS expression
-    const ExprId rhs = expression(self);
-    POISON(rhs);
-    LOG(". good rhs\n");
-
-    //
-    // Complete the expression
-    //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_LOGICAL,
-        .data = { .exprBinary = { lhs, rhs, op } }
-    };
+    return lo;
+}
 
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
+// Drops the old items after the gap that start before `token`, which can't
+// line up with the new ones any more. Returns how many diagnostics they had.
+static size_t dropItems(Ast *ast, size_t token) {
+    size_t diags = 0;
+    while (ast->itemGap < AstItemCount(ast)) {
+        const AstItem old = AstItemAt(ast, ast->itemGap);
+        if (old.first >= token)
+            break;
+        diags += old.diags;
+        AstDropItems(ast, 1);
+    }
+    return diags;
 }
 
-// MARK: expr: assignment()
+// Where the diagnostics of the items are, see `spliceDiagnostics()`.
+// - `head` the first of the kept items before the edit, and `old` the first
+// of the items parsed again.
+// - `oldCount` how many the old items had, and `end` where they all ended,
+// the new ones were pushed from there.
+typedef struct DiagSplice {
+    size_t head;
+    size_t old;
+    size_t oldCount;
+    size_t end;
+} DiagSplice;
+
+// Moves the diagnostics of the kept items by `edit`, and those of the items
+// parsed again in place of the old items' ones.
+static bool spliceDiagnostics(
+    DiagnosticVec *diags,
+    const DiagSplice *at,
+    const TokenEdit *edit
+) {
+    const size_t tail = at->old + at->oldCount;
+    const size_t newCount = diags->count - at->end;
+    for (size_t i = at->head; edit->headDelta != 0 && i < at->old; i++) {
+        const Diagnostic diag = DiagShifted(
+            DiagnosticVecGet(diags, i), edit->headDelta);
+        // Silly workaround to avoid making Diagnostic members non-const.
+        memcpy(DiagnosticVecGet(diags, i), &diag, sizeof(Diagnostic));
+    }
+    for (size_t i = tail; i < at->end; i++) {
+        const Diagnostic diag = DiagShifted(
+            DiagnosticVecGet(diags, i), edit->tailDelta);
+        memcpy(DiagnosticVecGet(diags, i), &diag, sizeof(Diagnostic));
+    }
 
-ExprId assignment(Parser *self) {
-    LOG("assignment()\n");
-    const Span startSpan = get(self, 0)->span;
+    if (newCount == at->oldCount) {
+        if (newCount > 0)
+            memcpy(diags->data + at->old, diags->data + at->end,
+                newCount * sizeof(Diagnostic));
+        diags->count = at->end;
+        return true;
+    }
 
-    const ExprId assignee = logicalAnd(self);
-    POISON(assignee);
+    const size_t tailCount = at->end - tail;
+    const size_t restCount = newCount + tailCount;
+    Diagnostic *rest = malloc((restCount + 1) * sizeof(Diagnostic));
+    if (!rest)
+        return false;
+    memcpy(rest, diags->data + at->end, newCount * sizeof(Diagnostic));
+    memcpy(rest + newCount, diags->data + tail,
+        tailCount * sizeof(Diagnostic));
+
+    diags->count = at->old;
+    const bool ok = DiagnosticVecExtend(diags, rest, restCount) != LIST_RES_ERR;
+    free(rest);
+    return ok;
+}
 
-    //
-    // Look for a binary infix operator BEFORE the RHS is parsed
-    //
-    const char *op;
-    switch (get(self, 0)->kind) {
-    case TK_EQ:
-        LOG(". op: =\n");
-        op = "=";
-        break;
-    case TK_PLUS_EQ:
-        LOG(". op: +=\n");
-        op = "+=";
-        break;
-    case TK_MIN_EQ:
-        LOG(". op: -=\n");
-        op = "-=";
-        break;
-    case TK_STAR_EQ:
-        LOG(". op: *=\n");
-        op = "*=";
-        break;
-    case TK_SLASH_EQ:
-        LOG(". op: /=\n");
-        op = "/=";
-        break;
-    default:
-        return assignee;
+void ParseEdit(Parser *self, const TokenEdit *edit, bool *success) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
     }
 
-    next(self, 1);
+    if (!ParserIsValid(self) || !self->tokenList || !edit) {
+        *success = false;
+        return;
+    }
 
-    // Parse the value expression
-    const ExprId value = expression(self);
-    POISON(value);
-    LOG(". good value\n");
+    const TokenList *tokens = self->tokenList;
+    Ast *ast = self->ast;
+    DiagnosticVec *diags = &self->diagEngine->diagnostics;
+    const size_t count = AstItemCount(ast);
 
     //
-    // Complete the expression
+    // Keep every item that ends before the edit, and restart at the first
+    // that doesn't. Items are back to back, so that's the one before the
+    // first starting at or after the edit (or the last one). Its first token
+    // is before the edit, so it didn't move.
     //
-    const Span endSpan = getBack(self, 1)->span;
-    const Expression expr = {
-        .span = SpanMerge(&startSpan, &endSpan),
-        .kind = EXPR_ASSIGN,
-        .data = { .exprBinary = { assignee, value, op } }
+    size_t keep = findItem(ast, 0, count, edit->first);
+    if (keep > 0 && AstItemAt(ast, keep - 1).end >= edit->first)
+        keep--;
+
+    const AstItem last = count > 0 ? AstItemAt(ast, count - 1) : (AstItem) {0};
+    const AstItem restart = keep < count ? AstItemAt(ast, keep) : (AstItem) {
+        .first = last.end, .diag = last.diag + last.diags };
+    DiagSplice at = {
+        .head = diags->count - last.diag - last.diags,
+        .end  = diags->count,
     };
+    at.old = at.head + restart.diag;
 
-    // Advance and return
-    // next(self, 1);
-    return AstExprPush(self->ast, &expr);
-}
-
-ExprId expression(Parser *self) { return assignment(self); }
+    // The old items from there on wait past the gap, and those after the
+    // edit move to the new tokens
+    AstSeekItem(ast, keep);
+    at.oldCount = dropItems(ast, edit->first + edit->removed);
+    AstMoveItems(ast, edit->inserted - edit->removed, 0, edit->headDelta,
+        edit->tailDelta);
 
-// -------------------------------------------------------------------------- //
-// MARK: Parser API
-// -------------------------------------------------------------------------- //
-
-Parser ParserNew(
-    const Source *src,
-    Ast *ast,
-    DiagEngine *diagEngine,
-    const TokenList *tokenList
-) {
-    if (!src
-        || !ast
-        || !diagEngine
-        || !tokenList
-        || tokenList->tokens.count == 0
-    ) {
-        return (Parser) {0};
+    //
+    // Parse items until one starts where an old one did, past the edit
+    //
+    const size_t editEnd = edit->first + edit->inserted;
+    size_t first = restart.first;
+    bool resynced = false;
+    ItemSplit split = {0};
+    size_t i = first;
+    for (; i < tokens->count && TLKind(tokens, i) != TK_EOF; i++) {
+        if (!ItemSplitStep(&split, TLKind(tokens, i)) || i == first)
+            continue;
+
+        at.oldCount += dropItems(ast, i);
+        parseItem(self, &(ParseItem) { first, i });
+        first = i;
+        if (i >= editEnd && ast->itemGap < AstItemCount(ast)
+            && AstItemAt(ast, ast->itemGap).first == i)
+        {
+            resynced = true;
+            break;
+        }
+    }
+    if (!resynced) {
+        at.oldCount += dropItems(ast, SIZE_MAX);
+        if (first < i)
+            parseItem(self, &(ParseItem) { first, i });
     }
 
-    return (Parser) {
-        .src = src,
-        .diagEngine = diagEngine,
-        .tokenList = tokenList,
-        .ast = ast,
-        .cursor = 0,
-    };
-}
-
-bool ParserIsValid(const Parser *self) {
-    return (self
-        && self->ast
-        && self->diagEngine
-        && self->tokenList
-        && ListIsValid(&self->tokenList->tokens)
-        && ListIsValid(&self->diagEngine->diagnostics)
-        && AstIsValid(self->ast)
-    );
-}
-
-void Parse(Parser *self, bool *success) {
-    ExprId expr = expression(self);
-    if (expr != NULL_AST_ID) {
-        *success = false;
-        return;
+    // The items after the new ones have their diagnostics moved along
+    const size_t newCount = diags->count - at.end;
+    AstMoveItems(ast, 0, newCount - at.oldCount, 0, 0);
+    if (ast->deadExprs * 2 > ast->exprs.count
+        || ast->deadArgs * 2 > ast->args.count)
+    {
+        /* discard */ AstCompact(ast);
     }
 
-    *success = true;
+    const bool ok = spliceDiagnostics(diags, &at, edit);
+    *success = ok && diags->count == at.head;
 }
@@ -2,24 +2,151 @@
 #define PARSER_H
 
 #include "ast.h"
+#include "expr.h"
 #include "../common/source.h"
 #include "../common/diag.h"
+#include "../common/vec.h"
 #include "../scanning/token.h"
 #include <stdbool.h>
 
 #define LOG_PARSER
 
+// -------------------------------------------------------------------------- //
+// MARK: Expression Stacks
+// * Expressions are parsed with explicit stacks of operands and pending
+// * operators (shunting-yard) rather than a recursive call per level, so how
+// * deeply they nest is only bounded by memory, never by the C stack.
+// -------------------------------------------------------------------------- //
+
+// An expression waiting for the operators around it, with the span of its
+// first token (a `(` for a parenthesized one) that those operators start at.
+typedef struct ParseOperand {
+    ExprId id;
+    Span start;
+} ParseOperand;
+
+typedef enum ParseFrameKind {
+    FRAME_PREFIX,
+    FRAME_BINARY,
+    FRAME_GROUP,
+    FRAME_CALL,
+} ParseFrameKind;
+
+// Something opened but not yet complete: an operator waiting for its right
+// operand, a `(` waiting for its `)`, or a call waiting for its arguments.
+// - `right` the binding power the right operand of an operator is parsed
+//   with, operators only take expressions that bind tighter than it.
+// - `start` where the expression it completes starts.
+// - `callee` and `argc` for calls, as in `ExprCall`, `argBase` where their
+//   arguments start on the parser's scratch stack, and `argStart`, `label`
+//   (interned) and `hasLabel` for the argument being parsed.
+typedef struct ParseFrame {
+    ParseFrameKind kind;
+    ExprKind exprKind;
+    uint8_t right;
+    const char *op;
+    Span start;
+
+    ExprId callee;
+    size_t argBase;
+    size_t argc;
+    Span argStart;
+    SymbolId label;
+    bool hasLabel;
+} ParseFrame;
+
+DEFINE_VEC(ParseOperand)
+DEFINE_VEC(ParseFrame)
+
+// -------------------------------------------------------------------------- //
+// MARK: Scratch Lists
+// * A list's items are collected on a scratch stack while it is parsed, and
+// * only copied into the `Ast` in one block once it is complete. Items of the
+// * lists nested inside it are pushed and copied out above them first, so
+// * every list ends up contiguous however its items nest.
+// -------------------------------------------------------------------------- //
+
+DEFINE_VEC(Argument)
+
+// -------------------------------------------------------------------------- //
+// MARK: Top-Level Items
+// * A file is a run of top-level items. An item ends after a `;` outside of
+// * any brackets, or just before a `fun`, `type`, `enum` or `let` outside of
+// * any brackets, so items can be found from token kinds alone, without
+// * parsing, and parsed independently of each other.
+// -------------------------------------------------------------------------- //
+
+// Splits a token stream into items a token at a time.
+// - `depth` the number of brackets open.
+// - `open` whether the current item has tokens and wasn't ended by a `;`.
+typedef struct ItemSplit {
+    size_t depth;
+    bool open;
+} ItemSplit;
+
+// Returns whether a token of `kind` starts a new item, and steps past it.
+// The first token of the stream starts one, `TK_EOF` never does.
+static inline bool ItemSplitStep(ItemSplit *self, TokenKind kind) {
+    if (kind == TK_EOF)
+        return false;
+
+    const bool starts = !self->open || (self->depth == 0
+        && (kind == TK_FUN || kind == TK_TYPE || kind == TK_ENUM
+            || kind == TK_LET));
+
+    switch (kind) {
+    case TK_LPAR: case TK_LCURL: case TK_LBRAC:
+        self->depth++;
+        break;
+    case TK_RPAR: case TK_RCURL: case RK_RBRAC:
+        if (self->depth > 0) self->depth--;
+        break;
+    default:
+        break;
+    }
+    self->open = kind != TK_SEMICOLON || self->depth > 0;
+    return starts;
+}
+
+// A top-level item, the tokens `[first, end)` of a token list.
+typedef struct ParseItem {
+    size_t first;
+    size_t end;
+} ParseItem;
+
+DEFINE_VEC(ParseItem)
+
+// Appends the items of `tokens` to `items`, the last one ending at the
+// `TK_EOF` token. Only reads the kinds. Returns `false` if `items` could not
+// grow.
+bool ParseFindItems(const TokenList *tokens, ParseItemVec *items);
+
 // -------------------------------------------------------------------------- //
 // MARK: Parser
 // -------------------------------------------------------------------------- //
 
+// How far the parser looks ahead of (`get(self, 1)`) and behind
+// (`getBack(self, 1)`) its cursor. A parser pulling from a `TokenSource`
+// only keeps this many tokens, rounded up to a power of two.
+#define PARSER_LOOKAHEAD  2
+#define PARSER_LOOKBEHIND 1
+#define PARSER_WINDOW     4
+
 // Used to traverse the token list and create an AST for the `src` fie.
 typedef struct Parser {
     // The translaton unit.
     const Source *src;
 
-    // The input stream of tokens.
+    // The input stream of tokens, either a whole list or a source that is
+    // pulled from into `window` as the cursor moves (`NULL` list).
     const TokenList *tokenList;
+    TokenSource tokens;
+    Token window[PARSER_WINDOW];
+
+    // How many tokens have been pulled from `tokens`, and whether the last
+    // was `TK_EOF`.
+    size_t pulled;
+    bool pulledEnd;
 
     // A pointer to the diagnostic collection.
     DiagEngine   *diagEngine;
@@ -29,26 +156,77 @@ typedef struct Parser {
 
     // Points to where the parser is in the token stream.
     size_t cursor;
+
+    // The item being parsed starts at `itemStart` and ends at `itemEnd`,
+    // tokens from there on read as `TK_EOF`. A pulled stream is split into
+    // items as it's pulled, with `split`, and `itemEnd` is `SIZE_MAX` until
+    // the next item's first token is pulled.
+    size_t itemStart;
+    size_t itemEnd;
+    ItemSplit split;
+
+    // The offset of the item's first token, which the spans of its nodes are
+    // relative to. Zero outside of items.
+    uint32_t itemBase;
+
+    // The expression stacks, reused from one expression to the next.
+    ParseOperandVec operands;
+    ParseFrameVec   frames;
+
+    // The arguments of the calls still open, innermost call's last.
+    ArgumentVec argScratch;
 } Parser;
 
 // Creates a new parser for the translation unit and token list.
 Parser ParserNew(const Source *src, Ast *ast, DiagEngine *diagEngine,
     const TokenList *tokenList);
 
-// Parses the entire token stream and attempts to construct an AST. Will
-// modify the `success` pointer if there were errors during this process.
+// Creates a new parser that pulls tokens from `tokens` as it needs them, so
+// that scanning and parsing interleave and only `PARSER_WINDOW` tokens are
+// held at a time.
+Parser ParserNewFromSource(const Source *src, Ast *ast, DiagEngine *diagEngine,
+    TokenSource tokens);
+
+// Parses the entire token stream, an item at a time, into the AST and adds
+// each item to its `root`. `*success` is whether there were no errors.
 void Parse(Parser *self, bool *success);
 
+// Parses just `item` of the token list, which must end before the list
+// does (at the `TK_EOF` token at the latest), as `Parse()` would have.
+// `*success` is whether there were no errors.
+void ParseItemOf(Parser *self, const ParseItem *item, bool *success);
+
+// The fewest tokens worth a thread of their own in `ParseParallel()`.
+#define PARSE_MIN_CHUNK ((size_t)64 << 10)
+
+// Parses like `Parse()`, with the items cut into up to `threads` chunks (or
+// one per CPU for `0`) of at least `minChunk` tokens (or `PARSE_MIN_CHUNK`
+// for `0`) that are parsed concurrently, each into an AST of its own that
+// is then appended to this one. The AST and diagnostics come out the same
+// as `Parse()` would make them, node ids and symbol ids included. Only
+// parsers over a whole token list can be split, others just `Parse()`.
+void ParseParallel(Parser *self, size_t threads, size_t minChunk,
+    bool *success);
+
+// Updates `self->ast`, parsed from `self->tokenList` before `edit` was
+// applied to it, in place, parsing again only the items the edit reaches.
+// `self->diagEngine` must end with the diagnostics reported parsing the AST.
+// `*success` is whether there are no errors in any item now.
+void ParseEdit(Parser *self, const TokenEdit *edit, bool *success);
+
 // Returns whether or not the data being used in the parser is valid or not.
 bool ParserIsValid(const Parser *self);
 
+// Frees the parser's expression and scratch stacks. The AST and diagnostics
+// it wrote to are left alone.
+void ParserFree(Parser *self);
+
 // -------------------------------------------------------------------------- //
 // MARK: Testing Interface
 // -------------------------------------------------------------------------- //
 
 #ifdef M2L_TEST_IMPL
 ExprId expression(Parser *self);
-ExprId call(Parser *self);
 #endif
 
 #endif
@@ -46,8 +46,9 @@ void AstPrintArgument(AstPrinter *self, const Argument *arg) {
 
     if (arg->hasLabel) {
         SPACES(self->indent);
+        const Substring label = InternerGet(&self->ast->symbols, arg->label);
         printf("'");
-        SubstringPrint(stdout, &arg->label);
+        SubstringPrint(stdout, &label);
         printf("' (\n");
         indent(self);
     }
@@ -61,6 +62,21 @@ void AstPrintArgument(AstPrinter *self, const Argument *arg) {
     }
 }
 
+void AstPrintItem(AstPrinter *self, size_t index) {
+    if (!self || !AstPrinterIsValid(self)) {
+        printf("<invalid AstPrinter pointer>\n");
+        return;
+    }
+    if (index >= AstItemCount(self->ast)) {
+        fprintf(stderr, "<AstPrintItem(): %zu is out of bounds>\n", index);
+        return;
+    }
+
+    self->item = AstItemAt(self->ast, index);
+    if (self->item.root != NULL_AST_ID)
+        AstPrintExpr(self, self->item.root);
+}
+
 void AstPrintExpr(AstPrinter *self, ExprId id) {
     SPACES(self->indent);
     if (!self || !AstPrinterIsValid(self)) {
@@ -86,14 +102,18 @@ void AstPrintExpr(AstPrinter *self, ExprId id) {
         return;
     }
     case EXPR_SYMBOL: {
+        const Substring symbol = InternerGet(
+            &self->ast->symbols, expr->data.exprSymbol);
         printf("symbol(");
-        SubstringPrint(stdout, &expr->data.exprSymbol);
+        SubstringPrint(stdout, &symbol);
         printf(")\n");
         return;
     }
     case EXPR_STR: {
+        const Substring string = ExprStringGet(
+            self->ast, &self->item, &expr->data.exprString);
         printf("string(");
-        SubstringPrint(stdout, &expr->data.exprString);
+        SubstringPrint(stdout, &string);
         printf(")\n");
         return;
     }
@@ -214,7 +234,7 @@ void AstPrintExpr(AstPrinter *self, ExprId id) {
         indent(self);
         for (size_t i = 0; i < expr->data.exprCall.argc; i++) {
             size_t argIndex = expr->data.exprCall.argid + i;
-            Argument *arg = ListGet(&self->ast->args, argIndex);
+            Argument *arg = ArgumentSegListGet(&self->ast->args, argIndex);
             AstPrintArgument(self, arg);
         }
 
@@ -17,6 +17,9 @@ typedef struct AstPrinter {
     // The AST to print.
     const Ast *ast;
 
+    // The item being printed, which the spans of its nodes are relative to.
+    AstItem item;
+
     // The current indent level of the printer.
     size_t indent;
 } AstPrinter;
@@ -27,7 +30,10 @@ AstPrinter AstPrinterNew(const Source *src, const Ast *ast);
 // Returns whether or not the data inside the printer is valid.
 bool AstPrinterIsValid(const AstPrinter *self);
 
-// Print an expression.
+// Print the expression of item `index`, if it has one.
+void AstPrintItem(AstPrinter *self, size_t index);
+
+// Print an expression of the item being printed.
 void AstPrintExpr(AstPrinter *self, ExprId id);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef LITERAL_H
+#define LITERAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: Numeric Literals
+// * Decoded straight from the source bytes, underscores and all, without
+// * copying or allocating, so that the scanner can store a literal's value
+// * with its token and nothing downstream has to parse it again.
+// -------------------------------------------------------------------------- //
+
+// Why a literal could not be decoded, `LITERAL_OK` if it could.
+typedef enum LiteralError {
+    LITERAL_OK = 0,
+    LITERAL_NO_DIGITS,
+    LITERAL_BAD_DIGIT,
+    LITERAL_OVERFLOW,
+} LiteralError;
+
+// Returns a message for the scanner's diagnostic about `self`.
+const char *LiteralErrorMessage(LiteralError self);
+
+// Decodes an integer literal: decimal `[0-9][0-9_]*`, or `0x`/`0X` hex and
+// `0b`/`0B` binary with `_` anywhere after the prefix. Decimal literals must
+// fit an `int64_t`, hex and binary ones may use all 64 bits (as a bit
+// pattern). `*out` is only written on success.
+LiteralError LiteralDecodeInt(const char *text, size_t length, int64_t *out);
+
+// Decodes a float literal `[0-9][0-9_]*.[0-9][0-9_]*` to the nearest double,
+// ties to even. Short literals take an exact double multiply or divide,
+// the rest Eisel–Lemire, and the rare case that Eisel–Lemire can't settle
+// goes to `strtod()` on a copy in a stack buffer. `*out` is only written
+// on success.
+LiteralError LiteralDecodeFloat(const char *text, size_t length, double *out);
+
+// -------------------------------------------------------------------------- //
+// MARK: String Literals
+// * Escapes are `\n`, `\t`, `\r`, `\0`, `\\`, `\"`, `\'` and `\xHH`. The
+// * scanner only checks them, strings without any are used straight from the
+// * source, and the rest are decoded by `LiteralDecodeString()` when parsed.
+// -------------------------------------------------------------------------- //
+
+// Returns the length of the escape sequence at `text` (which starts with
+// `\`), or zero if it isn't a valid one. Reads at most `length` bytes.
+size_t LiteralEscapeLength(const char *text, size_t length);
+
+// Decodes the escapes in the `length` bytes of a string's contents (without
+// its quotes) into `out`, and returns the decoded length. `out` needs room
+// for `length` bytes, decoding never makes a string longer. An invalid
+// escape (already reported by the scanner) is kept as it is.
+size_t LiteralDecodeString(const char *text, size_t length, char *out);
+
+#endif
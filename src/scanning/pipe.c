@@ -0,0 +1,149 @@
+#define _DEFAULT_SOURCE
+#include "pipe.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+// Lets the other side of the pipe run, which matters most when both share
+// a core.
+static inline void waitTurn() {
+#ifndef _WIN32
+    sched_yield();
+#endif
+}
+
+static inline Token *slot(const TokenPipe *self, size_t index) {
+    return &self->ring[index & (self->capacity - 1)];
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Producer
+// -------------------------------------------------------------------------- //
+
+static inline void publish(TokenPipe *self) {
+    atomic_store_explicit(&self->tail, self->written, memory_order_release);
+}
+
+static void *produce(void *arg) {
+    TokenPipe *self = arg;
+
+    while (!atomic_load_explicit(&self->closed, memory_order_relaxed)) {
+        // Full as far as we know, publish everything before waiting for room
+        if (self->written - self->headSeen == self->capacity) {
+            publish(self);
+            self->headSeen =
+                atomic_load_explicit(&self->head, memory_order_acquire);
+            if (self->written - self->headSeen == self->capacity)
+                waitTurn();
+            continue;
+        }
+
+        Token *token = slot(self, self->written);
+        self->producer.pull(self->producer.ctx, token);
+        self->written++;
+        if (token->kind == TK_EOF)
+            break;
+        if (self->written % TOKEN_PIPE_BATCH == 0)
+            publish(self);
+    }
+
+    publish(self);
+    return NULL;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Consumer
+// -------------------------------------------------------------------------- //
+
+static void consume(void *ctx, Token *out) {
+    TokenPipe *self = ctx;
+
+    // Out of tokens as far as we know, release every slot before waiting
+    if (self->read == self->tailSeen) {
+        atomic_store_explicit(&self->head, self->read, memory_order_release);
+        while (true) {
+            self->tailSeen =
+                atomic_load_explicit(&self->tail, memory_order_acquire);
+            if (self->tailSeen != self->read) break;
+            waitTurn();
+        }
+    }
+
+    const Token *token = slot(self, self->read);
+    // Silly workaround to avoid making Token members non-const.
+    memcpy(out, token, sizeof(Token));
+
+    // `TK_EOF` is the last token, so it stays in its slot for every later pull
+    if (token->kind == TK_EOF)
+        return;
+
+    self->read++;
+    if (self->read % TOKEN_PIPE_BATCH == 0)
+        atomic_store_explicit(&self->head, self->read, memory_order_release);
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: TokenPipe API
+// -------------------------------------------------------------------------- //
+
+TokenPipe TokenPipeNew(size_t capacity) {
+    if (capacity == 0) capacity = TOKEN_PIPE_CAPACITY;
+    size_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+
+    Token *ring = malloc(rounded * sizeof(Token));
+    if (!ring) {
+        fprintf(stderr, "<TokenPipeNew(): could not allocate the ring>\n");
+        return (TokenPipe) {0};
+    }
+
+    return (TokenPipe) {
+        .ring     = ring,
+        .capacity = rounded,
+    };
+}
+
+bool TokenPipeIsValid(const TokenPipe *self) {
+    return self && self->ring && self->capacity > 0;
+}
+
+bool TokenPipeStart(TokenPipe *self, TokenSource producer) {
+    if (!TokenPipeIsValid(self) || self->started
+        || !TokenSourceIsValid(&producer))
+    {
+        return false;
+    }
+
+    self->producer = producer;
+#ifdef _WIN32
+    return false;
+#else
+    self->started = pthread_create(&self->thread, NULL, produce, self) == 0;
+    return self->started;
+#endif
+}
+
+TokenSource TokenPipeSource(TokenPipe *self) {
+    if (!TokenPipeIsValid(self) || !self->started)
+        return (TokenSource) {0};
+    return (TokenSource) { .pull = consume, .ctx = self };
+}
+
+void TokenPipeFree(TokenPipe *self) {
+    if (!TokenPipeIsValid(self))
+        return;
+
+#ifndef _WIN32
+    if (self->started) {
+        atomic_store_explicit(&self->closed, true, memory_order_relaxed);
+        pthread_join(self->thread, NULL);
+    }
+#endif
+
+    free(self->ring);
+    *self = (TokenPipe) {0}; // poison this pipe
+}
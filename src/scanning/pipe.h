@@ -0,0 +1,67 @@
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "token.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// -------------------------------------------------------------------------- //
+// MARK: TokenPipe
+// * A single producer, single consumer ring of tokens. A thread pulls tokens
+// * from one `TokenSource` (the scanner) into the ring, and the pipe is itself
+// * a `TokenSource` that another thread (the parser) pulls from. Each side
+// * only publishes its position every `TOKEN_PIPE_BATCH` tokens, or when it
+// * is about to wait, so the two threads rarely touch the same cache line.
+// -------------------------------------------------------------------------- //
+
+#define TOKEN_PIPE_CAPACITY 8192
+#define TOKEN_PIPE_BATCH    256
+
+typedef struct TokenPipe {
+    Token *ring;
+    size_t capacity;
+    TokenSource producer;
+
+    // Producer side, `tail` is how many tokens the consumer may read.
+    _Alignas(64) _Atomic size_t tail;
+    size_t written;
+    size_t headSeen;
+
+    // Consumer side, `head` is how many slots the producer may reuse.
+    _Alignas(64) _Atomic size_t head;
+    size_t read;
+    size_t tailSeen;
+
+    // Set when the consumer is done, so a producer waiting for room quits.
+    _Atomic bool closed;
+    bool started;
+#ifndef _WIN32
+    pthread_t thread;
+#endif
+} TokenPipe;
+
+// Creates a pipe holding up to `capacity` tokens (rounded up to a power of
+// two), or `TOKEN_PIPE_CAPACITY` for `0`.
+TokenPipe TokenPipeNew(size_t capacity);
+
+bool TokenPipeIsValid(const TokenPipe *self);
+
+// Starts pulling from `producer` on a new thread. `self` must not move until
+// `TokenPipeFree()`, and `producer` must not touch anything the consumer
+// uses (e.g. an arena or a diagnostic engine). Returns `false` if no thread
+// could be started, in which case the caller should use `producer` itself.
+bool TokenPipeStart(TokenPipe *self, TokenSource producer);
+
+// Returns the consuming end of the pipe.
+TokenSource TokenPipeSource(TokenPipe *self);
+
+// Stops the producer if it hasn't reached `TK_EOF` yet, waits for it, and
+// frees the ring.
+void TokenPipeFree(TokenPipe *self);
+
+#endif
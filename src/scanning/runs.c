@@ -0,0 +1,231 @@
+#include "runs.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__GNUC__) || defined(__clang__))
+#define RUNS_X86
+#include <immintrin.h>
+#endif
+
+// -------------------------------------------------------------------------- //
+// MARK: Scalar
+// -------------------------------------------------------------------------- //
+
+static inline bool isSpace(unsigned char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+static inline bool isDigitRun(unsigned char ch) {
+    return (unsigned char)(ch - '0') < 10 || ch == '_';
+}
+
+static inline bool isSymbolRun(unsigned char ch) {
+    return (unsigned char)((ch | 0x20) - 'a') < 26 || isDigitRun(ch);
+}
+
+static inline bool isStringRun(unsigned char ch) {
+    return ch != '"' && ch != '\\';
+}
+
+static size_t scalarWhitespace(const char *data, size_t length) {
+    size_t i = 0;
+    while (i < length && isSpace((unsigned char)data[i])) i++;
+    return i;
+}
+
+static size_t scalarSymbol(const char *data, size_t length) {
+    size_t i = 0;
+    while (i < length && isSymbolRun((unsigned char)data[i])) i++;
+    return i;
+}
+
+static size_t scalarDigits(const char *data, size_t length) {
+    size_t i = 0;
+    while (i < length && isDigitRun((unsigned char)data[i])) i++;
+    return i;
+}
+
+static size_t scalarString(const char *data, size_t length) {
+    size_t i = 0;
+    while (i < length && isStringRun((unsigned char)data[i])) i++;
+    return i;
+}
+
+static const RunKernels scalarKernels = {
+    .whitespace = scalarWhitespace,
+    .symbol     = scalarSymbol,
+    .digits     = scalarDigits,
+    .string     = scalarString,
+    .name       = "scalar",
+};
+
+#ifdef RUNS_X86
+
+// -------------------------------------------------------------------------- //
+// MARK: SSE2
+// * Each kernel builds a mask of the bytes that are in the run, then the
+// * first zero bit of the mask is where the run ends. Unsigned range checks
+// * use `min`/`max` since SSE2 only has signed byte compares.
+// -------------------------------------------------------------------------- //
+
+// Lanes of `x` in `[lo, hi]`.
+static inline __m128i inRange16(__m128i x, char lo, char hi) {
+    __m128i aboveLo = _mm_cmpeq_epi8(_mm_max_epu8(x, _mm_set1_epi8(lo)), x);
+    __m128i belowHi = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(hi)), x);
+    return _mm_and_si128(aboveLo, belowHi);
+}
+
+static inline __m128i spaceMask16(__m128i x) {
+    return _mm_or_si128(
+        _mm_or_si128(
+            _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+            _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'))),
+        _mm_cmpeq_epi8(x, _mm_set1_epi8('\r')));
+}
+
+static inline __m128i digitMask16(__m128i x) {
+    return _mm_or_si128(
+        inRange16(x, '0', '9'),
+        _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+}
+
+static inline __m128i symbolMask16(__m128i x) {
+    __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    return _mm_or_si128(inRange16(lower, 'a', 'z'), digitMask16(x));
+}
+
+static inline __m128i stringMask16(__m128i x) {
+    __m128i stop = _mm_or_si128(
+        _mm_cmpeq_epi8(x, _mm_set1_epi8('"')),
+        _mm_cmpeq_epi8(x, _mm_set1_epi8('\\')));
+    return _mm_xor_si128(stop, _mm_set1_epi8(-1));
+}
+
+// Expands to a kernel that scans 16 bytes at a time with `MASK`, and hands
+// the tail (less than a vector) to the scalar kernel.
+#define DEFINE_SSE2_KERNEL(name, MASK, scalar)                                 \
+    static size_t name(const char *data, size_t length) {                      \
+        size_t i = 0;                                                          \
+        for (; i + 16 <= length; i += 16) {                                    \
+            __m128i x = _mm_loadu_si128((const __m128i *)(data + i));          \
+            unsigned mask = (unsigned)_mm_movemask_epi8(MASK(x));              \
+            if (mask != 0xFFFF)                                                \
+                return i + (size_t)__builtin_ctz(~mask);                       \
+        }                                                                      \
+        return i + scalar(data + i, length - i);                               \
+    }
+
+DEFINE_SSE2_KERNEL(sse2Whitespace, spaceMask16, scalarWhitespace)
+DEFINE_SSE2_KERNEL(sse2Symbol, symbolMask16, scalarSymbol)
+DEFINE_SSE2_KERNEL(sse2Digits, digitMask16, scalarDigits)
+DEFINE_SSE2_KERNEL(sse2String, stringMask16, scalarString)
+
+static const RunKernels sse2Kernels = {
+    .whitespace = sse2Whitespace,
+    .symbol     = sse2Symbol,
+    .digits     = sse2Digits,
+    .string     = sse2String,
+    .name       = "sse2",
+};
+
+// -------------------------------------------------------------------------- //
+// MARK: AVX2
+// * Same as SSE2, 32 bytes at a time. Compiled for AVX2 with a `target`
+// * attribute, so the rest of the build doesn't need `-mavx2`.
+// -------------------------------------------------------------------------- //
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i inRange32(__m256i x, char lo, char hi) {
+    __m256i aboveLo = _mm256_cmpeq_epi8(
+        _mm256_max_epu8(x, _mm256_set1_epi8(lo)), x);
+    __m256i belowHi = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(x, _mm256_set1_epi8(hi)), x);
+    return _mm256_and_si256(aboveLo, belowHi);
+}
+
+AVX2 static inline __m256i spaceMask32(__m256i x) {
+    return _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+            _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t'))),
+        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r')));
+}
+
+AVX2 static inline __m256i digitMask32(__m256i x) {
+    return _mm256_or_si256(
+        inRange32(x, '0', '9'),
+        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+}
+
+AVX2 static inline __m256i symbolMask32(__m256i x) {
+    __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(inRange32(lower, 'a', 'z'), digitMask32(x));
+}
+
+AVX2 static inline __m256i stringMask32(__m256i x) {
+    __m256i stop = _mm256_or_si256(
+        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')),
+        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\')));
+    return _mm256_xor_si256(stop, _mm256_set1_epi8(-1));
+}
+
+// The tail goes to the SSE2 kernel, which finishes with the scalar one.
+#define DEFINE_AVX2_KERNEL(name, MASK, tail)                                   \
+    AVX2 static size_t name(const char *data, size_t length) {                 \
+        size_t i = 0;                                                          \
+        for (; i + 32 <= length; i += 32) {                                    \
+            __m256i x = _mm256_loadu_si256((const __m256i *)(data + i));       \
+            uint32_t mask = (uint32_t)_mm256_movemask_epi8(MASK(x));           \
+            if (mask != 0xFFFFFFFFu)                                           \
+                return i + (size_t)__builtin_ctz(~mask);                       \
+        }                                                                      \
+        return i + tail(data + i, length - i);                                 \
+    }
+
+DEFINE_AVX2_KERNEL(avx2Whitespace, spaceMask32, sse2Whitespace)
+DEFINE_AVX2_KERNEL(avx2Symbol, symbolMask32, sse2Symbol)
+DEFINE_AVX2_KERNEL(avx2Digits, digitMask32, sse2Digits)
+DEFINE_AVX2_KERNEL(avx2String, stringMask32, sse2String)
+
+static const RunKernels avx2Kernels = {
+    .whitespace = avx2Whitespace,
+    .symbol     = avx2Symbol,
+    .digits     = avx2Digits,
+    .string     = avx2String,
+    .name       = "avx2",
+};
+
+#endif
+
+// -------------------------------------------------------------------------- //
+// MARK: Dispatch
+// -------------------------------------------------------------------------- //
+
+static _Atomic(const RunKernels *) selected = NULL;
+
+static const RunKernels *selectKernels() {
+#ifdef RUNS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &avx2Kernels;
+    if (__builtin_cpu_supports("sse2")) return &sse2Kernels;
+#endif
+    return &scalarKernels;
+}
+
+const RunKernels *RunKernelsGet() {
+    // Racing first calls all store the same pointer
+    const RunKernels *kernels =
+        atomic_load_explicit(&selected, memory_order_relaxed);
+    if (!kernels) {
+        kernels = selectKernels();
+        atomic_store_explicit(&selected, kernels, memory_order_relaxed);
+    }
+    return kernels;
+}
+
+const RunKernels *RunKernelsScalar() {
+    return &scalarKernels;
+}
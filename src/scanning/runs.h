@@ -0,0 +1,37 @@
+#ifndef RUNS_H
+#define RUNS_H
+
+#include <stddef.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: Run Kernels
+// -------------------------------------------------------------------------- //
+
+// Returns how many of the first `length` bytes of `data` belong to a run,
+// i.e. the index of the first byte that doesn't (or `length`). Never reads
+// past `length`.
+typedef size_t (*RunFn)(const char *data, size_t length);
+
+// The scanner's hot loops, classifying 16 (SSE2) or 32 (AVX2) bytes at a
+// time where the CPU allows it.
+// - `whitespace` runs of `' '`, `'\t'` and `'\r'`.
+// - `symbol` runs of `[A-Za-z0-9_]`.
+// - `digits` runs of `[0-9_]`.
+// - `string` runs of anything but `"` and `\`, the body of a string.
+// - `name` which implementation this is, for logging and tests.
+typedef struct RunKernels {
+    RunFn whitespace;
+    RunFn symbol;
+    RunFn digits;
+    RunFn string;
+    const char *name;
+} RunKernels;
+
+// Returns the fastest kernels this CPU supports. Selected on the first call
+// (with CPUID on x86), every call after that is a load.
+const RunKernels *RunKernelsGet();
+
+// Returns the portable byte at a time kernels.
+const RunKernels *RunKernelsScalar();
+
+#endif
@@ -1,9 +1,21 @@
+#define _DEFAULT_SOURCE
 #include "scanner.h"
 #include "../common/list.h"
 #include "../common/diag.h"
+#include "../common/hash.h"
+#include "literal.h"
 #include "token.h"
-#include <ctype.h>
+#include "unicode.h"
+#include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #ifdef LOG_LEXER
 #define LOG(fmt, ...) fprintf(stderr, fmt __VA_OPT__(,) __VA_ARGS__)
@@ -15,36 +27,134 @@
 // MARK: Helpers
 // -------------------------------------------------------------------------- //
 
-static bool isSymbolStart(char ch) {
-    return isalpha(ch) || ch == '_';
-}
+// -------------------------------------------------------------------------- //
+// MARK: Character Classes
+// * Classification is a single table load instead of a (locale sensitive)
+// * `<ctype.h>` call. Bytes outside of ASCII have no class, symbols past
+// * ASCII are decoded and looked up in the Unicode tables instead.
+// -------------------------------------------------------------------------- //
+
+typedef enum CharClass {
+    CC_SPACE        = 1 << 0, // ' ', '\t', '\r'
+    CC_SYMBOL_START = 1 << 1, // [A-Za-z_]
+    CC_SYMBOL       = 1 << 2, // [A-Za-z0-9_]
+    CC_DIGIT        = 1 << 3, // [0-9]
+    CC_DIGIT_START  = 1 << 4, // [0-9_]
+    CC_DIGIT_FOLLOW = 1 << 5, // [0-9_.]
+} CharClass;
 
-static bool isSymbolFollow(char ch) {
-    return isalnum(ch) || ch == '_';
+#define __ 0
+#define SP CC_SPACE
+#define AL (CC_SYMBOL_START | CC_SYMBOL)
+#define US (CC_SYMBOL_START | CC_SYMBOL | CC_DIGIT_START | CC_DIGIT_FOLLOW)
+#define DG (CC_SYMBOL | CC_DIGIT | CC_DIGIT_START | CC_DIGIT_FOLLOW)
+#define DT CC_DIGIT_FOLLOW
+
+static const uint8_t charClass[256] = {
+    /* 0_ */ __, __, __, __, __, __, __, __, __, SP, __, __, __, SP, __, __,
+    /* 1_ */ __, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __,
+    /* 2_ */ SP, __, __, __, __, __, __, __, __, __, __, __, __, __, DT, __,
+    /* 3_ */ DG, DG, DG, DG, DG, DG, DG, DG, DG, DG, __, __, __, __, __, __,
+    /* 4_ */ __, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    /* 5_ */ AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, __, __, __, __, US,
+    /* 6_ */ __, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    /* 7_ */ AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, __, __, __, __, __,
+};
+
+#undef __
+#undef SP
+#undef AL
+#undef US
+#undef DG
+#undef DT
+
+// Tokens that are always exactly one character. Stored as `kind + 1` so that
+// zero can mean "not a single character token".
+static const uint8_t singleKind[256] = {
+    ['('] = TK_LPAR + 1,
+    [')'] = TK_RPAR + 1,
+    ['['] = TK_LBRAC + 1,
+    [']'] = RK_RBRAC + 1,
+    ['{'] = TK_LCURL + 1,
+    ['}'] = TK_RCURL + 1,
+    ['.'] = TK_DOT + 1,
+    [','] = TK_COMMA + 1,
+    [':'] = TK_COLON + 1,
+    [';'] = TK_SEMICOLON + 1,
+    ['?'] = TK_QMARK + 1,
+};
+
+static inline bool isClass(unsigned char ch, CharClass cls) {
+    return (charClass[ch] & cls) != 0;
 }
 
-static bool isDigitStart(char ch) { 
-    return isdigit(ch) || ch == '_';
+// -------------------------------------------------------------------------- //
+// MARK: Keywords
+// * A perfect hash over `KEYWORD_LIST`. The table is built from the keyword
+// * text on first use, so the hash can never disagree with the spelling, and
+// * two keywords landing in the same slot trip an assert.
+// -------------------------------------------------------------------------- //
+
+#define KEYWORD_TABLE_SIZE 32
+#define KEYWORD_MIN_LENGTH 2
+#define KEYWORD_MAX_LENGTH 5
+
+#define KEYWORD_HASH(c0, c1, len)                                              \
+    (((unsigned)(c0) + (unsigned)(c1) * 9u + (unsigned)(len))                  \
+        & (KEYWORD_TABLE_SIZE - 1))
+
+typedef struct Keyword {
+    const char *text;
+    size_t length;
+    TokenKind kind;
+} Keyword;
+
+static Keyword keywords[KEYWORD_TABLE_SIZE];
+
+static void buildKeywords() {
+    static const Keyword list[] = {
+        #define X(kind, text) { text, sizeof(text) - 1, kind },
+        KEYWORD_LIST
+        #undef X
+    };
+
+    for (size_t i = 0; i < sizeof(list) / sizeof(list[0]); i++) {
+        const Keyword *kw = &list[i];
+        assert(kw->length >= KEYWORD_MIN_LENGTH);
+        assert(kw->length <= KEYWORD_MAX_LENGTH);
+
+        Keyword *slot = &keywords[KEYWORD_HASH(
+            (unsigned char)kw->text[0], (unsigned char)kw->text[1],
+            kw->length)];
+        assert(!slot->text && "two keywords share a hash slot");
+        *slot = *kw;
+    }
 }
 
-static bool isDigitFollow(char ch) {
-    return isdigit(ch) || ch == '_' || ch == '.';
+// Scanners may be made on several threads at once (see `ScanParallel()`), the
+// table is built exactly once. Scanning is single threaded without pthreads.
+static void initKeywords() {
+#ifdef _WIN32
+    static bool built = false;
+    if (!built) buildKeywords();
+    built = true;
+#else
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    /* discard */ pthread_once(&once, buildKeywords);
+#endif
 }
 
-static TokenKind cmpKeywords(const Scanner *self, const Span *span) {
-    Substring str = SpanSubstring(span);
-    // Purposefully skip the null check, the `SubstringCmpString()` will do it.
-    if (SubstringCmpString(&str, "true"))     return TK_TRUE;
-    if (SubstringCmpString(&str, "false"))    return TK_FALSE;
-    if (SubstringCmpString(&str, "let"))      return TK_LET;
-    if (SubstringCmpString(&str, "mut"))      return TK_MUT;
-    if (SubstringCmpString(&str, "fun"))      return TK_FUN;
-    if (SubstringCmpString(&str, "type"))     return TK_TYPE;
-    if (SubstringCmpString(&str, "if"))       return TK_IF;
-    if (SubstringCmpString(&str, "else"))     return TK_ELSE;
-    if (SubstringCmpString(&str, "for"))      return TK_FOR;
-    if (SubstringCmpString(&str, "in"))       return TK_IN;
-    if (SubstringCmpString(&str, "while"))    return TK_WHILE;
+// Returns the keyword kind of an identifier, or `TK_SYMBOL`. One hash and at
+// most one compare.
+static TokenKind cmpKeywords(const Scanner *self, size_t offset, size_t len) {
+    if (len < KEYWORD_MIN_LENGTH || len > KEYWORD_MAX_LENGTH)
+        return TK_SYMBOL;
+
+    const char *str = self->src->data + offset;
+    const Keyword *kw = &keywords[KEYWORD_HASH(
+        (unsigned char)str[0], (unsigned char)str[1], len)];
+    if (kw->length == len && memcmp(kw->text, str, len) == 0)
+        return kw->kind;
     return TK_SYMBOL;
 }
 
@@ -52,14 +162,31 @@ static TokenKind cmpKeywords(const Scanner *self, const Span *span) {
 // MARK: Scanner Helpers
 // -------------------------------------------------------------------------- //
 
-static unsigned char current(const Scanner *self) {
-    if (self->offset >= self->src->length)
+// Returns whether `offset` is past the data. When the data is only part of
+// the input (a streamed window or a parallel chunk), running off its end is
+// noted in `hitEnd`, and the token is rescanned once more data is in view.
+static inline bool pastEnd(Scanner *self, size_t offset) {
+    if (offset < self->src->length)
+        return false;
+    if (self->partial)
+        self->hitEnd = true;
+    return true;
+}
+
+// End of input is decided by the source length alone, the data is not
+// required to be null terminated (and may contain `'\0'` bytes).
+static bool isAtEnd(Scanner *self) {
+    return pastEnd(self, self->offset);
+}
+
+static unsigned char current(Scanner *self) {
+    if (pastEnd(self, self->offset))
         return '\0';
     return self->src->data[self->offset];
 }
 
-static unsigned char peek(const Scanner *self) {
-    if (self->offset + 1 >= self->src->length)
+static unsigned char peek(Scanner *self) {
+    if (pastEnd(self, self->offset + 1))
         return '\0';
     return self->src->data[self->offset + 1];
 }
@@ -69,7 +196,14 @@ static void next(Scanner *self) {
     if (self->offset >= self->src->length)
         return;
     self->offset++;
-    self->x++;
+}
+
+// Makes a span from an offset local to the source.
+static inline Span makeSpan(const Scanner *self, size_t offset, size_t length) {
+    return (Span) {
+        .offset = (uint32_t)(self->src->base + offset),
+        .length = (uint32_t)length,
+    };
 }
 
 static bool expect(Scanner *self, unsigned char ch) {
@@ -79,13 +213,29 @@ static bool expect(Scanner *self, unsigned char ch) {
     return true;
 }
 
+// Moves onto the last byte of the `run` that follows the current byte, so
+// `peek()` then sees the first byte after it. Most runs in real code are a
+// byte or two, so the first byte is checked against `cls` inline before
+// handing the rest to the kernel. Bytes past the data are left to `peek()`,
+// which notes the end of a streamed window.
+static inline void skipRun(Scanner *self, RunFn run, CharClass cls) {
+    const char *data = self->src->data;
+    size_t length = self->src->length;
+    size_t from = self->offset + 1;
+    if (from >= length || !isClass(data[from], cls))
+        return;
+
+    from++;
+    self->offset = from + run(data + from, length - from) - 1;
+}
+
 static void skipWhitespace(Scanner *self) {
     LOG("CALL INTO SKIP WS\n");
-    char ch = current(self);
-    while (ch == ' ' || ch == '\t' || ch == '\r') {
-        next(self);
-        ch = current(self);
-    }
+    if (!isClass(current(self), CC_SPACE))
+        return;
+
+    skipRun(self, self->runs->whitespace, CC_SPACE);
+    next(self);
 }
 
 // -------------------------------------------------------------------------- //
@@ -95,132 +245,301 @@ static void skipWhitespace(Scanner *self) {
 // * prior to calling any other methods.
 // -------------------------------------------------------------------------- //
 
-// assumes current -> '\n'
-static void scanEol(Scanner *self) {  
-    self->y++;
-    self->x = 0;
+// Emits an invalid character diagnostic for the `length` bytes at `offset`
+// (a whole code point past ASCII) and skips them.
+static void scanInvalid(Scanner *self, size_t offset, size_t length) {
+    const DiagReport report = (DiagReport) {
+        .span = makeSpan(self, offset, length),
+        .message = ""
+    };
+    const Diagnostic diag = DiagNew(
+        ERR_INVALID_CHAR,
+        "this character is not recogonized",
+        report
+    );
+
+    // Push the diagnostic and then early return
+    self->success = false;
+    DEPush(self->diagEngine, &diag);
+    self->offset = offset + length;
 }
 
-// Strings include the quotes in the span
-static void scanString(Scanner *self) {
-    size_t offset = self->offset;
-    size_t x = self->x;
-    size_t y = self->y;
+// Reports a string that starts at `offset` but never ends, and moves to the
+// end of the data.
+static void scanUnterminated(Scanner *self, size_t offset) {
+    const Span span = makeSpan(self, offset, 1);
+    Diagnostic diag = DIAG(
+        ERR_INVALID_STRING,
+        span, "",
+        "this string literal is missing a closing `\"`"
+    );
 
-    // Advance once at the beginning
+    // Push the diagnostic and then early return
+    self->success = false;
+    DEPush(self->diagEngine, &diag);
+    self->offset = self->src->length;
+}
+
+// Pushes the string from `offset` to the closing quote under the cursor,
+// and moves past it.
+static void pushString(Scanner *self, size_t offset, TokenStrFlags flags) {
+    const size_t length = self->offset - offset + 1;
+    const Span span     = makeSpan(self, offset, length);
+    const Token token   = (Token) { TK_STR, span, { (uint32_t)flags } };
+    TLPush(self->tokenList, &token);
+
+    // Advance to point to the next token
     next(self);
+}
 
-    while (current(self) != '"') {
-        // If EOF reached, emit an error
-        if (current(self) == '\0') {
-            Span span = (Span) {self->src, offset, 1, x, y};
-            Diagnostic diag = DIAG(
-                ERR_INVALID_STRING,
-                span, "",
-                "this string literal is missing a closing `\"`"
-            );
-
-            // Push the diagnostic and then early return
-            self->success = false;
-            DEPush(self->diagEngine, &diag);
-            next(self);
+// Strings include the quotes in the span. The body is skipped a vector at a
+// time up to the next `"` or `\`, so only escapes are looked at on their
+// own. They're checked here, but only decoded by the parser.
+static void scanString(Scanner *self) {
+    const size_t offset = self->offset;
+    const char  *data   = self->src->data;
+    const size_t length = self->src->length;
+
+    TokenStrFlags flags = 0;
+    size_t badEscape = SIZE_MAX;
+    size_t at = offset + 1;
+    for (;;) {
+        if (at < length)
+            at += self->runs->string(data + at, length - at);
+        if (pastEnd(self, at)) {
+            scanUnterminated(self, offset);
             return;
         }
+        if (data[at] == '"')
+            break;
 
-        // Otherwise keep consuming
-        next(self);
+        // An escape, a bad one is skipped like `\n` so a quote after it
+        // still ends the string
+        flags |= TOKEN_STR_ESCAPED;
+        size_t escape = LiteralEscapeLength(data + at, length - at);
+        if (escape == 0) {
+            if (badEscape == SIZE_MAX) badEscape = at;
+            escape = 2;
+        }
+        at += escape;
     }
 
-    // Get a span
-    size_t length   = self->offset - offset + 1;
-    const Span span = (Span) {self->src, offset, length, x, y};
+    self->offset = at;
+    pushString(self, offset, flags);
 
-    // Create the token and push
-    const Token token = (Token) { TK_STR, span };
+    // The token comes first, then what's wrong with it
+    if (badEscape != SIZE_MAX) {
+        const Span span = makeSpan(self, badEscape, 2);
+        Diagnostic diag = DIAG(
+            ERR_INVALID_STRING,
+            span, "",
+            "this escape sequence is not recognized"
+        );
+        self->success = false;
+        DEPush(self->diagEngine, &diag);
+    }
+}
+
+// Raw strings `r"..."` have no escapes, they end at the first `"`.
+static void scanRawString(Scanner *self) {
+    const size_t offset = self->offset;
+    const char  *data   = self->src->data;
+    const size_t length = self->src->length;
+
+    const size_t body = offset + 2;
+    const char *quote = body < length
+        ? memchr(data + body, '"', length - body)
+        : NULL;
+    if (!quote) {
+        /* discard */ pastEnd(self, length);
+        scanUnterminated(self, offset);
+        return;
+    }
+
+    self->offset = (size_t)(quote - data);
+    pushString(self, offset, TOKEN_STR_RAW);
+}
+
+// Comments run from `#` to the end of the line (`//` is floor division).
+// Skipped without a token, the newline is left for the next call.
+static void skipComment(Scanner *self) {
+    const char  *data   = self->src->data;
+    const size_t length = self->src->length;
+
+    const char *newline = memchr(data + self->offset, '\n',
+        length - self->offset);
+    if (!newline) {
+        // The comment may go on past a streamed window
+        /* discard */ pastEnd(self, length);
+        self->offset = length;
+        return;
+    }
+    self->offset = (size_t)(newline - data);
+}
+
+// Pushes the number at `offset` with its decoded value. One that can't be
+// decoded still becomes a token (with a zero value), followed by a
+// diagnostic, so the parser carries on as usual.
+static void pushNumber(
+    Scanner *self,
+    TokenKind kind,
+    size_t offset,
+    size_t length
+) {
+    const char *text = self->src->data + offset;
+    TokenValue value = {0};
+    const LiteralError error = kind == TK_INT
+        ? LiteralDecodeInt(text, length, &value.i)
+        : LiteralDecodeFloat(text, length, &value.f);
+
+    const Span span   = makeSpan(self, offset, length);
+    const Token token = (Token) { .kind = kind, .span = span, .value = value };
     TLPush(self->tokenList, &token);
 
-    // Advance to point to the next token
-    next(self);
+    if (error != LITERAL_OK) {
+        const Diagnostic diag = DiagNew(
+            ERR_INVALID_NUMBER,
+            LiteralErrorMessage(error),
+            (DiagReport) { span, "" }
+        );
+        self->success = false;
+        DEPush(self->diagEngine, &diag);
+    }
 }
 
 static void scanDigit(Scanner *self) {
     size_t offset = self->offset;
-    size_t x = self->x;
-    size_t y = self->y;
     TokenKind kind = TK_INT;
 
-    while (isDigitFollow(peek(self))) {
+    // Hex and binary integers take every letter and digit after the prefix,
+    // so a digit out of base is reported rather than split off
+    const unsigned char prefix = peek(self) | 0x20;
+    if (current(self) == '0' && (prefix == 'x' || prefix == 'b')) {
+        next(self);
+        skipRun(self, self->runs->symbol, CC_SYMBOL);
+        /* discard */ peek(self);
+        pushNumber(self, TK_INT, offset, self->offset - offset + 1);
+        next(self);
+        return;
+    }
+
+    skipRun(self, self->runs->digits, CC_DIGIT_START);
+    while (isClass(peek(self), CC_DIGIT_FOLLOW)) {
         next(self);
 
         // If the current thing is '.', make sure it's actually a part of this
         // token before consuming it.
-        if (current(self) == '.' && kind == TK_INT && isdigit(peek(self))) {
+        if (
+            current(self) == '.'
+            && kind == TK_INT
+            && isClass(peek(self), CC_DIGIT))
+        {
             kind = TK_FLOAT;
             next(self);
+            skipRun(self, self->runs->digits, CC_DIGIT_START);
             continue;
 
         // Otherwise, emit a separate DOT token
         } else if (
             current(self) == '.'
-            && (kind == TK_FLOAT || !isdigit(peek(self))))
+            && (kind == TK_FLOAT || !isClass(peek(self), CC_DIGIT)))
         {
             // First emit the digit token
-            size_t length          = self->offset - offset;
-            const Span span        = (Span) {self->src, offset, length, x, y};
-
-            // Create the token and push
-            const Token token = (Token) { kind, span };
-            TLPush(self->tokenList, &token);
+            pushNumber(self, kind, offset, self->offset - offset);
 
             // Then emit the DOT token
-            const Span span2   = (Span) {self->src, self->offset, 1, x, y};
-            const Token token2 = (Token) { TK_DOT, span2 };
+            const Span span2   = makeSpan(self, self->offset, 1);
+            const Token token2 = (Token) { TK_DOT, span2, { 0 } };
             TLPush(self->tokenList, &token2);
 
             // Then advance once for the next iteration
             next(self);
             return;
         }
-    }
 
-    // Here, the next item is NOT part of the symbol
-    // First get a span and check the substring
-    size_t length   = self->offset - offset + 1;
-    const Span span = (Span) {self->src, offset, length, x, y};
+        skipRun(self, self->runs->digits, CC_DIGIT_START);
+    }
 
-    // Create the token and push
-    const Token token = (Token) { kind, span };
-    TLPush(self->tokenList, &token);
+    // Here, the next item is NOT part of the number
+    pushNumber(self, kind, offset, self->offset - offset + 1);
 
     // Advance to point to the next token
     next(self);
 }
 
-static void scanSymbol(Scanner *self) {
-    size_t offset = self->offset;
-    size_t x = self->x;
-    size_t y = self->y;
-    
-    while (isSymbolFollow(peek(self))) {
-        next(self);
+// Returns the length of the code point at `at` if it can start (`start`) or
+// continue a symbol, zero otherwise. Only bytes past ASCII get here. A code
+// point cut off by the end of a streamed window notes it in `hitEnd`.
+static size_t xidLength(Scanner *self, size_t at, bool start) {
+    const char *data = self->src->data;
+    const size_t need = Utf8Length((unsigned char)data[at]);
+    if (need == 0 || pastEnd(self, at + need - 1))
+        return 0;
+
+    uint32_t cp = 0;
+    if (Utf8Decode(data + at, need, &cp) == 0)
+        return 0;
+
+    const bool xid = start
+        ? UnicodeIsXidStart(cp)
+        : UnicodeIsXidContinue(cp);
+    return xid ? need : 0;
+}
+
+// Scans the symbol that starts at `offset`. The cursor is on the last byte
+// of its first code point, which is `offset` itself unless it's past ASCII.
+static void scanSymbol(Scanner *self, size_t offset) {
+    // The rest of the symbol. The kernel takes the ASCII runs and stops on
+    // any byte past ASCII, so only those code points are looked up. `peek()`
+    // catches the end of a streamed window.
+    skipRun(self, self->runs->symbol, CC_SYMBOL);
+    while (peek(self) & 0x80) {
+        const size_t more = xidLength(self, self->offset + 1, false);
+        if (more == 0)
+            break;
+        self->offset += more;
+        skipRun(self, self->runs->symbol, CC_SYMBOL);
     }
 
     // Here, the next item is NOT part of the symbol
     // First get a span and check the substring
-    size_t length   = self->offset - offset + 1;
-    const Span span = (Span) {self->src, offset, length, x, y};
+    size_t length = self->offset - offset + 1;
 
     // Check if the substring is a keyword
-    const TokenKind kind = cmpKeywords(self, &span);
+    const TokenKind kind = cmpKeywords(self, offset, length);
+
+    // Hash symbols here, while the bytes are hot, so that interning them
+    // later is a table probe and a single compare.
+    const uint32_t hash = kind == TK_SYMBOL
+        ? HashFold32(HashBytes(self->src->data + offset, length))
+        : 0;
 
     // Create the token and push
-    const Token token = (Token) { kind, span };
+    const Span span   = makeSpan(self, offset, length);
+    const Token token = (Token) { kind, span, { hash } };
     TLPush(self->tokenList, &token);
 
     // Advance to point to the next token
     next(self);
 }
 
+// Scans a token that starts past ASCII, which can only be a symbol.
+static void scanUnicode(Scanner *self) {
+    const size_t offset = self->offset;
+    const size_t length = xidLength(self, offset, true);
+    if (length == 0) {
+        // Skip a whole code point if it is one, a single byte otherwise
+        uint32_t cp = 0;
+        const size_t bad = Utf8Decode(
+            self->src->data + offset, self->src->length - offset, &cp);
+        scanInvalid(self, offset, bad ? bad : 1);
+        return;
+    }
+
+    self->offset += length - 1;
+    scanSymbol(self, offset);
+}
+
 // Scans a single token if there is one and emits it. If no valid token is
 // found, then a diagnostic is emitted.
 //
@@ -232,21 +551,23 @@ static void scanToken(Scanner *self) {
     skipWhitespace(self);
 
     size_t offset = self->offset;
-    size_t x = self->x;
-    size_t y = self->y;
     size_t length = 1;
     
     unsigned char ch = current(self);
     LOG("START: '%c'\n", ch);
 
-    // Look for symbols
-    if (isSymbolStart(ch)) {
-        scanSymbol(self);
+    // Look for raw strings, then symbols
+    if (ch == 'r' && peek(self) == '"') {
+        scanRawString(self);
+        return;
+    }
+    if (isClass(ch, CC_SYMBOL_START)) {
+        scanSymbol(self, offset);
         return;
     }
 
     // Look for digits
-    if (isDigitStart(ch)) {
+    if (isClass(ch, CC_DIGIT_START)) {
         scanDigit(self);
         return;
     }
@@ -258,12 +579,18 @@ static void scanToken(Scanner *self) {
     // Meta
     //
     case '\0': {
+        // A stray null byte in the middle of the file is just an invalid
+        // character, only the end of the source is EOF.
+        if (!isAtEnd(self)) {
+            scanInvalid(self, offset, 1);
+            return;
+        }
         kind = TK_EOF;
         self->scanning = false;
         break;
     }
     case '\n': {
-        scanEol(self);
+        // Lines are recovered from the source's line index when needed
         next(self);
         return scanToken(self);
     }
@@ -271,16 +598,10 @@ static void scanToken(Scanner *self) {
         scanString(self);
         return;
     }
-
-    //
-    // Grouping
-    // 
-    case '(': { kind = TK_LPAR;  break; }
-    case ')': { kind = TK_RPAR;  break; }
-    case '[': { kind = TK_LBRAC; break; }
-    case ']': { kind = RK_RBRAC; break; }
-    case '{': { kind = TK_LCURL; break; }
-    case '}': { kind = TK_RCURL; break; }
+    case '#': {
+        skipComment(self);
+        return;
+    }
 
     //
     // Arithmetic
@@ -420,44 +741,27 @@ static void scanToken(Scanner *self) {
     }
 
     //
-    // Misc
-    //
-    case '.': { kind = TK_DOT;       break; }
-    case ',': { kind = TK_COMMA;     break; }
-    case ':': { kind = TK_COLON;     break; }
-    case ';': { kind = TK_SEMICOLON; break; }
-    case '?': { kind = TK_QMARK;     break; }
-    
-    //
-    // Invalid character
+    // Single character tokens (a table lookup), otherwise invalid
     //
     default: {
-        const DiagReport report = (DiagReport) {
-            .span = (Span) {self->src, offset, 1, x, y},
-            .message = ""
-        };
-        const Diagnostic diag = DiagNew(
-            ERR_INVALID_CHAR,
-            "this character is not recogonized",
-            report
-        );
-
-        // Push the diagnostic and then early return
-        self->success = false;
-        DEPush(self->diagEngine, &diag);
-        next(self);
+        if (singleKind[ch] != 0) {
+            kind = (TokenKind)(singleKind[ch] - 1);
+            break;
+        }
+        if (ch & 0x80) {
+            scanUnicode(self);
+            return;
+        }
+        scanInvalid(self, offset, 1);
         return;
     }
     }
 
-    const Span span   = (Span) {self->src, offset, length, x, y};
-    const Token token = (Token) { kind, span };
+    const Token token = (Token) { kind, makeSpan(self, offset, length), { 0 } };
 
-    // Consume the number of characters of the token
+    // `expect()` already consumed all but the last character of the token
     LOG("LENGTH: %zu\n", length);
-    for (size_t i = 0; i < length; i++) {
-        next(self);
-    }   
+    next(self);
 
     // Emit the token and return
     TLPush(self->tokenList, &token);
@@ -478,15 +782,19 @@ Scanner ScannerNew(
 ) {
     Scanner s = (Scanner) {
         .src        = src,
-        .x          = 1,
-        .y          = 1,
         .offset     = 0,
         .tokenList  = tokenList,
         .diagEngine = diagEngine,
+        .partial    = false,
+        .pulled     = 0,
+        .runs       = RunKernelsGet(),
         .scanning   = false,
+        .hitEnd     = false,
         .success    = true,
     };
 
+    initKeywords();
+
     if (ScannerIsValid(&s)) return s;
     else return (Scanner) {0};
 }
@@ -512,12 +820,622 @@ void Scan(Scanner *self, bool *success) {
     *self = (Scanner) {0}; // poison this scanner
 }
 
+// Scans tokens until one runs off the end of partial data. That token and
+// its diagnostics are forgotten, and its offset is returned so that it can
+// be scanned whole once more data is in view. Returns `SIZE_MAX` if the scan
+// reached the real end of the input instead.
+static size_t scanPartial(Scanner *self) {
+    self->scanning = true;
+    while (self->scanning) {
+        const size_t offset     = self->offset;
+        const size_t tokenCount = self->tokenList->count;
+        const size_t diagCount  = self->diagEngine->diagnostics.count;
+        const bool   wasSuccess = self->success;
+
+        self->hitEnd = false;
+        scanToken(self);
+        if (!self->hitEnd)
+            continue;
+
+        TLTruncate(self->tokenList, tokenCount);
+        self->diagEngine->diagnostics.count = diagCount;
+        self->success  = wasSuccess;
+        self->scanning = false;
+        return offset;
+    }
+    return SIZE_MAX;
+}
+
+// Pulls from a scanner, see `ScannerTokenSource()`.
+static void pullToken(void *ctx, Token *out) {
+    Scanner *self = ctx;
+    TokenList *tokens = self->tokenList;
+
+    if (self->pulled == tokens->count) {
+        // Past the end, hand out the `TK_EOF` token again
+        if (tokens->count > 0 && TLKind(tokens, tokens->count - 1) == TK_EOF) {
+            const Token token = TLGet(tokens, tokens->count - 1);
+            // Silly workaround to avoid making Token members non-const.
+            memcpy(out, &token, sizeof(Token));
+            return;
+        }
+
+        // Some calls emit nothing (bad characters), but EOF always comes
+        TLTruncate(tokens, 0);
+        self->pulled   = 0;
+        self->scanning = true;
+        while (tokens->count == 0)
+            scanToken(self);
+    }
+
+    const Token token = TLGet(tokens, self->pulled++);
+    // Silly workaround to avoid making Token members non-const.
+    memcpy(out, &token, sizeof(Token));
+}
+
+TokenSource ScannerTokenSource(Scanner *self) {
+    if (!ScannerIsValid(self))
+        return (TokenSource) {0};
+    return (TokenSource) { .pull = pullToken, .ctx = self };
+}
+
+// Hands the complete tokens and diagnostics to the sink, then drops them.
+static void flush(Scanner *self, ScanSink sink, void *ctx) {
+    if (sink) /* discard */ sink(ctx, self->tokenList, self->diagEngine);
+    TLTruncate(self->tokenList, 0);
+    DiagnosticVecClear(&self->diagEngine->diagnostics);
+}
+
+// Hands the complete tokens and diagnostics to the sink, then drops what it
+// is done with. Returns the local offset of the first byte still needed: of
+// the first token held over, or `offset` if none was.
+static size_t flushHeld(
+    Scanner *self,
+    ScanSink sink,
+    void *ctx,
+    size_t offset
+) {
+    TokenList *tokens = self->tokenList;
+    const size_t done = sink
+        ? sink(ctx, tokens, self->diagEngine)
+        : tokens->count;
+    if (done >= tokens->count) {
+        TLTruncate(tokens, 0);
+        DiagnosticVecClear(&self->diagEngine->diagnostics);
+        return offset;
+    }
+
+    // Everything held over moves down with the window
+    const uint32_t base = self->src->base;
+    const size_t keep = TLSpan(tokens, done).offset - base;
+    const uint32_t delta = (uint32_t)0 - (uint32_t)keep;
+    TLDropFront(tokens, done);
+    TLShiftOffsets(tokens, 0, tokens->count, delta);
+
+    DiagnosticVec *diags = &self->diagEngine->diagnostics;
+    size_t kept = 0;
+    for (size_t i = 0; i < diags->count; i++) {
+        const Diagnostic *diag = DiagnosticVecGet(diags, i);
+        if (diag->report.span.offset - base < keep)
+            continue;
+        const Diagnostic moved = DiagShifted(diag, delta);
+        // Silly workaround to avoid making Diagnostic members non-const.
+        memcpy(DiagnosticVecGet(diags, kept++), &moved, sizeof(moved));
+    }
+    diags->count = kept;
+    return keep;
+}
+
+void ScanStream(
+    Scanner *self,
+    SourceStream *stream,
+    ScanSink sink,
+    void *ctx,
+    bool *success
+) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
+    }
+
+    if (!ScannerIsValid(self) || !SourceStreamIsValid(stream)
+        || self->src != SourceStreamSource(stream))
+    {
+        *success = false;
+        return;
+    }
+
+    while (true) {
+        self->partial = !stream->eof;
+        const size_t offset = scanPartial(self);
+        if (offset == SIZE_MAX)
+            break;
+
+        //
+        // The token ran off the end of the window. Hand over everything
+        // before it while the window still holds their bytes, then slide the
+        // window up to the first byte the sink still needs, and scan the
+        // token again.
+        //
+        const size_t keep = flushHeld(self, sink, ctx, offset);
+        if (!SourceStreamFill(stream, keep)) {
+            self->success = false;
+            break;
+        }
+        self->offset = offset - keep;
+    }
+
+    flush(self, sink, ctx);
+    *success = self->success;
+    *self = (Scanner) {0}; // poison this scanner
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Parallel Scan
+// * The source is cut into chunks that each start after a newline, and every
+// * chunk is scanned on its own thread into private lists, as if no token
+// * crossed into it. Only strings can, so the chunks are then stitched
+// * together in order: where a token ran off the end of a chunk, scanning
+// * picks up from that token over the whole source, until it emits a token
+// * that a later chunk also found. The scanner only depends on the offset it
+// * starts from, so from that token on the chunk is right.
+// -------------------------------------------------------------------------- //
+
+typedef struct ScanChunk {
+    const Source *whole;
+    size_t start;
+    size_t end;
+    // Local offset of the token that ran off `end`, or `end` if none did.
+    size_t resume;
+    TokenList tokens;
+    DiagEngine diags;
+    bool valid;
+#ifndef _WIN32
+    pthread_t thread;
+    bool started;
+#endif
+} ScanChunk;
+
+static size_t cpuCount() {
+#ifdef _WIN32
+    return 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+static void *scanChunk(void *arg) {
+    ScanChunk *chunk = arg;
+
+    // The same data and base, so spans come out exactly as a whole scan's
+    const Source source = (Source) {
+        .data      = chunk->whole->data,
+        .path      = chunk->whole->path,
+        .length    = chunk->end,
+        .mapLength = 0,
+        .base      = chunk->whole->base,
+        .id        = chunk->whole->id,
+    };
+
+    Scanner scanner = ScannerNew(&source, &chunk->diags, &chunk->tokens);
+    if (!ScannerIsValid(&scanner))
+        return NULL;
+
+    scanner.offset  = chunk->start;
+    scanner.partial = chunk->end < chunk->whole->length;
+    const size_t resume = scanPartial(&scanner);
+    chunk->resume = resume == SIZE_MAX ? chunk->end : resume;
+    chunk->valid  = true;
+    return NULL;
+}
+
+// Returns the index of the chunk's token at local `offset`, or `SIZE_MAX`.
+static size_t findToken(const ScanChunk *chunk, size_t offset) {
+    const TokenList *tokens = &chunk->tokens;
+    const uint32_t target = (uint32_t)(chunk->whole->base + offset);
+    size_t lo = 0, hi = tokens->count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (TLSpan(tokens, mid).offset < target) lo = mid + 1;
+        else hi = mid;
+    }
+
+    if (lo < tokens->count && TLSpan(tokens, lo).offset == target)
+        return lo;
+    return SIZE_MAX;
+}
+
+// Appends the chunk's tokens from `first` on, and its diagnostics from local
+// `offset` on.
+static void takeChunk(
+    Scanner *self,
+    const ScanChunk *chunk,
+    size_t first,
+    size_t offset
+) {
+    TLExtend(self->tokenList, &chunk->tokens, first);
+
+    const DiagnosticVec *diags = &chunk->diags.diagnostics;
+    const uint32_t from = (uint32_t)(chunk->whole->base + offset);
+    size_t i = 0;
+    while (i < diags->count && diags->data[i].report.span.offset < from) i++;
+    if (i == diags->count)
+        return;
+
+    // The scanner fails exactly when it reports something
+    self->success = false;
+    /* discard */ DiagnosticVecExtend(
+        &self->diagEngine->diagnostics, diags->data + i, diags->count - i);
+}
+
+// Scans the whole source from `*offset` until a token lines up with one of a
+// chunk at or after `index`, and takes that chunk from there. Returns the
+// index of the next chunk to stitch, and updates `*offset` to its resume
+// point.
+static size_t rescan(
+    Scanner *self,
+    const ScanChunk *chunks,
+    size_t count,
+    size_t index,
+    size_t *offset
+) {
+    self->offset   = *offset;
+    self->scanning = true;
+    while (self->scanning) {
+        const size_t tokenCount = self->tokenList->count;
+        const size_t diagCount  = self->diagEngine->diagnostics.count;
+        const bool   wasSuccess = self->success;
+        scanToken(self);
+        if (self->tokenList->count == tokenCount)
+            continue;
+
+        // Chunks that lie wholly inside this token found nothing useful
+        const size_t at =
+            TLSpan(self->tokenList, tokenCount).offset - self->src->base;
+        while (index + 1 < count && chunks[index + 1].start <= at) index++;
+        if (at < chunks[index].start)
+            continue;
+
+        const size_t first = findToken(&chunks[index], at);
+        if (first == SIZE_MAX)
+            continue;
+
+        // Lined up, the chunk already has this token and everything after
+        TLTruncate(self->tokenList, tokenCount);
+        self->diagEngine->diagnostics.count = diagCount;
+        self->success = wasSuccess;
+        takeChunk(self, &chunks[index], first, at);
+        *offset = chunks[index].resume;
+        return index + 1;
+    }
+
+    // Reached the end of the input without lining up
+    return count;
+}
+
+void ScanParallel(
+    Scanner *self,
+    size_t threads,
+    size_t minChunk,
+    bool *success
+) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
+    }
+
+    if (!ScannerIsValid(self)) {
+        *success = false;
+        return;
+    }
+
+    const Source *src = self->src;
+    if (threads == 0) threads = cpuCount();
+    if (minChunk == 0) minChunk = SCAN_MIN_CHUNK;
+    size_t count = src->length / minChunk;
+    if (count > threads) count = threads;
+
+    ScanChunk *chunks = count > 1 ? calloc(count, sizeof(ScanChunk)) : NULL;
+    if (!chunks) {
+        Scan(self, success);
+        return;
+    }
+
+    //
+    // Cut the source into chunks of about the same size, each ending just
+    // after a newline. A line longer than a chunk swallows the next chunk.
+    //
+    size_t start = self->offset;
+    for (size_t i = 0; i < count; i++) {
+        size_t end = src->length;
+        const size_t target = start + (src->length - start) / (count - i);
+        const char *newline = i + 1 < count
+            ? memchr(src->data + target, '\n', src->length - target)
+            : NULL;
+        if (newline) end = (size_t)(newline - src->data) + 1;
+
+        chunks[i] = (ScanChunk) {
+            .whole  = src,
+            .start  = start,
+            .end    = end,
+            .tokens = TLNew(),
+            .diags  = DENew(),
+        };
+        start = end;
+        if (end == src->length) {
+            count = i + 1;
+            break;
+        }
+    }
+
+    // Chunk 0 is scanned here, the rest on their own threads when possible
+#ifndef _WIN32
+    for (size_t i = 1; i < count; i++)
+        chunks[i].started = pthread_create(
+            &chunks[i].thread, NULL, scanChunk, &chunks[i]) == 0;
+#endif
+    for (size_t i = 0; i < count; i++) {
+#ifndef _WIN32
+        if (chunks[i].started) continue;
+#endif
+        /* discard */ scanChunk(&chunks[i]);
+    }
+#ifndef _WIN32
+    for (size_t i = 1; i < count; i++)
+        if (chunks[i].started) pthread_join(chunks[i].thread, NULL);
+#endif
+
+    //
+    // Stitch the chunks together in order, so the tokens and diagnostics
+    // come out exactly as `Scan()` would have made them.
+    //
+    size_t offset = chunks[0].start;
+    for (size_t i = 0; i < count;) {
+        if (!chunks[i].valid) {
+            self->success = false;
+            break;
+        }
+
+        if (chunks[i].start == offset) {
+            takeChunk(self, &chunks[i], 0, offset);
+            offset = chunks[i].resume;
+            i++;
+        } else {
+            i = rescan(self, chunks, count, i, &offset);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        TLFree(&chunks[i].tokens);
+        DiagnosticVecFree(&chunks[i].diags.diagnostics);
+    }
+    free(chunks);
+
+    *success = self->success;
+    *self = (Scanner) {0}; // poison this scanner
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Incremental Scan
+// * A token only depends on its own bytes and the couple after it, and the
+// * scanner sits exactly at the end of a token after emitting it. So every
+// * token ending well before an edit can be kept, scanning can restart at
+// * the end of the last one, and once the new scan emits a token that the
+// * old scan also emitted after the edit (same bytes, same place), the rest
+// * of the old scan is still right.
+// -------------------------------------------------------------------------- //
+
+// Returns the first index in `list` for which `before` is false, `before`
+// being monotonic over the list.
+#define FIRST_INDEX(list, i, before, out)                                      \
+    do {                                                                       \
+        size_t lo_ = 0, hi_ = (list)->count;                                   \
+        while (lo_ < hi_) {                                                    \
+            const size_t i = lo_ + (hi_ - lo_) / 2;                            \
+            if (before) lo_ = i + 1;                                           \
+            else hi_ = i;                                                      \
+        }                                                                      \
+        (out) = lo_;                                                           \
+    } while (0)
+
+// Returns the offset just past token `i`.
+static inline uint32_t tokenEnd(const TokenList *tokens, size_t i) {
+    const Span span = TLSpan(tokens, i);
+    return span.offset + span.length;
+}
+
+// Moves diagnostics `first` up to `last` by `delta` (wrapping).
+static void shiftDiagnostics(
+    DiagnosticVec *diags,
+    size_t first,
+    size_t last,
+    uint32_t delta
+) {
+    for (size_t i = first; delta != 0 && i < last; i++) {
+        const Diagnostic moved = DiagShifted(DiagnosticVecGet(diags, i), delta);
+        // Silly workaround to avoid making Diagnostic members non-const.
+        memcpy(DiagnosticVecGet(diags, i), &moved, sizeof(moved));
+    }
+}
+
+// Replaces the diagnostics reported in old offsets `[from, to)` with
+// `fresh`, moving the ones before by `baseDelta` and after by `tailDelta`.
+// They are in scan order, so the replaced ones are found by binary search,
+// and only the ones after them are touched.
+static bool spliceDiagnostics(
+    DiagnosticVec *diags,
+    uint32_t from,
+    uint32_t to,
+    const DiagnosticVec *fresh,
+    uint32_t baseDelta,
+    uint32_t tailDelta
+) {
+    size_t first, last;
+    FIRST_INDEX(diags, i,
+        DiagnosticVecGet(diags, i)->report.span.offset < from, first);
+    FIRST_INDEX(diags, i,
+        DiagnosticVecGet(diags, i)->report.span.offset < to, last);
+
+    // Grow by as many as there are extra, they are overwritten below
+    const size_t removed = last - first;
+    const size_t tail    = diags->count - last;
+    if (fresh->count > removed && DiagnosticVecExtend(
+            diags, fresh->data, fresh->count - removed) == LIST_RES_ERR)
+        return false;
+
+    const size_t at = first + fresh->count;
+    memmove(diags->data + at, diags->data + last, tail * sizeof(Diagnostic));
+    memcpy(diags->data + first, fresh->data,
+        fresh->count * sizeof(Diagnostic));
+    diags->count = at + tail;
+
+    shiftDiagnostics(diags, 0, first, baseDelta);
+    shiftDiagnostics(diags, at, diags->count, tailDelta);
+    return true;
+}
+
+void ScanEdit(
+    Scanner *self,
+    const Source *old,
+    const TextEdit *edit,
+    TokenEdit *changed,
+    bool *success
+) {
+    // @(expect) assume `success` is not nul.
+    if (!success) {
+        printf("out pointer is NULL");
+        return;
+    }
+
+    TokenList *tokens = self ? self->tokenList : NULL;
+    if (!ScannerIsValid(self) || !SourceIsValid(old) || !edit
+        || tokens->count == 0
+        || TLKind(tokens, tokens->count - 1) != TK_EOF)
+    {
+        *success = false;
+        return;
+    }
+
+    // The edit must be exactly what turned `old` into the new source
+    const Source *src = self->src;
+    if (edit->offset + edit->deleted > old->length
+        || src->length + edit->deleted != old->length + edit->length
+        || (edit->length > 0 && (!edit->inserted || memcmp(
+            src->data + edit->offset, edit->inserted, edit->length) != 0)))
+    {
+        fprintf(stderr, "<ScanEdit(): edit does not match the sources>\n");
+        *success = false;
+        return;
+    }
+
+    //
+    // Keep every token that ends far enough before the edit, and restart
+    // where the last of them ends. Old tokens that start after the deleted
+    // bytes are the ones the new scan can line up with.
+    //
+    const uint32_t oldBase = old->base;
+    const size_t editStart = edit->offset;
+    const size_t editEnd   = edit->offset + edit->deleted;
+    size_t keep, after;
+    FIRST_INDEX(tokens, i,
+        tokenEnd(tokens, i) - oldBase + SCAN_EDIT_LOOKAHEAD <= editStart,
+        keep);
+    FIRST_INDEX(tokens, i, TLSpan(tokens, i).offset - oldBase < editEnd,
+        after);
+    const size_t restart = keep == 0 ? 0
+        : tokenEnd(tokens, keep - 1) - oldBase;
+
+    TokenList fresh = TLNew();
+    DiagEngine freshDiags = DENew();
+    if (!TLIsValid(&fresh) || !DiagnosticVecIsValid(&freshDiags.diagnostics)) {
+        TLFree(&fresh);
+        DiagnosticVecFree(&freshDiags.diagnostics);
+        *success = false;
+        return;
+    }
+
+    //
+    // Scan from the restart point until a token lines up with an old one
+    //
+    Scanner scanner = ScannerNew(src, &freshDiags, &fresh);
+    scanner.offset   = restart;
+    scanner.scanning = true;
+    size_t resync = tokens->count;
+    while (scanner.scanning) {
+        const size_t before = fresh.count;
+        const size_t diagsBefore = freshDiags.diagnostics.count;
+        scanToken(&scanner);
+        if (fresh.count == before)
+            continue;
+
+        // New offset `at` lines up with old offset `o` when the bytes after
+        // them are the same, i.e. `o + length == at + deleted`
+        const Span span = TLSpan(&fresh, before);
+        const size_t at = span.offset - src->base;
+        while (after < tokens->count && TLSpan(tokens, after).offset - oldBase
+            + edit->length < at + edit->deleted)
+        {
+            after++;
+        }
+        if (after < tokens->count
+            && TLSpan(tokens, after).offset - oldBase + edit->length
+                == at + edit->deleted
+            && TLKind(tokens, after) == TLKind(&fresh, before)
+            && TLSpan(tokens, after).length == span.length)
+        {
+            // The old scan has this token's diagnostics too
+            TLTruncate(&fresh, before);
+            freshDiags.diagnostics.count = diagsBefore;
+            resync = after;
+            break;
+        }
+    }
+
+    //
+    // Splice the new tokens in, and move the others to the new source
+    //
+    const uint32_t baseDelta = src->base - oldBase;
+    const uint32_t tailDelta = baseDelta
+        + (uint32_t)edit->length - (uint32_t)edit->deleted;
+    const uint32_t resyncOffset = resync < tokens->count
+        ? TLSpan(tokens, resync).offset
+        : oldBase + (uint32_t)old->length + 1;
+    bool ok = spliceDiagnostics(&self->diagEngine->diagnostics,
+        oldBase + (uint32_t)restart, resyncOffset, &freshDiags.diagnostics,
+        baseDelta, tailDelta);
+
+    ok = ok && TLSplice(tokens, keep, resync - keep, &fresh);
+    if (ok) {
+        TLShiftOffsets(tokens, 0, keep, baseDelta);
+        TLShiftOffsets(tokens, keep + fresh.count, tokens->count, tailDelta);
+    }
+    if (ok && changed) {
+        *changed = (TokenEdit) {
+            .first     = keep,
+            .removed   = resync - keep,
+            .inserted  = fresh.count,
+            .headDelta = baseDelta,
+            .tailDelta = tailDelta,
+        };
+    }
+
+    TLFree(&fresh);
+    DiagnosticVecFree(&freshDiags.diagnostics);
+
+    // The scanner fails exactly when it reports something
+    *success = ok && self->diagEngine->diagnostics.count == 0;
+    *self = (Scanner) {0}; // poison this scanner
+}
+
 bool ScannerIsValid(const Scanner *self) {
     return (!self
         || !self->src
         || !self->tokenList
         || !self->diagEngine
-        || !ListIsValid(&self->diagEngine->diagnostics)
-        || !ListIsValid(&self->tokenList->tokens)
+        || !DiagnosticVecIsValid(&self->diagEngine->diagnostics)
+        || !TLIsValid(self->tokenList)
     ) == false;
 }
\ No newline at end of file
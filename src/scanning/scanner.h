@@ -3,6 +3,8 @@
 
 #include "../common/source.h"
 #include "../common/diag.h"
+#include "../common/stream.h"
+#include "runs.h"
 #include "token.h"
 #include <stdbool.h>
 
@@ -10,15 +12,29 @@
 
 typedef struct Scanner {
     const Source *src;
-    size_t x;
-    size_t y;
     size_t offset;
     TokenList *tokenList;
     DiagEngine *diagEngine;
+    // The data ends before the input does (a window or a chunk)
+    bool partial;
+    // Tokens already handed out of `tokenList` by `ScannerTokenSource()`
+    size_t pulled;
+    const RunKernels *runs;
     bool scanning;
+    bool hitEnd;
     bool success;
 } Scanner;
 
+// Receives the tokens and diagnostics of one window of a streamed source,
+// and returns how many of the tokens, from the front, it is done with. The
+// rest are held over: they, the bytes from the first of them on, and the
+// diagnostics from there on stay in the window, and are passed again at the
+// front of the next call, so a sink can wait for tokens that belong
+// together. Return `tokens->count` to take everything. Spans are only valid
+// until the sink returns, and what the sink is done with is cleared
+// afterwards. The last call, at the end of the input, takes everything.
+typedef size_t (*ScanSink)(void *ctx, TokenList *tokens, DiagEngine *diags);
+
 Scanner ScannerNew(const Source *src, DiagEngine *diagEngine,
     TokenList *tokenList);
 
@@ -26,6 +42,58 @@ Scanner ScannerNew(const Source *src, DiagEngine *diagEngine,
 // the scanner fails if the `success` pointer is null.
 void Scan(Scanner *self, bool *success);
 
+// Scans a streamed source window by window, so memory stays bounded by the
+// window size no matter how large the input is. `self` must have been made
+// with `SourceStreamSource(stream)`. Tokens that straddle two windows are
+// rescanned whole from the next window. Everything scanned is passed to
+// `sink` as each window is retired, and once more at the end. The window
+// grows to hold whatever the sink holds over.
+void ScanStream(Scanner *self, SourceStream *stream, ScanSink sink,
+    void *ctx, bool *success);
+
+// Returns a source that scans one token each time it is pulled from, using
+// `self`'s token list as a queue of a token or two. Scanning then keeps pace
+// with the consumer, and token memory stays constant. `self` must outlive
+// the source, and the scan's success is left in `self->success`.
+TokenSource ScannerTokenSource(Scanner *self);
+
+// The smallest chunk worth a thread of its own in `ScanParallel()`.
+#define SCAN_MIN_CHUNK ((size_t)256 << 10)
+
+// Scans like `Scan()`, with the source split at newlines into up to
+// `threads` chunks (or one per CPU for `0`) of at least `minChunk` bytes (or
+// `SCAN_MIN_CHUNK` for `0`) that are scanned concurrently. The tokens and
+// diagnostics are the same, in the same order, as `Scan()` would produce.
+void ScanParallel(Scanner *self, size_t threads, size_t minChunk,
+    bool *success);
+
+// An edit to a source's text: the `deleted` bytes at `offset` were replaced
+// by the `length` bytes at `inserted`. Offsets are local to the source.
+typedef struct TextEdit {
+    size_t offset;
+    size_t deleted;
+    const char *inserted;
+    size_t length;
+} TextEdit;
+
+// How many bytes past the end of a token the scanner may look at to decide
+// it (`1.` followed by a non-digit, or a whole UTF-8 code point after a
+// symbol). Tokens closer than this to an edit are scanned again.
+#define SCAN_EDIT_LOOKAHEAD 4
+
+// Updates a scan of `old` to `self->src`, which is `old` with `edit` applied.
+// `self->tokenList` and `self->diagEngine` must hold a complete scan of
+// `old`. Scanning restarts just before the edit and stops as soon as a token
+// lines up with one that followed the edit before, then the new tokens and
+// diagnostics are spliced in and the rest are moved to the new source. Only
+// the edited region is scanned, the tokens around it are just shifted.
+// When the source was edited in place (see `SMReplaceBuffer()`), `old` is a
+// copy of it from before, the tokens before the edit don't move and the ones
+// after it move with a single add. What changed is written to `changed`,
+// unless it is `NULL`.
+void ScanEdit(Scanner *self, const Source *old, const TextEdit *edit,
+    TokenEdit *changed, bool *success);
+
 // Determines whether or not the scanner is valid, i.e. does it have a valid
 // source file, diag list, token list, etc.
 bool ScannerIsValid(const Scanner *self);
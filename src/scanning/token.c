@@ -1,5 +1,7 @@
 #include "token.h"
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 const char *TokenKindAsString(const TokenKind tk) {
     switch (tk) {
@@ -13,11 +15,14 @@ const char *TokenKindAsString(const TokenKind tk) {
 void TokenPrint(FILE *ioStream, const Token *self) {
     // format: FILE:Y:X KIND 'LEXEME'
     const char *kind = TokenKindAsString(self->kind);
+    const Source *src = SpanSource(&self->span);
+    size_t line = 0, col = 0;
+    /* discard */ SpanLineCol(&self->span, &line, &col);
     fprintf(ioStream,
         "[%s:%zu:%zu] %s '",
-        self->span.src->path,
-        self->span.y,
-        self->span.x,
+        src ? src->path : "<unknown>",
+        line,
+        col,
         kind
     );
 
@@ -38,39 +43,403 @@ void TokenPrint(FILE *ioStream, const Token *self) {
     fprintf(ioStream,"'\n");
 }
 
+// -------------------------------------------------------------------------- //
+// MARK: TokenList
+// -------------------------------------------------------------------------- //
+
+// Bytes taken by one token across the arrays.
+#define TOKEN_ROW_SIZE \
+    (sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t))
+
+// `valueFree` when there are no freed value slots.
+#define NO_FREE_VALUE SIZE_MAX
+
+// Allocates one array of `self` with room for `capacity` rows, and copies
+// the list's rows over from `data` (unless it is `NULL`), keeping the rows
+// past the gap at the back. Returns `NULL` on failure, leaving `data` intact.
+static void *growArray(
+    const TokenList *self,
+    const void *data,
+    size_t size,
+    size_t capacity
+) {
+    void *grown = VecAlloc(capacity, size, self->arena, ARENA_TAG_TOKENS,
+        MEM_TOKENS);
+    if (!grown || !data || self->count == 0)
+        return grown;
+
+    const size_t back = self->count - self->gap;
+    memcpy(grown, data, self->gap * size);
+    memcpy((char *)grown + (capacity - back) * size,
+        (const char *)data + (self->capacity - back) * size, back * size);
+    return grown;
+}
+
+// Frees the four arrays of a list with room for `capacity` rows. `NULL`
+// ones are skipped.
+static void freeArrays(
+    const TokenList *self,
+    void *kinds,
+    void *offsets,
+    void *lengths,
+    void *hashes,
+    size_t capacity
+) {
+    VecFree(kinds, capacity * sizeof(uint8_t), self->arena, MEM_TOKENS);
+    VecFree(offsets, capacity * sizeof(uint32_t), self->arena, MEM_TOKENS);
+    VecFree(lengths, capacity * sizeof(uint32_t), self->arena, MEM_TOKENS);
+    VecFree(hashes, capacity * sizeof(uint32_t), self->arena, MEM_TOKENS);
+}
+
+// Grows every array by the vec growth factor. All four are copied into new
+// arrays first and only swapped in once every one of them could be
+// allocated, so a failure leaves the list just as it was.
+static bool grow(TokenList *self) {
+    if (self->capacity > SIZE_MAX / GROWTH_FACTOR) {
+        fprintf(stderr, "<grow(): overflow>\n");
+        return false;
+    }
+
+    const size_t capacity = self->capacity * GROWTH_FACTOR;
+    uint8_t  *kinds   = growArray(self, self->kinds, sizeof(uint8_t), capacity);
+    uint32_t *offsets = growArray(
+        self, self->offsets, sizeof(uint32_t), capacity);
+    uint32_t *lengths = growArray(
+        self, self->lengths, sizeof(uint32_t), capacity);
+    uint32_t *hashes  = growArray(
+        self, self->hashes, sizeof(uint32_t), capacity);
+    if (!kinds || !offsets || !lengths || !hashes) {
+        fprintf(stderr, "<grow(): could not grow the token list>\n");
+        freeArrays(self, kinds, offsets, lengths, hashes, capacity);
+        return false;
+    }
+
+    freeArrays(self, self->kinds, self->offsets, self->lengths, self->hashes,
+        self->capacity);
+    self->kinds    = kinds;
+    self->offsets  = offsets;
+    self->lengths  = lengths;
+    self->hashes   = hashes;
+    self->capacity = capacity;
+    return true;
+}
+
+// Moves `n` rows of every array from row `from` to row `to`.
+static void moveRows(TokenList *self, size_t to, size_t from, size_t n) {
+    memmove(self->kinds + to, self->kinds + from, n * sizeof(uint8_t));
+    memmove(self->offsets + to, self->offsets + from, n * sizeof(uint32_t));
+    memmove(self->lengths + to, self->lengths + from, n * sizeof(uint32_t));
+    memmove(self->hashes + to, self->hashes + from, n * sizeof(uint32_t));
+}
+
+// Moves the gap to just before token `at`. The tokens it passes over go to
+// the other side, taking `gapDelta` with them or leaving it behind.
+static void moveGap(TokenList *self, size_t at) {
+    const size_t size = self->capacity - self->count;
+    if (at < self->gap) {
+        const size_t n = self->gap - at;
+        moveRows(self, at + size, at, n);
+        for (size_t i = 0; self->gapDelta != 0 && i < n; i++)
+            self->offsets[at + size + i] -= self->gapDelta;
+    } else if (at > self->gap) {
+        const size_t n = at - self->gap;
+        moveRows(self, self->gap, self->gap + size, n);
+        for (size_t i = 0; self->gapDelta != 0 && i < n; i++)
+            self->offsets[self->gap + i] += self->gapDelta;
+    }
+
+    self->gap = at;
+    if (at == self->count)
+        self->gapDelta = 0;
+}
+
+// Makes room for `count` value slots, allocating them the first time.
+static bool reserveValues(TokenList *self, size_t count) {
+    if (count <= self->valueCapacity)
+        return true;
+
+    if (!self->values) {
+        size_t capacity = INIT_TOKEN_VALUE_CAP;
+        while (capacity < count) capacity *= GROWTH_FACTOR;
+        self->values = VecAlloc(capacity, sizeof(TokenValue), self->arena,
+            ARENA_TAG_TOKENS, MEM_TOKENS);
+        if (!self->values) return false;
+        self->valueCapacity = capacity;
+        return true;
+    }
+
+    while (self->valueCapacity < count) {
+        void *values = VecGrow(self->values, &self->valueCapacity,
+            sizeof(TokenValue), self->arena, ARENA_TAG_TOKENS, MEM_TOKENS);
+        if (!values) return false;
+        self->values = values;
+    }
+    return true;
+}
+
+// Stores `value` in a freed slot, or a new one, and returns the slot. There
+// must be room for a new one (see `reserveValues()`).
+static uint32_t storeValue(TokenList *self, TokenValue value) {
+    size_t slot = self->valueFree;
+    if (slot != NO_FREE_VALUE)
+        self->valueFree = (size_t)self->values[slot].i;
+    else
+        slot = self->valueSlots++;
+
+    self->values[slot] = value;
+    self->valueCount++;
+    return (uint32_t)slot;
+}
+
+// Frees the value slots of the tokens in rows `first` up to `last`.
+static void dropValues(TokenList *self, size_t first, size_t last) {
+    for (size_t row = first; self->valueCount > 0 && row < last; row++) {
+        if (!TokenHasValue((TokenKind)self->kinds[row]))
+            continue;
+        const size_t slot = self->hashes[row];
+        self->values[slot].i = (int64_t)self->valueFree;
+        self->valueFree = slot;
+        self->valueCount--;
+    }
+}
+
+// Copies tokens `first` up to `first + n` of `from` into the rows of `self`
+// from `row` on, giving their values slots of their own. There must be room
+// for all of them and their values.
+static void copyRows(
+    TokenList *self,
+    size_t row,
+    const TokenList *from,
+    size_t first,
+    size_t n
+) {
+    // `from` keeps them in up to two runs, either side of its gap
+    const size_t start = row;
+    for (size_t i = first, end = first + n; i < end; ) {
+        const size_t runEnd = i < from->gap && from->gap < end
+            ? from->gap : end;
+        const size_t k = runEnd - i;
+        const size_t src = TLRow(from, i);
+        memcpy(self->kinds + row, from->kinds + src, k * sizeof(uint8_t));
+        memcpy(self->offsets + row, from->offsets + src, k * sizeof(uint32_t));
+        memcpy(self->lengths + row, from->lengths + src, k * sizeof(uint32_t));
+        memcpy(self->hashes + row, from->hashes + src, k * sizeof(uint32_t));
+
+        const uint32_t delta = i < from->gap ? 0 : from->gapDelta;
+        for (size_t j = row; delta != 0 && j < row + k; j++)
+            self->offsets[j] += delta;
+        row += k;
+        i = runEnd;
+    }
+
+    for (size_t j = start; from->valueCount > 0 && j < row; j++) {
+        if (TokenHasValue((TokenKind)self->kinds[j]))
+            self->hashes[j] = storeValue(self, from->values[self->hashes[j]]);
+    }
+}
+
 TokenList TLNew() {
-    List tokens = ListNew(sizeof(Token), INIT_TOKEN_LIST_CAP);
+    return TLNewInArena(NULL);
+}
 
-    if (!ListIsValid(&tokens))
-        return (TokenList) { NULL_LIST };
+TokenList TLNewInArena(Arena *arena) {
+    TokenList list = (TokenList) {
+        .valueFree = NO_FREE_VALUE,
+        .arena     = arena,
+    };
+    const size_t capacity = INIT_TOKEN_LIST_CAP;
+    list.kinds   = growArray(&list, NULL, sizeof(uint8_t), capacity);
+    list.offsets = growArray(&list, NULL, sizeof(uint32_t), capacity);
+    list.lengths = growArray(&list, NULL, sizeof(uint32_t), capacity);
+    list.hashes  = growArray(&list, NULL, sizeof(uint32_t), capacity);
+    list.capacity = capacity;
 
-    return (TokenList) { .tokens = tokens };
+    if (!TLIsValid(&list)) {
+        TLFree(&list);
+        return (TokenList) {0};
+    }
+    return list;
+}
+
+bool TLIsValid(const TokenList *self) {
+    return self
+        && self->kinds
+        && self->offsets
+        && self->lengths
+        && self->hashes
+        && self->capacity > 0;
 }
 
 void TLPush(TokenList *self, const Token *token) {
-    if (!self || !ListIsValid(&self->tokens))
+    if (!TLIsValid(self))
+        return;
+
+    // @(expect) assume growing works
+    if (self->gap != self->count)
+        moveGap(self, self->count);
+    if (self->count >= self->capacity && !grow(self))
         return;
 
-    // @(expect) assume ListPush works
-    /* discard */ ListPush(&self->tokens, token);
+    // Literals keep their value on the side, and its slot in the hash
+    uint32_t hash = token->hash;
+    if (TokenHasValue(token->kind)) {
+        if (!reserveValues(self, self->valueSlots + 1))
+            return;
+        hash = storeValue(self, token->value);
+    }
+
+    const size_t i = self->count++;
+    self->kinds[i]   = (uint8_t)token->kind;
+    self->offsets[i] = token->span.offset;
+    self->lengths[i] = token->span.length;
+    self->hashes[i]  = hash;
+    self->gap        = self->count;
+}
+
+void TLExtend(TokenList *self, const TokenList *from, size_t first) {
+    if (!TLIsValid(self) || !TLIsValid(from) || first >= from->count)
+        return;
+
+    const size_t n = from->count - first;
+    moveGap(self, self->count);
+    while (self->capacity - self->count < n) {
+        if (!grow(self)) return;
+    }
+    if (!reserveValues(self, self->valueSlots + from->valueCount))
+        return;
+
+    copyRows(self, self->count, from, first, n);
+    self->count += n;
+    self->gap    = self->count;
+}
+
+bool TLSplice(
+    TokenList *self,
+    size_t first,
+    size_t removed,
+    const TokenList *with
+) {
+    if (!TLIsValid(self) || !TLIsValid(with) || first + removed > self->count)
+        return false;
+
+    const size_t count = self->count - removed + with->count;
+    while (self->capacity < count) {
+        if (!grow(self)) return false;
+    }
+    if (!reserveValues(self, self->valueSlots + with->valueCount))
+        return false;
+
+    // With the gap right after the removed tokens, dropping them just
+    // widens it, and `with` goes in its front
+    moveGap(self, first + removed);
+    dropValues(self, first, first + removed);
+    copyRows(self, first, with, 0, with->count);
+    self->gap   = first + with->count;
+    self->count = count;
+    if (self->gap == count)
+        self->gapDelta = 0;
+    return true;
+}
+
+void TLShiftOffsets(
+    TokenList *self,
+    size_t first,
+    size_t last,
+    uint32_t delta
+) {
+    if (!TLIsValid(self) || delta == 0)
+        return;
+    if (last > self->count) last = self->count;
+    if (first >= last)
+        return;
+
+    // Every token from the gap on shares `gapDelta`
+    if (last == self->count && first >= self->gap) {
+        moveGap(self, first);
+        self->gapDelta += delta;
+        return;
+    }
+
+    for (size_t i = first; i < last; i++)
+        self->offsets[TLRow(self, i)] += delta;
+}
+
+void TLTruncate(TokenList *self, size_t count) {
+    if (!self || count >= self->count)
+        return;
+
+    if (count == 0) {
+        self->count      = 0;
+        self->gap        = 0;
+        self->gapDelta   = 0;
+        self->valueCount = 0;
+        self->valueSlots = 0;
+        self->valueFree  = NO_FREE_VALUE;
+        return;
+    }
+
+    // The dropped tokens end up as the back rows
+    moveGap(self, count);
+    dropValues(self, self->capacity - (self->count - count), self->capacity);
+    self->count    = count;
+    self->gapDelta = 0;
+}
+
+void TLDropFront(TokenList *self, size_t count) {
+    if (!TLIsValid(self) || count == 0)
+        return;
+    if (count >= self->count) {
+        TLTruncate(self, 0);
+        return;
+    }
+
+    const size_t rest = self->count - count;
+    moveGap(self, self->count);
+    dropValues(self, 0, count);
+    moveRows(self, 0, count, rest);
+    self->count = rest;
+    self->gap   = rest;
+}
+
+void TLFree(TokenList *self) {
+    if (!self)
+        return;
+
+    freeArrays(self, self->kinds, self->offsets, self->lengths, self->hashes,
+        self->capacity);
+    if (self->values) {
+        VecFree(self->values, self->valueCapacity * sizeof(TokenValue),
+            self->arena, MEM_TOKENS);
+    }
+    *self = (TokenList) {0};
+}
+
+void TLRecordMemStats(const TokenList *self) {
+    if (!self) return;
+    MemStatsSetInUse(MEM_TOKENS,
+        self->count * TOKEN_ROW_SIZE + self->valueCount * sizeof(TokenValue));
 }
 
 void TLPrint(FILE *ioStream, const TokenList *self) {
-    if (!self || !ioStream || !ListIsValid(&self->tokens)) {
+    if (!ioStream || !TLIsValid(self)) {
         fprintf(stderr, "<invalid token list pointer or IO stream pointer>\n");
         return;
     }
 
-    for (size_t i = 0; i < self->tokens.count; i++) {
-        Token *token = (Token *)ListGet(&self->tokens, i);
-        if (token->kind == TK_EOF) {
+    for (size_t i = 0; i < self->count; i++) {
+        if (TLKind(self, i) == TK_EOF) {
             fprintf(ioStream, "<eof>\n");
             break;
         }
-        if (!token) {
-            fprintf(ioStream, "<invalid token pointer in list>\n");
-            continue;
-        }
-        TokenPrint(ioStream, token);
+        const Token token = TLGet(self, i);
+        TokenPrint(ioStream, &token);
     }
 }
+
+// -------------------------------------------------------------------------- //
+// MARK: TokenSource
+// -------------------------------------------------------------------------- //
+
+bool TokenSourceIsValid(const TokenSource *self) {
+    return self && self->pull;
+}
@@ -3,8 +3,12 @@
 
 #include "../common/source.h"
 #include "../common/list.h"
+#include "../common/vec.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 #define INIT_TOKEN_LIST_CAP 512
+#define INIT_TOKEN_VALUE_CAP 64
 
 // -------------------------------------------------------------------------- //
 // MARK: Token
@@ -73,32 +77,202 @@
     X(TK_WHILE, "WHILE")                                                       \
     X(TK_EOF, "EOF")
 
+// Every keyword, as it's spelled in source.
+#define KEYWORD_LIST                                                           \
+    X(TK_TRUE,  "true")                                                        \
+    X(TK_FALSE, "false")                                                       \
+    X(TK_LET,   "let")                                                         \
+    X(TK_MUT,   "mut")                                                         \
+    X(TK_FUN,   "fun")                                                         \
+    X(TK_TYPE,  "type")                                                        \
+    X(TK_IF,    "if")                                                          \
+    X(TK_ELSE,  "else")                                                        \
+    X(TK_FOR,   "for")                                                         \
+    X(TK_IN,    "in")                                                          \
+    X(TK_WHILE, "while")                                                       \
+    X(TK_ENUM,  "enum")
+
 typedef enum TokenKind {
     #define X(name, str) name,
     TOKEN_LIST
     #undef X
 } TokenKind;
 
+// `TokenList` stores kinds in a byte.
+_Static_assert(TK_EOF <= UINT8_MAX, "token kinds must fit in a byte");
+
 const char *TokenKindAsString(const TokenKind tk);
 
+// The value of a `TK_INT` or `TK_FLOAT` token, decoded by the scanner.
+typedef union TokenValue {
+    int64_t i;
+    double  f;
+} TokenValue;
+
+// What the scanner found out about a `TK_STR` token, kept in its `hash`.
+// - `TOKEN_STR_ESCAPED` it has escapes, so it must be decoded before use.
+// - `TOKEN_STR_RAW` it's a raw string `r"..."`, whose contents are taken
+// as they are.
+typedef enum TokenStrFlags {
+    TOKEN_STR_ESCAPED = 1 << 0,
+    TOKEN_STR_RAW     = 1 << 1,
+} TokenStrFlags;
+
+// Returns whether tokens of `kind` carry a `Token.value`.
+static inline bool TokenHasValue(TokenKind kind) {
+    return kind == TK_INT || kind == TK_FLOAT;
+}
+
+// - `hash` for `TK_SYMBOL` tokens, `HashFold32(HashBytes())` of the lexeme,
+// computed once by the scanner so the interner never rehashes. For `TK_STR`
+// tokens, `TokenStrFlags`. Zero for every other kind.
+// - `value` for `TK_INT` and `TK_FLOAT` tokens, in place of the hash.
 typedef struct Token {
     const TokenKind kind;
     const Span      span;
+    union {
+        const uint32_t   hash;
+        const TokenValue value;
+    };
 } Token;
 
 void TokenPrint(FILE *ioStream, const Token *self);
 
 // -------------------------------------------------------------------------- //
 // MARK: TokenList
+// * Tokens are stored as parallel arrays rather than an array of `Token`, as
+// * the parser mostly only looks at kinds: scanning ahead over kinds touches
+// * one cache line per 64 tokens. `TLGet()` puts a `Token` back together.
+// * The arrays are gap buffers, so that an edit only moves the tokens between
+// * it and the one before, and shifting every token after it is one add.
 // -------------------------------------------------------------------------- //
 
+// - `kinds` the `TokenKind` of each token, in a byte.
+// - `offsets` and `lengths` the halves of each token's `Span`.
+// - `hashes` each token's `Token.hash`, or for tokens with a value, the
+// slot of that value in `values`.
+// - `count` and `capacity` shared by all four arrays.
+// - `gap` where the unused rows are: tokens from `gap` on are kept at the
+// back of the arrays. It stays at `count` unless the list is spliced.
+// - `gapDelta` added (wrapping) to the offsets kept at the back.
+// - `values` the values of `TK_INT` and `TK_FLOAT` tokens. Only literals
+// take a slot here, so the other tokens pay nothing for them. Slots never
+// move, freed ones are chained from `valueFree` through `TokenValue.i`.
+// - `valueCount` live values, `valueSlots` slots ever handed out and
+// `valueCapacity`, allocated on first use.
+// - `arena` the arena the arrays draw from, or `NULL` for the heap.
 typedef struct TokenList {
-    List tokens;
+    uint8_t  *kinds;
+    uint32_t *offsets;
+    uint32_t *lengths;
+    uint32_t *hashes;
+    size_t count;
+    size_t capacity;
+    size_t gap;
+    uint32_t gapDelta;
+    TokenValue *values;
+    size_t valueCount;
+    size_t valueSlots;
+    size_t valueCapacity;
+    size_t valueFree;
+    Arena *arena;
 } TokenList;
 
 TokenList TLNew();
+
+// Same as `TLNew()`, but the tokens are allocated from `arena` under
+// `ARENA_TAG_TOKENS`, so they can be dropped with `ArenaReleaseTag()` once
+// parsing is finished.
+TokenList TLNewInArena(Arena *arena);
+bool TLIsValid(const TokenList *self);
 void TLPush(TokenList *self, const Token *token);
+
+// Appends the tokens of `from`, starting at `first`.
+void TLExtend(TokenList *self, const TokenList *from, size_t first);
+
+// Drops every token from `count` on.
+void TLTruncate(TokenList *self, size_t count);
+
+// Drops the first `count` tokens and moves the rest to the front.
+void TLDropFront(TokenList *self, size_t count);
+
+// Replaces the `removed` tokens starting at `first` with all of `with`.
+// Returns `false` (leaving `self` as it was) if the list could not grow.
+// Only the tokens between `first` and the previous splice are moved.
+bool TLSplice(TokenList *self, size_t first, size_t removed,
+    const TokenList *with);
+
+// How an edit changed a token list: the `removed` tokens at `first` were
+// replaced by `inserted` new ones. The offsets of the tokens before them
+// moved by `headDelta` and of the tokens after them by `tailDelta` (both
+// wrapping), so old token `i` past the edit is new token
+// `i - removed + inserted`.
+typedef struct TokenEdit {
+    size_t first;
+    size_t removed;
+    size_t inserted;
+    uint32_t headDelta;
+    uint32_t tailDelta;
+} TokenEdit;
+
+// Adds `delta` (wrapping) to the offsets of tokens `first` up to `last`.
+// Shifting every token from the last splice on is a single add.
+void TLShiftOffsets(TokenList *self, size_t first, size_t last,
+    uint32_t delta);
+void TLFree(TokenList *self);
 void TLPrint(FILE *ioStream, const TokenList *self);
 
+// Reports the bytes occupied by tokens to `MemStatsSetInUse()`.
+void TLRecordMemStats(const TokenList *self);
+
+// Returns the array row token `i` is kept in.
+static inline size_t TLRow(const TokenList *self, size_t i) {
+    return i < self->gap ? i : i + (self->capacity - self->count);
+}
+
+static inline TokenKind TLKind(const TokenList *self, size_t i) {
+    assert(i < self->count);
+    return (TokenKind)self->kinds[TLRow(self, i)];
+}
+
+static inline Span TLSpan(const TokenList *self, size_t i) {
+    assert(i < self->count);
+    if (i < self->gap)
+        return (Span) { self->offsets[i], self->lengths[i] };
+    const size_t row = i + (self->capacity - self->count);
+    return (Span) { self->offsets[row] + self->gapDelta, self->lengths[row] };
+}
+
+static inline Token TLGet(const TokenList *self, size_t i) {
+    assert(i < self->count);
+    const size_t row = TLRow(self, i);
+    const TokenKind kind = (TokenKind)self->kinds[row];
+    const uint32_t delta = i < self->gap ? 0 : self->gapDelta;
+    const Span span = { self->offsets[row] + delta, self->lengths[row] };
+    if (TokenHasValue(kind)) {
+        return (Token) {
+            .kind  = kind,
+            .span  = span,
+            .value = self->values[self->hashes[row]],
+        };
+    }
+    return (Token) { kind, span, { self->hashes[row] } };
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: TokenSource
+// -------------------------------------------------------------------------- //
+
+// Hands out tokens one at a time as they are asked for, so a consumer never
+// needs the whole list. `pull` writes the next token to `out`, and keeps
+// writing the `TK_EOF` token once the end has been reached.
+typedef struct TokenSource {
+    void (*pull)(void *ctx, Token *out);
+    void *ctx;
+} TokenSource;
+
+// Returns whether the source has a `pull` function.
+bool TokenSourceIsValid(const TokenSource *self);
+
 
 #endif
@@ -0,0 +1,335 @@
+#include "unicode.h"
+
+// -------------------------------------------------------------------------- //
+// MARK: UTF-8
+// -------------------------------------------------------------------------- //
+
+size_t Utf8Length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if (lead < 0xC2) return 0; // continuation, or an overlong 2 byte lead
+    if (lead < 0xE0) return 2;
+    if (lead < 0xF0) return 3;
+    if (lead < 0xF5) return 4;
+    return 0;
+}
+
+size_t Utf8Decode(const char *text, size_t length, uint32_t *out) {
+    if (length == 0)
+        return 0;
+
+    const unsigned char *bytes = (const unsigned char *)text;
+    const size_t need = Utf8Length(bytes[0]);
+    if (need == 0 || need > length)
+        return 0;
+
+    // The lead byte keeps its low `7 - need` bits (all 7 for ASCII)
+    uint32_t cp = need == 1 ? bytes[0] : bytes[0] & (0x7Fu >> need);
+    for (size_t i = 1; i < need; i++) {
+        if ((bytes[i] & 0xC0) != 0x80)
+            return 0;
+        cp = cp << 6 | (bytes[i] & 0x3F);
+    }
+
+    // Shortest form only, and no surrogates
+    static const uint32_t least[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (cp < least[need] || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000))
+        return 0;
+
+    *out = cp;
+    return need;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Identifiers
+// * One sorted table for both properties, since every `XID_Start` code point
+// * is also `XID_Continue`. Each entry is `first << 2 | class` and the class
+// * holds up to the next entry: 0 for neither, 1 for `XID_Continue` only and
+// * 2 for both. Generated from the Unicode 14.0 character database, starting
+// * at U+0080, with the subscript digits U+2080..U+2089 added to
+// * `XID_Continue` so that `λ₁` is a name (a profile UAX #31 allows).
+// -------------------------------------------------------------------------- //
+
+#define XID_CONTINUE 1
+#define XID_START    2
+
+static const uint32_t xidTable[] = {
+    0x0000200, 0x00002AA, 0x00002AC, 0x00002D6, 0x00002D8, 0x00002DD, 0x00002E0,
+    0x00002EA, 0x00002EC, 0x0000302, 0x000035C, 0x0000362, 0x00003DC, 0x00003E2,
+    0x0000B08, 0x0000B1A, 0x0000B48, 0x0000B82, 0x0000B94, 0x0000BB2, 0x0000BB4,
+    0x0000BBA, 0x0000BBC, 0x0000C01, 0x0000DC2, 0x0000DD4, 0x0000DDA, 0x0000DE0,
+    0x0000DEE, 0x0000DF8, 0x0000DFE, 0x0000E00, 0x0000E1A, 0x0000E1D, 0x0000E22,
+    0x0000E2C, 0x0000E32, 0x0000E34, 0x0000E3A, 0x0000E88, 0x0000E8E, 0x0000FD8,
+    0x0000FDE, 0x0001208, 0x000120D, 0x0001220, 0x000122A, 0x00014C0, 0x00014C6,
+    0x000155C, 0x0001566, 0x0001568, 0x0001582, 0x0001624, 0x0001645, 0x00016F8,
+    0x00016FD, 0x0001700, 0x0001705, 0x000170C, 0x0001711, 0x0001718, 0x000171D,
+    0x0001720, 0x0001742, 0x00017AC, 0x00017BE, 0x00017CC, 0x0001841, 0x000186C,
+    0x0001882, 0x000192D, 0x00019A8, 0x00019BA, 0x00019C1, 0x00019C6, 0x0001B50,
+    0x0001B56, 0x0001B59, 0x0001B74, 0x0001B7D, 0x0001B96, 0x0001B9D, 0x0001BA4,
+    0x0001BA9, 0x0001BBA, 0x0001BC1, 0x0001BEA, 0x0001BF4, 0x0001BFE, 0x0001C00,
+    0x0001C42, 0x0001C45, 0x0001C4A, 0x0001CC1, 0x0001D2C, 0x0001D36, 0x0001E99,
+    0x0001EC6, 0x0001EC8, 0x0001F01, 0x0001F2A, 0x0001FAD, 0x0001FD2, 0x0001FD8,
+    0x0001FEA, 0x0001FEC, 0x0001FF5, 0x0001FF8, 0x0002002, 0x0002059, 0x000206A,
+    0x000206D, 0x0002092, 0x0002095, 0x00020A2, 0x00020A5, 0x00020B8, 0x0002102,
+    0x0002165, 0x0002170, 0x0002182, 0x00021AC, 0x00021C2, 0x0002220, 0x0002226,
+    0x000223C, 0x0002261, 0x0002282, 0x0002329, 0x0002388, 0x000238D, 0x0002412,
+    0x00024E9, 0x00024F6, 0x00024F9, 0x0002542, 0x0002545, 0x0002562, 0x0002589,
+    0x0002590, 0x0002599, 0x00025C0, 0x00025C6, 0x0002605, 0x0002610, 0x0002616,
+    0x0002634, 0x000263E, 0x0002644, 0x000264E, 0x00026A4, 0x00026AA, 0x00026C4,
+    0x00026CA, 0x00026CC, 0x00026DA, 0x00026E8, 0x00026F1, 0x00026F6, 0x00026F9,
+    0x0002714, 0x000271D, 0x0002724, 0x000272D, 0x000273A, 0x000273C, 0x000275D,
+    0x0002760, 0x0002772, 0x0002778, 0x000277E, 0x0002789, 0x0002790, 0x0002799,
+    0x00027C2, 0x00027C8, 0x00027F2, 0x00027F4, 0x00027F9, 0x00027FC, 0x0002805,
+    0x0002810, 0x0002816, 0x000282C, 0x000283E, 0x0002844, 0x000284E, 0x00028A4,
+    0x00028AA, 0x00028C4, 0x00028CA, 0x00028D0, 0x00028D6, 0x00028DC, 0x00028E2,
+    0x00028E8, 0x00028F1, 0x00028F4, 0x00028F9, 0x000290C, 0x000291D, 0x0002924,
+    0x000292D, 0x0002938, 0x0002945, 0x0002948, 0x0002966, 0x0002974, 0x000297A,
+    0x000297C, 0x0002999, 0x00029CA, 0x00029D5, 0x00029D8, 0x0002A05, 0x0002A10,
+    0x0002A16, 0x0002A38, 0x0002A3E, 0x0002A48, 0x0002A4E, 0x0002AA4, 0x0002AAA,
+    0x0002AC4, 0x0002ACA, 0x0002AD0, 0x0002AD6, 0x0002AE8, 0x0002AF1, 0x0002AF6,
+    0x0002AF9, 0x0002B18, 0x0002B1D, 0x0002B28, 0x0002B2D, 0x0002B38, 0x0002B42,
+    0x0002B44, 0x0002B82, 0x0002B89, 0x0002B90, 0x0002B99, 0x0002BC0, 0x0002BE6,
+    0x0002BE9, 0x0002C00, 0x0002C05, 0x0002C10, 0x0002C16, 0x0002C34, 0x0002C3E,
+    0x0002C44, 0x0002C4E, 0x0002CA4, 0x0002CAA, 0x0002CC4, 0x0002CCA, 0x0002CD0,
+    0x0002CD6, 0x0002CE8, 0x0002CF1, 0x0002CF6, 0x0002CF9, 0x0002D14, 0x0002D1D,
+    0x0002D24, 0x0002D2D, 0x0002D38, 0x0002D55, 0x0002D60, 0x0002D72, 0x0002D78,
+    0x0002D7E, 0x0002D89, 0x0002D90, 0x0002D99, 0x0002DC0, 0x0002DC6, 0x0002DC8,
+    0x0002E09, 0x0002E0E, 0x0002E10, 0x0002E16, 0x0002E2C, 0x0002E3A, 0x0002E44,
+    0x0002E4A, 0x0002E58, 0x0002E66, 0x0002E6C, 0x0002E72, 0x0002E74, 0x0002E7A,
+    0x0002E80, 0x0002E8E, 0x0002E94, 0x0002EA2, 0x0002EAC, 0x0002EBA, 0x0002EE8,
+    0x0002EF9, 0x0002F0C, 0x0002F19, 0x0002F24, 0x0002F29, 0x0002F38, 0x0002F42,
+    0x0002F44, 0x0002F5D, 0x0002F60, 0x0002F99, 0x0002FC0, 0x0003001, 0x0003016,
+    0x0003034, 0x000303A, 0x0003044, 0x000304A, 0x00030A4, 0x00030AA, 0x00030E8,
+    0x00030F1, 0x00030F6, 0x00030F9, 0x0003114, 0x0003119, 0x0003124, 0x0003129,
+    0x0003138, 0x0003155, 0x000315C, 0x0003162, 0x000316C, 0x0003176, 0x0003178,
+    0x0003182, 0x0003189, 0x0003190, 0x0003199, 0x00031C0, 0x0003202, 0x0003205,
+    0x0003210, 0x0003216, 0x0003234, 0x000323A, 0x0003244, 0x000324A, 0x00032A4,
+    0x00032AA, 0x00032D0, 0x00032D6, 0x00032E8, 0x00032F1, 0x00032F6, 0x00032F9,
+    0x0003314, 0x0003319, 0x0003324, 0x0003329, 0x0003338, 0x0003355, 0x000335C,
+    0x0003376, 0x000337C, 0x0003382, 0x0003389, 0x0003390, 0x0003399, 0x00033C0,
+    0x00033C6, 0x00033CC, 0x0003401, 0x0003412, 0x0003434, 0x000343A, 0x0003444,
+    0x000344A, 0x00034ED, 0x00034F6, 0x00034F9, 0x0003514, 0x0003519, 0x0003524,
+    0x0003529, 0x000353A, 0x000353C, 0x0003552, 0x000355D, 0x0003560, 0x000357E,
+    0x0003589, 0x0003590, 0x0003599, 0x00035C0, 0x00035EA, 0x0003600, 0x0003605,
+    0x0003610, 0x0003616, 0x000365C, 0x000366A, 0x00036C8, 0x00036CE, 0x00036F0,
+    0x00036F6, 0x00036F8, 0x0003702, 0x000371C, 0x0003729, 0x000372C, 0x000373D,
+    0x0003754, 0x0003759, 0x000375C, 0x0003761, 0x0003780, 0x0003799, 0x00037C0,
+    0x00037C9, 0x00037D0, 0x0003806, 0x00038C5, 0x00038CA, 0x00038CD, 0x00038EC,
+    0x0003902, 0x000391D, 0x000393C, 0x0003941, 0x0003968, 0x0003A06, 0x0003A0C,
+    0x0003A12, 0x0003A14, 0x0003A1A, 0x0003A2C, 0x0003A32, 0x0003A90, 0x0003A96,
+    0x0003A98, 0x0003A9E, 0x0003AC5, 0x0003ACA, 0x0003ACD, 0x0003AF6, 0x0003AF8,
+    0x0003B02, 0x0003B14, 0x0003B1A, 0x0003B1C, 0x0003B21, 0x0003B38, 0x0003B41,
+    0x0003B68, 0x0003B72, 0x0003B80, 0x0003C02, 0x0003C04, 0x0003C61, 0x0003C68,
+    0x0003C81, 0x0003CA8, 0x0003CD5, 0x0003CD8, 0x0003CDD, 0x0003CE0, 0x0003CE5,
+    0x0003CE8, 0x0003CF9, 0x0003D02, 0x0003D20, 0x0003D26, 0x0003DB4, 0x0003DC5,
+    0x0003E14, 0x0003E19, 0x0003E22, 0x0003E35, 0x0003E60, 0x0003E65, 0x0003EF4,
+    0x0003F19, 0x0003F1C, 0x0004002, 0x00040AD, 0x00040FE, 0x0004101, 0x0004128,
+    0x0004142, 0x0004159, 0x000416A, 0x0004179, 0x0004186, 0x0004189, 0x0004196,
+    0x000419D, 0x00041BA, 0x00041C5, 0x00041D6, 0x0004209, 0x000423A, 0x000423D,
+    0x0004278, 0x0004282, 0x0004318, 0x000431E, 0x0004320, 0x0004336, 0x0004338,
+    0x0004342, 0x00043EC, 0x00043F2, 0x0004924, 0x000492A, 0x0004938, 0x0004942,
+    0x000495C, 0x0004962, 0x0004964, 0x000496A, 0x0004978, 0x0004982, 0x0004A24,
+    0x0004A2A, 0x0004A38, 0x0004A42, 0x0004AC4, 0x0004ACA, 0x0004AD8, 0x0004AE2,
+    0x0004AFC, 0x0004B02, 0x0004B04, 0x0004B0A, 0x0004B18, 0x0004B22, 0x0004B5C,
+    0x0004B62, 0x0004C44, 0x0004C4A, 0x0004C58, 0x0004C62, 0x0004D6C, 0x0004D75,
+    0x0004D80, 0x0004DA5, 0x0004DC8, 0x0004E02, 0x0004E40, 0x0004E82, 0x0004FD8,
+    0x0004FE2, 0x0004FF8, 0x0005006, 0x00059B4, 0x00059BE, 0x0005A00, 0x0005A06,
+    0x0005A6C, 0x0005A82, 0x0005BAC, 0x0005BBA, 0x0005BE4, 0x0005C02, 0x0005C49,
+    0x0005C58, 0x0005C7E, 0x0005CC9, 0x0005CD4, 0x0005D02, 0x0005D49, 0x0005D50,
+    0x0005D82, 0x0005DB4, 0x0005DBA, 0x0005DC4, 0x0005DC9, 0x0005DD0, 0x0005E02,
+    0x0005ED1, 0x0005F50, 0x0005F5E, 0x0005F60, 0x0005F72, 0x0005F75, 0x0005F78,
+    0x0005F81, 0x0005FA8, 0x000602D, 0x0006038, 0x000603D, 0x0006068, 0x0006082,
+    0x00061E4, 0x0006202, 0x00062A5, 0x00062AA, 0x00062AC, 0x00062C2, 0x00063D8,
+    0x0006402, 0x000647C, 0x0006481, 0x00064B0, 0x00064C1, 0x00064F0, 0x0006519,
+    0x0006542, 0x00065B8, 0x00065C2, 0x00065D4, 0x0006602, 0x00066B0, 0x00066C2,
+    0x0006728, 0x0006741, 0x000676C, 0x0006802, 0x000685D, 0x0006870, 0x0006882,
+    0x0006955, 0x000697C, 0x0006981, 0x00069F4, 0x00069FD, 0x0006A28, 0x0006A41,
+    0x0006A68, 0x0006A9E, 0x0006AA0, 0x0006AC1, 0x0006AF8, 0x0006AFD, 0x0006B3C,
+    0x0006C01, 0x0006C16, 0x0006CD1, 0x0006D16, 0x0006D34, 0x0006D41, 0x0006D68,
+    0x0006DAD, 0x0006DD0, 0x0006E01, 0x0006E0E, 0x0006E85, 0x0006EBA, 0x0006EC1,
+    0x0006EEA, 0x0006F99, 0x0006FD0, 0x0007002, 0x0007091, 0x00070E0, 0x0007101,
+    0x0007128, 0x0007136, 0x0007141, 0x000716A, 0x00071F8, 0x0007202, 0x0007224,
+    0x0007242, 0x00072EC, 0x00072F6, 0x0007300, 0x0007341, 0x000734C, 0x0007351,
+    0x00073A6, 0x00073B5, 0x00073BA, 0x00073D1, 0x00073D6, 0x00073DD, 0x00073EA,
+    0x00073EC, 0x0007402, 0x0007701, 0x0007802, 0x0007C58, 0x0007C62, 0x0007C78,
+    0x0007C82, 0x0007D18, 0x0007D22, 0x0007D38, 0x0007D42, 0x0007D60, 0x0007D66,
+    0x0007D68, 0x0007D6E, 0x0007D70, 0x0007D76, 0x0007D78, 0x0007D7E, 0x0007DF8,
+    0x0007E02, 0x0007ED4, 0x0007EDA, 0x0007EF4, 0x0007EFA, 0x0007EFC, 0x0007F0A,
+    0x0007F14, 0x0007F1A, 0x0007F34, 0x0007F42, 0x0007F50, 0x0007F5A, 0x0007F70,
+    0x0007F82, 0x0007FB4, 0x0007FCA, 0x0007FD4, 0x0007FDA, 0x0007FF4, 0x00080FD,
+    0x0008104, 0x0008151, 0x0008154, 0x00081C6, 0x00081C8, 0x00081FE, 0x0008201,
+    0x0008228, 0x0008242, 0x0008274, 0x0008341, 0x0008374, 0x0008385, 0x0008388,
+    0x0008395, 0x00083C4, 0x000840A, 0x000840C, 0x000841E, 0x0008420, 0x000842A,
+    0x0008450, 0x0008456, 0x0008458, 0x0008462, 0x0008478, 0x0008492, 0x0008494,
+    0x000849A, 0x000849C, 0x00084A2, 0x00084A4, 0x00084AA, 0x00084E8, 0x00084F2,
+    0x0008500, 0x0008516, 0x0008528, 0x000853A, 0x000853C, 0x0008582, 0x0008624,
+    0x000B002, 0x000B394, 0x000B3AE, 0x000B3BD, 0x000B3CA, 0x000B3D0, 0x000B402,
+    0x000B498, 0x000B49E, 0x000B4A0, 0x000B4B6, 0x000B4B8, 0x000B4C2, 0x000B5A0,
+    0x000B5BE, 0x000B5C0, 0x000B5FD, 0x000B602, 0x000B65C, 0x000B682, 0x000B69C,
+    0x000B6A2, 0x000B6BC, 0x000B6C2, 0x000B6DC, 0x000B6E2, 0x000B6FC, 0x000B702,
+    0x000B71C, 0x000B722, 0x000B73C, 0x000B742, 0x000B75C, 0x000B762, 0x000B77C,
+    0x000B781, 0x000B800, 0x000C016, 0x000C020, 0x000C086, 0x000C0A9, 0x000C0C0,
+    0x000C0C6, 0x000C0D8, 0x000C0E2, 0x000C0F4, 0x000C106, 0x000C25C, 0x000C265,
+    0x000C26C, 0x000C276, 0x000C280, 0x000C286, 0x000C3EC, 0x000C3F2, 0x000C400,
+    0x000C416, 0x000C4C0, 0x000C4C6, 0x000C63C, 0x000C682, 0x000C700, 0x000C7C2,
+    0x000C800, 0x000D002, 0x0013700, 0x0013802, 0x0029234, 0x0029342, 0x00293F8,
+    0x0029402, 0x0029834, 0x0029842, 0x0029881, 0x00298AA, 0x00298B0, 0x0029902,
+    0x00299BD, 0x00299C0, 0x00299D1, 0x00299F8, 0x00299FE, 0x0029A79, 0x0029A82,
+    0x0029BC1, 0x0029BC8, 0x0029C5E, 0x0029C80, 0x0029C8A, 0x0029E24, 0x0029E2E,
+    0x0029F2C, 0x0029F42, 0x0029F48, 0x0029F4E, 0x0029F50, 0x0029F56, 0x0029F68,
+    0x0029FCA, 0x002A009, 0x002A00E, 0x002A019, 0x002A01E, 0x002A02D, 0x002A032,
+    0x002A08D, 0x002A0A0, 0x002A0B1, 0x002A0B4, 0x002A102, 0x002A1D0, 0x002A201,
+    0x002A20A, 0x002A2D1, 0x002A318, 0x002A341, 0x002A368, 0x002A381, 0x002A3CA,
+    0x002A3E0, 0x002A3EE, 0x002A3F0, 0x002A3F6, 0x002A3FD, 0x002A42A, 0x002A499,
+    0x002A4B8, 0x002A4C2, 0x002A51D, 0x002A550, 0x002A582, 0x002A5F4, 0x002A601,
+    0x002A612, 0x002A6CD, 0x002A704, 0x002A73E, 0x002A741, 0x002A768, 0x002A782,
+    0x002A795, 0x002A79A, 0x002A7C1, 0x002A7EA, 0x002A7FC, 0x002A802, 0x002A8A5,
+    0x002A8DC, 0x002A902, 0x002A90D, 0x002A912, 0x002A931, 0x002A938, 0x002A941,
+    0x002A968, 0x002A982, 0x002A9DC, 0x002A9EA, 0x002A9ED, 0x002A9FA, 0x002AAC1,
+    0x002AAC6, 0x002AAC9, 0x002AAD6, 0x002AADD, 0x002AAE6, 0x002AAF9, 0x002AB02,
+    0x002AB05, 0x002AB0A, 0x002AB0C, 0x002AB6E, 0x002AB78, 0x002AB82, 0x002ABAD,
+    0x002ABC0, 0x002ABCA, 0x002ABD5, 0x002ABDC, 0x002AC06, 0x002AC1C, 0x002AC26,
+    0x002AC3C, 0x002AC46, 0x002AC5C, 0x002AC82, 0x002AC9C, 0x002ACA2, 0x002ACBC,
+    0x002ACC2, 0x002AD6C, 0x002AD72, 0x002ADA8, 0x002ADC2, 0x002AF8D, 0x002AFAC,
+    0x002AFB1, 0x002AFB8, 0x002AFC1, 0x002AFE8, 0x002B002, 0x0035E90, 0x0035EC2,
+    0x0035F1C, 0x0035F2E, 0x0035FF0, 0x003E402, 0x003E9B8, 0x003E9C2, 0x003EB68,
+    0x003EC02, 0x003EC1C, 0x003EC4E, 0x003EC60, 0x003EC76, 0x003EC79, 0x003EC7E,
+    0x003ECA4, 0x003ECAA, 0x003ECDC, 0x003ECE2, 0x003ECF4, 0x003ECFA, 0x003ECFC,
+    0x003ED02, 0x003ED08, 0x003ED0E, 0x003ED14, 0x003ED1A, 0x003EEC8, 0x003EF4E,
+    0x003F178, 0x003F192, 0x003F4F8, 0x003F542, 0x003F640, 0x003F64A, 0x003F720,
+    0x003F7C2, 0x003F7E8, 0x003F801, 0x003F840, 0x003F881, 0x003F8C0, 0x003F8CD,
+    0x003F8D4, 0x003F935, 0x003F940, 0x003F9C6, 0x003F9C8, 0x003F9CE, 0x003F9D0,
+    0x003F9DE, 0x003F9E0, 0x003F9E6, 0x003F9E8, 0x003F9EE, 0x003F9F0, 0x003F9F6,
+    0x003F9F8, 0x003F9FE, 0x003FBF4, 0x003FC41, 0x003FC68, 0x003FC86, 0x003FCEC,
+    0x003FCFD, 0x003FD00, 0x003FD06, 0x003FD6C, 0x003FD9A, 0x003FE79, 0x003FE82,
+    0x003FEFC, 0x003FF0A, 0x003FF20, 0x003FF2A, 0x003FF40, 0x003FF4A, 0x003FF60,
+    0x003FF6A, 0x003FF74, 0x0040002, 0x0040030, 0x0040036, 0x004009C, 0x00400A2,
+    0x00400EC, 0x00400F2, 0x00400F8, 0x00400FE, 0x0040138, 0x0040142, 0x0040178,
+    0x0040202, 0x00403EC, 0x0040502, 0x00405D4, 0x00407F5, 0x00407F8, 0x0040A02,
+    0x0040A74, 0x0040A82, 0x0040B44, 0x0040B81, 0x0040B84, 0x0040C02, 0x0040C80,
+    0x0040CB6, 0x0040D2C, 0x0040D42, 0x0040DD9, 0x0040DEC, 0x0040E02, 0x0040E78,
+    0x0040E82, 0x0040F10, 0x0040F22, 0x0040F40, 0x0040F46, 0x0040F58, 0x0041002,
+    0x0041278, 0x0041281, 0x00412A8, 0x00412C2, 0x0041350, 0x0041362, 0x00413F0,
+    0x0041402, 0x00414A0, 0x00414C2, 0x0041590, 0x00415C2, 0x00415EC, 0x00415F2,
+    0x004162C, 0x0041632, 0x004164C, 0x0041652, 0x0041658, 0x004165E, 0x0041688,
+    0x004168E, 0x00416C8, 0x00416CE, 0x00416E8, 0x00416EE, 0x00416F4, 0x0041802,
+    0x0041CDC, 0x0041D02, 0x0041D58, 0x0041D82, 0x0041DA0, 0x0041E02, 0x0041E18,
+    0x0041E1E, 0x0041EC4, 0x0041ECA, 0x0041EEC, 0x0042002, 0x0042018, 0x0042022,
+    0x0042024, 0x004202A, 0x00420D8, 0x00420DE, 0x00420E4, 0x00420F2, 0x00420F4,
+    0x00420FE, 0x0042158, 0x0042182, 0x00421DC, 0x0042202, 0x004227C, 0x0042382,
+    0x00423CC, 0x00423D2, 0x00423D8, 0x0042402, 0x0042458, 0x0042482, 0x00424E8,
+    0x0042602, 0x00426E0, 0x00426FA, 0x0042700, 0x0042802, 0x0042805, 0x0042810,
+    0x0042815, 0x004281C, 0x0042831, 0x0042842, 0x0042850, 0x0042856, 0x0042860,
+    0x0042866, 0x00428D8, 0x00428E1, 0x00428EC, 0x00428FD, 0x0042900, 0x0042982,
+    0x00429F4, 0x0042A02, 0x0042A74, 0x0042B02, 0x0042B20, 0x0042B26, 0x0042B95,
+    0x0042B9C, 0x0042C02, 0x0042CD8, 0x0042D02, 0x0042D58, 0x0042D82, 0x0042DCC,
+    0x0042E02, 0x0042E48, 0x0043002, 0x0043124, 0x0043202, 0x00432CC, 0x0043302,
+    0x00433CC, 0x0043402, 0x0043491, 0x00434A0, 0x00434C1, 0x00434E8, 0x0043A02,
+    0x0043AA8, 0x0043AAD, 0x0043AB4, 0x0043AC2, 0x0043AC8, 0x0043C02, 0x0043C74,
+    0x0043C9E, 0x0043CA0, 0x0043CC2, 0x0043D19, 0x0043D44, 0x0043DC2, 0x0043E09,
+    0x0043E18, 0x0043EC2, 0x0043F14, 0x0043F82, 0x0043FDC, 0x0044001, 0x004400E,
+    0x00440E1, 0x004411C, 0x0044199, 0x00441C6, 0x00441CD, 0x00441D6, 0x00441D8,
+    0x00441FD, 0x004420E, 0x00442C1, 0x00442EC, 0x0044309, 0x004430C, 0x0044342,
+    0x00443A4, 0x00443C1, 0x00443E8, 0x0044401, 0x004440E, 0x004449D, 0x00444D4,
+    0x00444D9, 0x0044500, 0x0044512, 0x0044515, 0x004451E, 0x0044520, 0x0044542,
+    0x00445CD, 0x00445D0, 0x00445DA, 0x00445DC, 0x0044601, 0x004460E, 0x00446CD,
+    0x0044706, 0x0044714, 0x0044725, 0x0044734, 0x0044739, 0x004476A, 0x004476C,
+    0x0044772, 0x0044774, 0x0044802, 0x0044848, 0x004484E, 0x00448B1, 0x00448E0,
+    0x00448F9, 0x00448FC, 0x0044A02, 0x0044A1C, 0x0044A22, 0x0044A24, 0x0044A2A,
+    0x0044A38, 0x0044A3E, 0x0044A78, 0x0044A7E, 0x0044AA4, 0x0044AC2, 0x0044B7D,
+    0x0044BAC, 0x0044BC1, 0x0044BE8, 0x0044C01, 0x0044C10, 0x0044C16, 0x0044C34,
+    0x0044C3E, 0x0044C44, 0x0044C4E, 0x0044CA4, 0x0044CAA, 0x0044CC4, 0x0044CCA,
+    0x0044CD0, 0x0044CD6, 0x0044CE8, 0x0044CED, 0x0044CF6, 0x0044CF9, 0x0044D14,
+    0x0044D1D, 0x0044D24, 0x0044D2D, 0x0044D38, 0x0044D42, 0x0044D44, 0x0044D5D,
+    0x0044D60, 0x0044D76, 0x0044D89, 0x0044D90, 0x0044D99, 0x0044DB4, 0x0044DC1,
+    0x0044DD4, 0x0045002, 0x00450D5, 0x004511E, 0x004512C, 0x0045141, 0x0045168,
+    0x0045179, 0x004517E, 0x0045188, 0x0045202, 0x00452C1, 0x0045312, 0x0045318,
+    0x004531E, 0x0045320, 0x0045341, 0x0045368, 0x0045602, 0x00456BD, 0x00456D8,
+    0x00456E1, 0x0045704, 0x0045762, 0x0045771, 0x0045778, 0x0045802, 0x00458C1,
+    0x0045904, 0x0045912, 0x0045914, 0x0045941, 0x0045968, 0x0045A02, 0x0045AAD,
+    0x0045AE2, 0x0045AE4, 0x0045B01, 0x0045B28, 0x0045C02, 0x0045C6C, 0x0045C75,
+    0x0045CB0, 0x0045CC1, 0x0045CE8, 0x0045D02, 0x0045D1C, 0x0046002, 0x00460B1,
+    0x00460EC, 0x0046282, 0x0046381, 0x00463A8, 0x00463FE, 0x004641C, 0x0046426,
+    0x0046428, 0x0046432, 0x0046450, 0x0046456, 0x004645C, 0x0046462, 0x00464C1,
+    0x00464D8, 0x00464DD, 0x00464E4, 0x00464ED, 0x00464FE, 0x0046501, 0x0046506,
+    0x0046509, 0x0046510, 0x0046541, 0x0046568, 0x0046682, 0x00466A0, 0x00466AA,
+    0x0046745, 0x0046760, 0x0046769, 0x0046786, 0x0046788, 0x004678E, 0x0046791,
+    0x0046794, 0x0046802, 0x0046805, 0x004682E, 0x00468CD, 0x00468EA, 0x00468ED,
+    0x00468FC, 0x004691D, 0x0046920, 0x0046942, 0x0046945, 0x0046972, 0x0046A29,
+    0x0046A68, 0x0046A76, 0x0046A78, 0x0046AC2, 0x0046BE4, 0x0047002, 0x0047024,
+    0x004702A, 0x00470BD, 0x00470DC, 0x00470E1, 0x0047102, 0x0047104, 0x0047141,
+    0x0047168, 0x00471CA, 0x0047240, 0x0047249, 0x00472A0, 0x00472A5, 0x00472DC,
+    0x0047402, 0x004741C, 0x0047422, 0x0047428, 0x004742E, 0x00474C5, 0x00474DC,
+    0x00474E9, 0x00474EC, 0x00474F1, 0x00474F8, 0x00474FD, 0x004751A, 0x004751D,
+    0x0047520, 0x0047541, 0x0047568, 0x0047582, 0x0047598, 0x004759E, 0x00475A4,
+    0x00475AA, 0x0047629, 0x004763C, 0x0047641, 0x0047648, 0x004764D, 0x0047662,
+    0x0047664, 0x0047681, 0x00476A8, 0x0047B82, 0x0047BCD, 0x0047BDC, 0x0047EC2,
+    0x0047EC4, 0x0048002, 0x0048E68, 0x0049002, 0x00491BC, 0x0049202, 0x0049510,
+    0x004BE42, 0x004BFC4, 0x004C002, 0x004D0BC, 0x0051002, 0x005191C, 0x005A002,
+    0x005A8E4, 0x005A902, 0x005A97C, 0x005A981, 0x005A9A8, 0x005A9C2, 0x005AAFC,
+    0x005AB01, 0x005AB28, 0x005AB42, 0x005ABB8, 0x005ABC1, 0x005ABD4, 0x005AC02,
+    0x005ACC1, 0x005ACDC, 0x005AD02, 0x005AD10, 0x005AD41, 0x005AD68, 0x005AD8E,
+    0x005ADE0, 0x005ADF6, 0x005AE40, 0x005B902, 0x005BA00, 0x005BC02, 0x005BD2C,
+    0x005BD3D, 0x005BD42, 0x005BD45, 0x005BE20, 0x005BE3D, 0x005BE4E, 0x005BE80,
+    0x005BF82, 0x005BF88, 0x005BF8E, 0x005BF91, 0x005BF94, 0x005BFC1, 0x005BFC8,
+    0x005C002, 0x0061FE0, 0x0062002, 0x0063358, 0x0063402, 0x0063424, 0x006BFC2,
+    0x006BFD0, 0x006BFD6, 0x006BFF0, 0x006BFF6, 0x006BFFC, 0x006C002, 0x006C48C,
+    0x006C542, 0x006C54C, 0x006C592, 0x006C5A0, 0x006C5C2, 0x006CBF0, 0x006F002,
+    0x006F1AC, 0x006F1C2, 0x006F1F4, 0x006F202, 0x006F224, 0x006F242, 0x006F268,
+    0x006F275, 0x006F27C, 0x0073C01, 0x0073CB8, 0x0073CC1, 0x0073D1C, 0x0074595,
+    0x00745A8, 0x00745B5, 0x00745CC, 0x00745ED, 0x007460C, 0x0074615, 0x0074630,
+    0x00746A9, 0x00746B8, 0x0074909, 0x0074914, 0x0075002, 0x0075154, 0x007515A,
+    0x0075274, 0x007527A, 0x0075280, 0x007528A, 0x007528C, 0x0075296, 0x007529C,
+    0x00752A6, 0x00752B4, 0x00752BA, 0x00752E8, 0x00752EE, 0x00752F0, 0x00752F6,
+    0x0075310, 0x0075316, 0x0075418, 0x007541E, 0x007542C, 0x0075436, 0x0075454,
+    0x007545A, 0x0075474, 0x007547A, 0x00754E8, 0x00754EE, 0x00754FC, 0x0075502,
+    0x0075514, 0x007551A, 0x007551C, 0x007552A, 0x0075544, 0x007554A, 0x0075A98,
+    0x0075AA2, 0x0075B04, 0x0075B0A, 0x0075B6C, 0x0075B72, 0x0075BEC, 0x0075BF2,
+    0x0075C54, 0x0075C5A, 0x0075CD4, 0x0075CDA, 0x0075D3C, 0x0075D42, 0x0075DBC,
+    0x0075DC2, 0x0075E24, 0x0075E2A, 0x0075EA4, 0x0075EAA, 0x0075F0C, 0x0075F12,
+    0x0075F30, 0x0075F39, 0x0076000, 0x0076801, 0x00768DC, 0x00768ED, 0x00769B4,
+    0x00769D5, 0x00769D8, 0x0076A11, 0x0076A14, 0x0076A6D, 0x0076A80, 0x0076A85,
+    0x0076AC0, 0x0077C02, 0x0077C7C, 0x0078001, 0x007801C, 0x0078021, 0x0078064,
+    0x007806D, 0x0078088, 0x007808D, 0x0078094, 0x0078099, 0x00780AC, 0x0078402,
+    0x00784B4, 0x00784C1, 0x00784DE, 0x00784F8, 0x0078501, 0x0078528, 0x007853A,
+    0x007853C, 0x0078A42, 0x0078AB9, 0x0078ABC, 0x0078B02, 0x0078BB1, 0x0078BE8,
+    0x0079F82, 0x0079F9C, 0x0079FA2, 0x0079FB0, 0x0079FB6, 0x0079FBC, 0x0079FC2,
+    0x0079FFC, 0x007A002, 0x007A314, 0x007A341, 0x007A35C, 0x007A402, 0x007A511,
+    0x007A52E, 0x007A530, 0x007A541, 0x007A568, 0x007B802, 0x007B810, 0x007B816,
+    0x007B880, 0x007B886, 0x007B88C, 0x007B892, 0x007B894, 0x007B89E, 0x007B8A0,
+    0x007B8A6, 0x007B8CC, 0x007B8D2, 0x007B8E0, 0x007B8E6, 0x007B8E8, 0x007B8EE,
+    0x007B8F0, 0x007B90A, 0x007B90C, 0x007B91E, 0x007B920, 0x007B926, 0x007B928,
+    0x007B92E, 0x007B930, 0x007B936, 0x007B940, 0x007B946, 0x007B94C, 0x007B952,
+    0x007B954, 0x007B95E, 0x007B960, 0x007B966, 0x007B968, 0x007B96E, 0x007B970,
+    0x007B976, 0x007B978, 0x007B97E, 0x007B980, 0x007B986, 0x007B98C, 0x007B992,
+    0x007B994, 0x007B99E, 0x007B9AC, 0x007B9B2, 0x007B9CC, 0x007B9D2, 0x007B9E0,
+    0x007B9E6, 0x007B9F4, 0x007B9FA, 0x007B9FC, 0x007BA02, 0x007BA28, 0x007BA2E,
+    0x007BA70, 0x007BA86, 0x007BA90, 0x007BA96, 0x007BAA8, 0x007BAAE, 0x007BAF0,
+    0x007EFC1, 0x007EFE8, 0x0080002, 0x00A9B80, 0x00A9C02, 0x00ADCE4, 0x00ADD02,
+    0x00AE078, 0x00AE082, 0x00B3A88, 0x00B3AC2, 0x00BAF84, 0x00BE002, 0x00BE878,
+    0x00C0002, 0x00C4D2C, 0x0380401, 0x03807C0,
+};
+
+// Returns the class of `cp`, by a binary search for the last entry that
+// starts at or before it.
+static unsigned xidClass(uint32_t cp) {
+    const size_t count = sizeof(xidTable) / sizeof(xidTable[0]);
+    if (cp < 0x80 || cp > 0x10FFFF)
+        return 0;
+
+    const uint32_t key = cp << 2 | 3;
+    size_t lo = 0, hi = count;
+    while (hi - lo > 1) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (xidTable[mid] <= key) lo = mid;
+        else                      hi = mid;
+    }
+    return xidTable[lo] & 3;
+}
+
+bool UnicodeIsXidStart(uint32_t cp) {
+    return xidClass(cp) == XID_START;
+}
+
+bool UnicodeIsXidContinue(uint32_t cp) {
+    return xidClass(cp) != 0;
+}
@@ -0,0 +1,35 @@
+#ifndef UNICODE_H
+#define UNICODE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// -------------------------------------------------------------------------- //
+// MARK: UTF-8
+// -------------------------------------------------------------------------- //
+
+// Returns how many bytes the sequence starting with `lead` takes, or zero if
+// `lead` can't start one (a continuation byte, or an encoding of more than
+// four bytes). ASCII is one byte.
+size_t Utf8Length(unsigned char lead);
+
+// Decodes the code point at `text` into `*out` and returns its length, or
+// zero if the sequence is invalid: truncated by `length`, overlong, a
+// surrogate or past U+10FFFF. `*out` is only written on success.
+size_t Utf8Decode(const char *text, size_t length, uint32_t *out);
+
+// -------------------------------------------------------------------------- //
+// MARK: Identifiers
+// * Identifiers follow Unicode's default syntax (UAX #31): an `XID_Start`
+// * code point, then any number of `XID_Continue` ones. Only code points
+// * past ASCII are looked up, the scanner's own tables handle the rest.
+// -------------------------------------------------------------------------- //
+
+// Returns whether `cp` may start an identifier.
+bool UnicodeIsXidStart(uint32_t cp);
+
+// Returns whether `cp` may follow the start of an identifier.
+bool UnicodeIsXidContinue(uint32_t cp);
+
+#endif
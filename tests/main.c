@@ -3,9 +3,13 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stdbool.h>
-#include "testparser.h"
+#include "testParser.h"
+#include "testCommon.h"
+#include "testScanner.h"
 
 int main(int argc, char **argv) {
+    RunCommonTests();
+    RunScannerTests();
     RunParserTests();
     return 0;
 }
@@ -24,3 +24,9 @@ void ContextScan(Context *self) {
     TLPrint(stderr, &self->tl);
     DEPrint(stderr, &self->de);
 }
+
+void ContextFree(Context *self) {
+    TLFree(&self->tl);
+    DiagnosticVecFree(&self->de.diagnostics);
+    AstFree(&self->ast);
+}
@@ -59,4 +59,7 @@ typedef struct Context {
 Context ContextNew(const char *srcData);
 void ContextScan(Context *self);
 
+// Frees the token list, diagnostics and AST of the context.
+void ContextFree(Context *self);
+
 #endif
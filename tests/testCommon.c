@@ -0,0 +1,416 @@
+#define M2L_TEST_IMPL
+
+// Test headers
+#include "test.h"
+#include "testCommon.h"
+#include <string.h>
+
+// Lib headers
+#include "../src/common/arena.h"
+#include "../src/common/list.h"
+#include "../src/common/vec.h"
+#include "../src/common/seglist.h"
+#include "../src/common/memstats.h"
+#include "../src/common/source.h"
+#include "../src/common/intern.h"
+#include "../src/common/hash.h"
+
+typedef struct Pair { const int a; const int b; } Pair;
+DEFINE_VEC(Pair)
+DEFINE_SEG_LIST(Pair)
+
+void RunCommonTests() {
+    #define X(name) Test##name();
+    COMMON_TESTS
+    #undef X
+}
+
+TEST(ArenaList) {
+    TestContext tctx = BEGIN("arena backed list");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Arena arena = ArenaNew(256);
+    List list = ListNewInArena(&arena, ARENA_TAG_TOKENS, sizeof(int), 4);
+    void *first = list.data;
+
+    // Grow well past the initial capacity and the chunk size
+    for (int i = 0; i < 1000; i++)
+        ListPush(&list, &i);
+
+    // A second tag shouldn't be affected by releasing the first
+    int *other = ArenaAlloc(&arena, ARENA_TAG_AST, sizeof(int));
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, ListIsValid(&list), "invalid list");
+    CHECK(tctx, first != NULL, "no initial allocation");
+    CHECK(tctx, list.count == 1000, "count != 1000");
+    CHECK(tctx, *(int *)ListGet(&list, 999) == 999, "wrong last element");
+    CHECK(tctx, other != NULL, "tagged allocation failed");
+
+    ArenaReleaseTag(&arena, ARENA_TAG_TOKENS);
+    CHECK(tctx, ArenaBytesUsed(&arena, ARENA_TAG_TOKENS) == 0,
+        "tokens tag not released");
+    CHECK(tctx, ArenaBytesUsed(&arena, ARENA_TAG_AST) > 0,
+        "ast tag released with tokens");
+
+    ArenaRelease(&arena);
+    END(tctx)
+}
+
+TEST(Vec) {
+    TestContext tctx = BEGIN("type specialized vec");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    PairVec vec = PairVecNew(1);
+    ListResult last = LIST_RES_OK;
+    for (int i = 0; i < 100; i++) {
+        const Pair pair = { i, -i };
+        last = PairVecPush(&vec, &pair);
+    }
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, PairVecIsValid(&vec), "invalid vec");
+    CHECK(tctx, last == LIST_RES_OK || last == LIST_RES_REALLOC, "push failed");
+    CHECK(tctx, vec.count == 100, "count != 100");
+    CHECK(tctx, vec.capacity >= 100, "capacity < count");
+    CHECK(tctx, PairVecGet(&vec, 42)->b == -42, "wrong element");
+    CHECK(tctx, PairVecFront(&vec)->a == 0, "wrong front");
+    CHECK(tctx, PairVecBack(&vec)->a == 99, "wrong back");
+
+    PairVecFree(&vec);
+    CHECK(tctx, !PairVecIsValid(&vec), "vec not poisoned");
+    END(tctx)
+}
+
+TEST(SegList) {
+    TestContext tctx = BEGIN("segmented list");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    PairSegList list = PairSegListNew(4);
+    const Pair first = { 0, 0 };
+    PairSegListPush(&list, &first);
+    Pair *firstPtr = PairSegListGet(&list, 0);
+
+    // Force several new segments
+    bool pushed = true;
+    for (int i = 1; i < 1000; i++) {
+        const Pair pair = { i, -i };
+        ListResult res = PairSegListPush(&list, &pair);
+        pushed = pushed && res == LIST_RES_OK;
+    }
+
+    // Every element should be where it was put
+    bool ordered = true;
+    for (int i = 0; i < 1000; i++)
+        ordered = ordered && PairSegListGet(&list, i)->a == i;
+
+    // A block that crosses into a new segment (the one at 1020 holds 1024)
+    Pair block[50];
+    for (int i = 0; i < 50; i++) {
+        const Pair pair = { 1000 + i, -1000 - i };
+        memcpy(&block[i], &pair, sizeof(Pair));
+    }
+    const bool extended = PairSegListExtend(&list, block, 50) == LIST_RES_OK;
+    for (int i = 1000; i < 1050; i++)
+        ordered = ordered && PairSegListGet(&list, i)->a == i;
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, PairSegListIsValid(&list), "invalid seglist");
+    CHECK(tctx, pushed, "push failed");
+    CHECK(tctx, ordered, "elements out of order");
+    CHECK(tctx, extended, "extend failed");
+    CHECK(tctx, list.count == 1050, "count != 1050");
+    CHECK(tctx, PairSegListGet(&list, 0) == firstPtr, "first element moved");
+    CHECK(tctx, PairSegListBack(&list)->b == -1049, "wrong back");
+
+    PairSegListFree(&list);
+    END(tctx)
+}
+
+TEST(MemStats) {
+    TestContext tctx = BEGIN("memory accounting");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    MemStatsReset();
+    PairVec vec = PairVecNewInArena(NULL, ARENA_TAG_MISC, MEM_DIAGS, 2);
+    for (int i = 0; i < 10; i++) {
+        const Pair pair = { i, i };
+        PairVecPush(&vec, &pair);
+    }
+    MemStatsSetInUse(MEM_DIAGS, vec.count * sizeof(Pair));
+    MemStats grown = MemStatsGet(MEM_DIAGS);
+
+    PairVecFree(&vec);
+    MemStats freed = MemStatsGet(MEM_DIAGS);
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, grown.allocs == 1, "allocs != 1");
+    CHECK(tctx, grown.reallocs == 3, "reallocs != 3 (2 -> 4 -> 8 -> 16)");
+    CHECK(tctx, grown.reserved == 16 * sizeof(Pair), "wrong reserved bytes");
+    CHECK(tctx, grown.wasted == 6 * sizeof(Pair), "wrong wasted bytes");
+    CHECK(tctx, freed.reserved == 0, "free not recorded");
+    CHECK(tctx, freed.peak == 16 * sizeof(Pair), "wrong peak");
+
+    MemStatsReset();
+    END(tctx)
+}
+
+TEST(SourceFromFile) {
+    TestContext tctx = BEGIN("memory mapped source");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    const char *path = "tm2l_source.m2l";
+    const char *text = "x = y";
+    FILE *file = fopen(path, "wb");
+    if (file) {
+        fputs(text, file);
+        fclose(file);
+    }
+
+    Source src = SourceNewFromFile(path);
+    bool valid = SourceIsValid(&src);
+
+    // Everything past the end should be zero
+    bool guarded = valid;
+    for (size_t i = 0; valid && i < SOURCE_GUARD_SIZE; i++)
+        guarded = guarded && src.data[src.length + i] == 0;
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, file != NULL, "could not write test file");
+    CHECK(tctx, valid, "invalid source");
+    CHECK(tctx, valid && src.length == strlen(text), "wrong length");
+    CHECK(tctx, valid && memcmp(src.data, text, src.length) == 0,
+        "wrong contents");
+    CHECK(tctx, guarded, "guard region is not zero");
+
+    SourceFree(&src);
+    CHECK(tctx, !SourceIsValid(&src), "source not poisoned");
+    remove(path);
+    END(tctx)
+}
+
+TEST(LineIndex) {
+    TestContext tctx = BEGIN("line index and compact spans");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+
+    // Long enough that the newline count crosses a 16 byte block
+    const char *text = "let x = 1\n\nfoo(bar, baz)\n    qux\n";
+    Source a = SourceNewFromData("first");
+    Source b = SourceNewFromData(text);
+
+    // `qux` is on line 4, column 5
+    size_t quxOffset = (size_t)(strstr(text, "qux") - text);
+    const Span qux = { (uint32_t)(b.base + quxOffset), 3 };
+    size_t line = 0, col = 0;
+    bool found = SpanLineCol(&qux, &line, &col);
+    Substring str = SpanSubstring(&qux);
+
+    // Line 2 is empty, so its first byte is the newline
+    size_t emptyLine = 0, emptyCol = 0;
+    /* discard */ SourceLineCol(&b, 10, &emptyLine, &emptyCol);
+
+    const Span first = { a.base, 5 };
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, sizeof(Span) == 8, "span is not 8 bytes");
+    CHECK(tctx, found && line == 4 && col == 5, "wrong line or column");
+    CHECK(tctx, SubstringCmpString(&str, "qux"), "wrong substring");
+    CHECK(tctx, emptyLine == 2 && emptyCol == 1, "wrong empty line");
+    CHECK(tctx, SpanSource(&qux) != NULL
+        && SpanSource(&qux)->base == b.base, "wrong source for span");
+    CHECK(tctx, SpanSource(&first)->base == a.base,
+        "wrong source for first span");
+
+    const Span merged = SpanMerge(&first, &qux);
+    CHECK(tctx, merged.offset == 0 && merged.length == 0,
+        "merged spans of different sources");
+
+    SourceFree(&b);
+    CHECK(tctx, SpanSource(&qux) == NULL, "span outlived its source");
+    END(tctx)
+}
+
+TEST(SourceManager) {
+    TestContext tctx = BEGIN("source manager");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    const char *paths[] = { "tm2l_sm_a.m2l", "tm2l_sm_b.m2l", "tm2l_sm_c.m2l" };
+    const char *texts[] = { "x = y\nz", "x = y\nz", "other" };
+    for (size_t i = 0; i < 3; i++) {
+        FILE *file = fopen(paths[i], "wb");
+        if (!file) continue;
+        fputs(texts[i], file);
+        fclose(file);
+    }
+
+    FileId a     = SMOpenFile(paths[0]);
+    FileId again = SMOpenFile("./tm2l_sm_a.m2l");
+    FileId b     = SMOpenFile(paths[1]);
+    FileId c     = SMOpenFile(paths[2]);
+    FileId buf   = SMAddBuffer("x = y\nz", 7, "<buffer>");
+
+    const Source *srcA = SMGetSource(a);
+    const Source *srcB = SMGetSource(b);
+
+    // `z` in the duplicate, which has its own offsets but shared lines
+    size_t local = 0, line = 0, col = 0;
+    const Span z = { srcB ? srcB->base + 6 : 0, 1 };
+    FileId located = SMLocate(z.offset, &local);
+    bool found = SpanLineCol(&z, &line, &col);
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, a != NULL_FILE_ID && b != NULL_FILE_ID && c != NULL_FILE_ID,
+        "could not open files");
+    CHECK(tctx, a == again, "same file loaded twice");
+    CHECK(tctx, a != b && b != c, "different files share an id");
+    CHECK(tctx, SMCanonicalFile(b) == a && SMCanonicalFile(c) == c,
+        "wrong canonical files");
+    CHECK(tctx, SMCanonicalFile(buf) == a, "buffer contents not deduplicated");
+    CHECK(tctx, srcA && srcB && srcA->data != srcB->data,
+        "duplicates deduplicated at open");
+    CHECK(tctx, located == b && local == 6, "wrong file for offset");
+    CHECK(tctx, found && line == 2 && col == 1, "wrong line or column");
+
+    SMRelease();
+    CHECK(tctx, SMGetSource(a) == NULL, "source survived release");
+    for (size_t i = 0; i < 3; i++) remove(paths[i]);
+    END(tctx)
+}
+
+TEST(SourceReplace) {
+    TestContext tctx = BEGIN("replacing sources");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    // From an empty manager, so that the only free offsets are our own
+    SMRelease();
+    FileId a = SMAddBuffer("x = y\nz", 7, "<replace a>");
+    FileId b = SMAddBuffer("x = y\nz", 7, "<replace b>");
+    const FileId duplicate = SMCanonicalFile(b);
+    const Source *src = SMGetSource(a);
+    const uint32_t base = src ? src->base : 0;
+
+    // Same name, same id and base, and `b` is no longer a duplicate
+    const FileId again = SMAddBuffer("x", 1, "<replace a>");
+    const bool inPlace = again == a && src && src->base == base
+        && src->length == 1;
+    const FileId unique = SMCanonicalFile(b);
+
+    // Growing past the reservation moves `a` past `b`, and its old offsets
+    // go to the next source that fits
+    const bool grown = SMReplaceBuffer(a, "x = y\nz = w\n", 12);
+    const bool moved = src && src->base != base;
+    const FileId c = SMAddBuffer("abc", 3, "<replace c>");
+    const bool reused = SMLocate(base, NULL) == c;
+
+    // Many edits of one buffer don't use up the offset space
+    static char text[512];
+    memset(text, 'x', sizeof(text));
+    bool edited = true;
+    for (size_t i = 0; edited && i < 10000; i++)
+        edited = SMReplaceBuffer(a, text, 1 + i * 7919 % sizeof(text));
+    const bool bounded = src && src->base < base + 4 * sizeof(text);
+
+    // Closing frees the id and the offsets
+    const Source *srcB = SMGetSource(b);
+    const uint32_t baseB = srcB ? srcB->base : 0;
+    SMCloseFile(b);
+    const FileId reopened = SMAddBuffer("x = y\nz", 7, "<replace b>");
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, a != NULL_FILE_ID && b != NULL_FILE_ID && a != b,
+        "could not add buffers");
+    CHECK(tctx, duplicate == a, "duplicate contents not found");
+    CHECK(tctx, inPlace, "buffer not replaced in place");
+    CHECK(tctx, unique == b, "duplicate kept after a replacement");
+    CHECK(tctx, grown && moved, "grown buffer did not move");
+    CHECK(tctx, reused, "freed offsets not handed out again");
+    CHECK(tctx, edited && bounded, "edits used up the offset space");
+    CHECK(tctx, SMGetSource(b) == NULL && SMLocate(baseB, NULL) != b,
+        "closed buffer still resolves");
+    CHECK(tctx, reopened != b && reopened != NULL_FILE_ID,
+        "closed buffer name not released");
+
+    SMRelease();
+    END(tctx)
+}
+
+TEST(Interner) {
+    TestContext tctx = BEGIN("symbol interner");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Interner interner = InternerNew();
+    bool valid = InternerIsValid(&interner);
+
+    // Enough distinct names to force the table to grow a few times
+    char name[16];
+    SymbolId ids[2048] = {0};
+    bool distinct = true;
+    for (size_t i = 0; valid && i < 2048; i++) {
+        int length = snprintf(name, sizeof(name), "sym_%zu", i);
+        uint32_t hash = HashFold32(HashBytes(name, (size_t)length));
+        ids[i] = InternerIntern(&interner, name, (size_t)length, hash);
+        distinct = distinct && ids[i] == (SymbolId)(i + 1);
+    }
+
+    // Interning again returns the same ids
+    bool stable = valid;
+    for (size_t i = 0; valid && i < 2048; i += 97) {
+        int length = snprintf(name, sizeof(name), "sym_%zu", i);
+        uint32_t hash = HashFold32(HashBytes(name, (size_t)length));
+        stable = stable
+            && InternerIntern(&interner, name, (size_t)length, hash) == ids[i];
+    }
+
+    Substring str = InternerGet(&interner, ids[1234]);
+    Substring none = InternerGet(&interner, NULL_SYMBOL_ID);
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, valid, "invalid interner");
+    CHECK(tctx, distinct, "ids are not dense");
+    CHECK(tctx, stable, "same name interned twice");
+    CHECK(tctx, SubstringCmpString(&str, "sym_1234"), "wrong symbol bytes");
+    CHECK(tctx, SubstringIsNull(&none), "null id has bytes");
+    CHECK(tctx, HashBytes("abc", 3) != HashBytes("abd", 3),
+        "trivial hash collision");
+
+    InternerFree(&interner);
+    CHECK(tctx, !InternerIsValid(&interner), "interner not poisoned");
+    END(tctx)
+}
@@ -0,0 +1,22 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include "test.h"
+#define COMMON_TESTS \
+    X(ArenaList)                                                               \
+    X(Vec)                                                                    \
+    X(SegList)                                                                \
+    X(MemStats)                                                               \
+    X(SourceFromFile)                                                         \
+    X(LineIndex)                                                              \
+    X(SourceManager)                                                          \
+    X(SourceReplace)                                                          \
+    X(Interner)
+
+#define X(name) int Test##name();
+COMMON_TESTS
+#undef X
+
+void RunCommonTests();
+
+#endif
@@ -2,12 +2,16 @@
 
 // Test headers
 #include "test.h"
-#include "testparser.h"
+#include "testParser.h"
+#include <stdlib.h>
+#include <string.h>
 
 // Lib headers
 #include "../src/parsing/parser.h"
 #include "../src/parsing/expr.h"
 #include "../src/parsing/printer.h"
+#include "../src/scanning/scanner.h"
+#include "../src/driver/driver.h"
 
 void RunParserTests() {
     #define X(name) Test##name();
@@ -15,6 +19,83 @@ void RunParserTests() {
     #undef X
 }
 
+// Writes the tree under `id` to `out` as an s-expression, `(op lhs rhs)` for
+// binary operators, `(op x)` for prefix and `(x op)` for postfix ones.
+static size_t sexpr(const Ast *ast, ExprId id, char *out, size_t cap) {
+    const Expression *expr = AstExprGet(ast, id);
+    if (!expr || cap == 0)
+        return 0;
+
+    size_t n = 0;
+    #define EMIT(...)                                                          \
+        n += (size_t)snprintf(out + n, n < cap ? cap - n : 0, __VA_ARGS__)
+    #define SUB(id)                                                            \
+        n += sexpr(ast, (id), out + (n < cap ? n : cap), n < cap ? cap - n : 0)
+
+    switch (expr->kind) {
+    case EXPR_SYMBOL: {
+        const Substring name = InternerGet(
+            &ast->symbols, expr->data.exprSymbol);
+        EMIT("%.*s", (int)name.length, name.data);
+        break;
+    }
+    case EXPR_INT:
+        EMIT("%lld", (long long)expr->data.exprInt);
+        break;
+    case EXPR_PREFIX:
+        EMIT("(%s ", expr->data.exprUnary.op);
+        SUB(expr->data.exprUnary.operand);
+        EMIT(")");
+        break;
+    case EXPR_POSTFIX:
+        EMIT("(");
+        SUB(expr->data.exprUnary.operand);
+        EMIT(" %s)", expr->data.exprUnary.op);
+        break;
+    case EXPR_BINARY:
+    case EXPR_LOGICAL:
+    case EXPR_COMPARE:
+    case EXPR_EQUALITY:
+    case EXPR_ASSIGN:
+        EMIT("(%s ", expr->data.exprBinary.op);
+        SUB(expr->data.exprBinary.lhs);
+        EMIT(" ");
+        SUB(expr->data.exprBinary.rhs);
+        EMIT(")");
+        break;
+    case EXPR_CALL: {
+        const ExprCall call = expr->data.exprCall;
+        EMIT("(call ");
+        SUB(call.callee);
+        for (size_t i = 0; i < call.argc; i++) {
+            EMIT(" ");
+            SUB(ArgumentSegListGet(&ast->args, call.argid + i)->value);
+        }
+        EMIT(")");
+        break;
+    }
+    default:
+        EMIT("?");
+        break;
+    }
+
+    #undef EMIT
+    #undef SUB
+    return n;
+}
+
+// Writes the tree of every top-level item to `out`, separated by `; `.
+static size_t rootTrees(const Ast *ast, char *out, size_t cap) {
+    size_t n = 0;
+    for (size_t i = NULL_AST_ID + 1; i < AstRootCount(ast) && n < cap; i++) {
+        if (i > NULL_AST_ID + 1)
+            n += (size_t)snprintf(out + n, cap - n, "; ");
+        if (n < cap)
+            n += sexpr(ast, AstRootAt(ast, i), out + n, cap - n);
+    }
+    return n;
+}
+
 TEST(Call) {
     TestContext tctx = BEGIN("parse call");
 
@@ -28,7 +109,7 @@ TEST(Call) {
     ExprId id = expression(&parser);
     AstPrinter astPrinter = AstPrinterNew(&ctx.source, &ctx.ast);
 
-    ListDumpInfo(stderr, &ctx.ast.args);
+    ArgumentSegListDumpInfo(stderr, &ctx.ast.args);
     DEPrint(stderr, &ctx.de);
     AstPrintExpr(&astPrinter, id);
 
@@ -40,5 +121,714 @@ TEST(Call) {
     CHECK(tctx, expr->kind == EXPR_CALL, "not a call");
     CHECK(tctx, expr->data.exprCall.argc == 2, "!= 2 arguments");
 
+    ParserFree(&parser);
+    ContextFree(&ctx);
+    END(tctx)
+}
+
+TEST(Precedence) {
+    TestContext tctx = BEGIN("parse precedence");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Context ctx = ContextNew(
+        "a = b || c && d == e < f - g - h * i ** j ** k % -m++ // (n + o)");
+    ContextScan(&ctx);
+
+    Parser parser = ParserNew(&ctx.source, &ctx.ast, &ctx.de, &ctx.tl);
+    const ExprId id = expression(&parser);
+
+    char tree[256] = { 0 };
+    /* discard */ sexpr(&ctx.ast, id, tree, sizeof(tree));
+
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, ctx.de.diagnostics.count == 0, "unexpected diagnostics");
+    CHECK(tctx, strcmp(tree,
+        "(= a (|| b (&& c (== d (< e (- (- f g) (// (% (* h (** i (** j k)))"
+        " (- (m ++))) (+ n o))))))))") == 0,
+        "wrong tree");
+    CHECK(tctx, parser.cursor + 1 == ctx.tl.count, "expression not consumed");
+
+    ParserFree(&parser);
+    ContextFree(&ctx);
+    END(tctx)
+}
+
+TEST(NestedCalls) {
+    TestContext tctx = BEGIN("parse nested calls");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Context ctx = ContextNew("f(g(1, h()), k(2), 3)");
+    ContextScan(&ctx);
+
+    Parser parser = ParserNew(&ctx.source, &ctx.ast, &ctx.de, &ctx.tl);
+    const ExprId id = expression(&parser);
+
+    char tree[128] = {0};
+    /* discard */ sexpr(&ctx.ast, id, tree, sizeof(tree));
+
+
+    // The inner calls are completed first, so the outer call's arguments
+    // are the last block
+    const Expression *root = AstExprGet(&ctx.ast, id);
+    const bool outerLast = root && root->kind == EXPR_CALL
+        && root->data.exprCall.argid + root->data.exprCall.argc
+            == ctx.ast.args.count;
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, ctx.de.diagnostics.count == 0, "unexpected diagnostics");
+    CHECK(tctx, strcmp(tree,
+        "(call f (call g 1 (call h)) (call k 2) 3)") == 0,
+        "arguments not contiguous");
+    CHECK(tctx, outerLast && ctx.ast.args.count == 6, "wrong argument blocks");
+    CHECK(tctx, parser.argScratch.count == 0, "scratch stack not emptied");
+
+    ParserFree(&parser);
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+TEST(DeepNesting) {
+    TestContext tctx = BEGIN("parse deep nesting");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    // Far deeper than a call per level would fit on the C stack:
+    // `f(f(...f(!!...!((...(x)...)) + 1)...))`
+    const size_t depth = 20000;
+    char *text = malloc(depth * 6 + 16);
+    size_t n = 0;
+    if (text) {
+        for (size_t i = 0; i < depth; i++) {
+            text[n++] = 'f';
+            text[n++] = '(';
+        }
+        for (size_t i = 0; i < depth; i++) text[n++] = '!';
+        for (size_t i = 0; i < depth; i++) text[n++] = '(';
+        text[n++] = 'x';
+        for (size_t i = 0; i < depth; i++) text[n++] = ')';
+        memcpy(text + n, " + 1", 4);
+        n += 4;
+        for (size_t i = 0; i < depth; i++) text[n++] = ')';
+        text[n] = '\0';
+    }
+
+    Context ctx = ContextNew(text ? text : "");
+    ContextScan(&ctx);
+
+    Parser parser = ParserNew(&ctx.source, &ctx.ast, &ctx.de, &ctx.tl);
+    const ExprId id = expression(&parser);
+    const Expression *root = AstExprGet(&ctx.ast, id);
+
+    // One node of each for every level, and the sum at the bottom
+    size_t calls = 0, nots = 0, sums = 0;
+    for (size_t i = NULL_AST_ID + 1; i < ctx.ast.exprs.count; i++) {
+        const Expression *expr = AstExprGet(&ctx.ast, i);
+        calls     += expr->kind == EXPR_CALL;
+        nots      += expr->kind == EXPR_PREFIX;
+        sums      += expr->kind == EXPR_BINARY;
+    }
+
+    // Every call's only argument is the next call in, down to the `!`s
+    size_t chain = 0;
+    for (const Expression *expr = root; expr && expr->kind == EXPR_CALL
+        && expr->data.exprCall.argc == 1; chain++) {
+        const Argument *arg = ArgumentSegListGet(
+            &ctx.ast.args, expr->data.exprCall.argid);
+        expr = AstExprGet(&ctx.ast, arg->value);
+    }
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, text && root, "invalid expr");
+    CHECK(tctx, ctx.de.diagnostics.count == 0, "unexpected diagnostics");
+    CHECK(tctx, calls == depth && nots == depth,
+        "wrong number of calls or nots");
+    CHECK(tctx, sums == 1 && root && root->kind == EXPR_CALL
+        && ctx.tl.count == depth * 6 + 4, "wrong tree");
+    CHECK(tctx, chain == depth, "wrong argument chain");
+    CHECK(tctx, parser.frames.count == 0 && parser.operands.count == 0
+        && parser.argScratch.count == 0, "stacks not emptied");
+
+    ParserFree(&parser);
+    ContextFree(&ctx);
+    free(text);
+    END(tctx)
+}
+
+TEST(StringLiterals) {
+    TestContext tctx = BEGIN("parse strings");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Context ctx = ContextNew("f(\"a\\tb\", r\"c\\d\", \"a\\tb\", \"\")");
+    ContextScan(&ctx);
+
+    Parser parser = ParserNew(&ctx.source, &ctx.ast, &ctx.de, &ctx.tl);
+    /* discard */ expression(&parser);
+
+    // The string expressions, in source order
+    const Expression *strings[4] = { 0 };
+    size_t count = 0;
+    for (size_t i = NULL_AST_ID + 1; i < ctx.ast.exprs.count; i++) {
+        const Expression *expr = AstExprGet(&ctx.ast, i);
+        if (expr->kind == EXPR_STR && count < 4)
+            strings[count++] = expr;
+    }
+
+    bool contents = count == 4;
+    const char *expected[] = { "a\tb", "c\\d", "a\tb", "" };
+    for (size_t i = 0; contents && i < count; i++) {
+        const Substring text = ExprStringGet(
+            &ctx.ast, NULL, &strings[i]->data.exprString);
+        contents = text.length == strlen(expected[i])
+            && memcmp(text.data, expected[i], text.length) == 0;
+    }
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, ctx.de.diagnostics.count == 0, "unexpected diagnostics");
+    CHECK(tctx, contents, "wrong string contents");
+    CHECK(tctx, count == 4
+        && strings[0]->data.exprString.decoded != NULL_SYMBOL_ID
+        && strings[0]->data.exprString.decoded
+            == strings[2]->data.exprString.decoded,
+        "equal escaped strings were not decoded once");
+    CHECK(tctx, count == 4
+        && strings[1]->data.exprString.decoded == NULL_SYMBOL_ID,
+        "raw string was decoded");
+
+    ParserFree(&parser);
+    ContextFree(&ctx);
+    END(tctx)
+}
+
+TEST(PullTokens) {
+    TestContext tctx = BEGIN("parse pulled tokens");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    const char *text = "add(lhs: 1, rhs: f(2.5, x), \"s\", y) + 3.0.z";
+
+    // Parsed from the whole token list for reference
+    Context whole = ContextNew(text);
+    ContextScan(&whole);
+    Parser wholeParser = ParserNew(
+        &whole.source, &whole.ast, &whole.de, &whole.tl);
+    /* discard */ expression(&wholeParser);
+
+    // Then with the scanner only running as far as the parser has looked
+    Context ctx = ContextNew(text);
+    Scanner scanner = ScannerNew(&ctx.source, &ctx.de, &ctx.tl);
+    Parser parser = ParserNewFromSource(
+        &ctx.source, &ctx.ast, &ctx.de, ScannerTokenSource(&scanner));
+    const bool valid = ParserIsValid(&parser);
+    /* discard */ expression(&parser);
+
+    bool same = ctx.ast.exprs.count == whole.ast.exprs.count;
+    for (size_t i = NULL_AST_ID + 1; same && i < ctx.ast.exprs.count; i++) {
+        const Expression *a = AstExprGet(&whole.ast, i);
+        const Expression *b = AstExprGet(&ctx.ast, i);
+        same = a->kind == b->kind
+            && a->span.offset - whole.source.base
+                == b->span.offset - ctx.source.base
+            && a->span.length == b->span.length;
+    }
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, valid, "invalid parser");
+    CHECK(tctx, same, "pulled parse differs from whole parse");
+    CHECK(tctx, ctx.ast.exprs.count > 4, "too few expressions parsed");
+    CHECK(tctx, ctx.tl.count <= 2, "scanner held more than a token");
+    CHECK(tctx, parser.pulled > PARSER_WINDOW, "window was not reused");
+
+    ParserFree(&wholeParser);
+    ParserFree(&parser);
+    ContextFree(&whole);
+    ContextFree(&ctx);
+    END(tctx)
+}
+
+TEST(Items) {
+    TestContext tctx = BEGIN("parse top-level items");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    const char *text = "a = 1; f(b; c) ;; d e; let x = 2 fun g enum h";
+    Context ctx = ContextNew(text);
+    ContextScan(&ctx);
+
+    ParseItemVec items = {0};
+    const bool found = ParseFindItems(&ctx.tl, &items);
+    const size_t firsts[] = { 0, 4, 11, 12, 15, 19, 21 };
+    bool split = found && items.count == 7;
+    for (size_t i = 0; split && i < items.count; i++)
+        split = items.data[i].first == firsts[i]
+            && items.data[i].end == (i + 1 < 7 ? firsts[i + 1] : 23);
+
+    Parser parser = ParserNew(&ctx.source, &ctx.ast, &ctx.de, &ctx.tl);
+    bool success = true;
+    Parse(&parser, &success);
+
+    char tree[128] = {0};
+    /* discard */ rootTrees(&ctx.ast, tree, sizeof(tree));
+
+
+    // The same items, found as the tokens are pulled
+    Context pulledCtx = ContextNew(text);
+    Scanner scanner = ScannerNew(
+        &pulledCtx.source, &pulledCtx.de, &pulledCtx.tl);
+    Parser pulled = ParserNewFromSource(&pulledCtx.source, &pulledCtx.ast,
+        &pulledCtx.de, ScannerTokenSource(&scanner));
+    bool pulledSuccess = true;
+    Parse(&pulled, &pulledSuccess);
+
+    char pulledTree[128] = {0};
+    /* discard */ rootTrees(&pulledCtx.ast, pulledTree, sizeof(pulledTree));
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, split, "wrong item boundaries");
+    CHECK(tctx, strcmp(tree, "(= a 1); d") == 0, "wrong items");
+    // `f(b;`, `e`, and the three declarations
+    CHECK(tctx, !success && ctx.de.diagnostics.count == 5,
+        "wrong diagnostics");
+    CHECK(tctx, strcmp(pulledTree, tree) == 0
+        && pulledCtx.de.diagnostics.count == ctx.de.diagnostics.count
+        && !pulledSuccess, "pulled items differ");
+
+    ParseItemVecFree(&items);
+    ParserFree(&parser);
+    ParserFree(&pulled);
+    ContextFree(&ctx);
+    ContextFree(&pulledCtx);
+
+    END(tctx)
+}
+
+TEST(ParallelParse) {
+    TestContext tctx = BEGIN("parse items in parallel");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    const char *text =
+        "a = 1; f(x, g(y)); \"s\\t\"; b c; -z ** 2;\n"
+        "(w) + a; h(k: \"s\\t\", y); x = y = z; !b";
+
+    Context whole = ContextNew(text);
+    ContextScan(&whole);
+    Parser wholeParser = ParserNew(
+        &whole.source, &whole.ast, &whole.de, &whole.tl);
+    bool wholeSuccess = true;
+    Parse(&wholeParser, &wholeSuccess);
+
+    // A chunk for every couple of tokens
+    Context ctx = ContextNew(text);
+    ContextScan(&ctx);
+    Parser parser = ParserNew(&ctx.source, &ctx.ast, &ctx.de, &ctx.tl);
+    bool success = true;
+    ParseParallel(&parser, 4, 1, &success);
+
+    char wholeTree[256] = {0}, tree[256] = {0};
+    /* discard */ rootTrees(&whole.ast, wholeTree, sizeof(wholeTree));
+    /* discard */ rootTrees(&ctx.ast, tree, sizeof(tree));
+
+
+    // Every node should be the same, symbol ids and all
+    bool same = ctx.ast.exprs.count == whole.ast.exprs.count
+        && ctx.ast.args.count == whole.ast.args.count
+        && ctx.ast.symbols.symbols.count == whole.ast.symbols.symbols.count
+        && ctx.ast.strings.symbols.count == whole.ast.strings.symbols.count;
+    for (size_t i = NULL_AST_ID + 1; same && i < ctx.ast.exprs.count; i++) {
+        const Expression *a = AstExprGet(&whole.ast, i);
+        const Expression *b = AstExprGet(&ctx.ast, i);
+        same = a->kind == b->kind
+            && a->span.offset == b->span.offset
+            && a->span.length == b->span.length
+            && (a->kind != EXPR_SYMBOL
+                || a->data.exprSymbol == b->data.exprSymbol)
+            && (a->kind != EXPR_STR || a->data.exprString.decoded
+                == b->data.exprString.decoded);
+    }
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, strcmp(tree, wholeTree) == 0 && AstRootCount(&ctx.ast) == 10,
+        "parallel items differ");
+    CHECK(tctx, same, "parallel nodes differ");
+    CHECK(tctx, !success && !wholeSuccess
+        && ctx.de.diagnostics.count == whole.de.diagnostics.count,
+        "parallel diagnostics differ");
+
+    ParserFree(&wholeParser);
+    ParserFree(&parser);
+    ContextFree(&whole);
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+// Whether two substrings hold the same bytes, empty ones included.
+static bool sameText(Substring a, Substring b) {
+    return a.length == b.length
+        && (a.length == 0 || memcmp(a.data, b.data, a.length) == 0);
+}
+
+// Whether two labels hold the same text.
+static bool sameLabel(const Ast *a, SymbolId x, const Ast *b, SymbolId y) {
+    return sameText(InternerGet(&a->symbols, x), InternerGet(&b->symbols, y));
+}
+
+// Whether the tree under `y`, a node of item `q` in `ast`, is the tree under
+// `x`, a node of item `p` in `whole`, spans included. Symbols and numbers are
+// left to `rootTrees()`.
+static bool sameNode(
+    const Ast *whole,
+    const AstItem *p,
+    ExprId x,
+    const Ast *ast,
+    const AstItem *q,
+    ExprId y
+) {
+    if (x == NULL_AST_ID || y == NULL_AST_ID)
+        return x == y;
+
+    const Expression *a = AstExprGet(whole, x);
+    const Expression *b = AstExprGet(ast, y);
+    if (a->kind != b->kind || a->span.offset != b->span.offset
+        || a->span.length != b->span.length)
+    {
+        return false;
+    }
+
+    switch (a->kind) {
+    case EXPR_STR:
+        return sameText(ExprStringGet(whole, p, &a->data.exprString),
+            ExprStringGet(ast, q, &b->data.exprString));
+    case EXPR_PREFIX:
+    case EXPR_POSTFIX:
+        return sameNode(whole, p, a->data.exprUnary.operand,
+            ast, q, b->data.exprUnary.operand);
+    case EXPR_BINARY:
+    case EXPR_LOGICAL:
+    case EXPR_COMPARE:
+    case EXPR_EQUALITY:
+    case EXPR_ASSIGN:
+        return sameNode(whole, p, a->data.exprBinary.lhs,
+                ast, q, b->data.exprBinary.lhs)
+            && sameNode(whole, p, a->data.exprBinary.rhs,
+                ast, q, b->data.exprBinary.rhs);
+    case EXPR_CALL: {
+        const ExprCall f = a->data.exprCall, g = b->data.exprCall;
+        bool same = f.argc == g.argc
+            && sameNode(whole, p, f.callee, ast, q, g.callee);
+        for (size_t i = 0; same && i < f.argc; i++) {
+            const Argument *u = ArgumentSegListGet(&whole->args, f.argid + i);
+            const Argument *v = ArgumentSegListGet(&ast->args, g.argid + i);
+            same = u->hasLabel == v->hasLabel
+                && (!u->hasLabel || sameLabel(whole, u->label, ast, v->label))
+                && u->span.offset == v->span.offset
+                && sameNode(whole, p, u->value, ast, q, v->value);
+        }
+        return same;
+    }
+    default:
+        return true;
+    }
+}
+
+// Parses `src` from scratch and checks that `ast`, `diags` and `success`
+// are what that made of it.
+static bool sameAsParse(
+    const Source *src,
+    const Ast *ast,
+    const DiagEngine *diags,
+    bool success
+) {
+    Context whole = ContextNew("");
+    Scanner scanner = ScannerNew(src, &whole.de, &whole.tl);
+    bool wholeSuccess = false;
+    Scan(&scanner, &wholeSuccess);
+    DiagEngine wholeDiags = DENew();
+    Parser parser = ParserNew(src, &whole.ast, &wholeDiags, &whole.tl);
+    Parse(&parser, &wholeSuccess);
+
+    char wholeTree[256] = {0}, tree[256] = {0};
+    /* discard */ rootTrees(&whole.ast, wholeTree, sizeof(wholeTree));
+    /* discard */ rootTrees(ast, tree, sizeof(tree));
+
+    const DiagnosticVec *a = &wholeDiags.diagnostics, *b = &diags->diagnostics;
+    bool same = success == wholeSuccess
+        && strcmp(tree, wholeTree) == 0
+        && AstItemCount(ast) == AstItemCount(&whole.ast)
+        && b->count == a->count;
+
+    // Just as many live nodes, and no more dead ones than live ones
+    same = same
+        && ast->exprs.count - ast->deadExprs == whole.ast.exprs.count
+        && ast->args.count - ast->deadArgs == whole.ast.args.count
+        && ast->deadExprs * 2 <= ast->exprs.count;
+    for (size_t i = 0; same && i < AstItemCount(ast); i++) {
+        const AstItem x = AstItemAt(&whole.ast, i);
+        const AstItem y = AstItemAt(ast, i);
+        same = x.first == y.first && x.end == y.end && x.base == y.base
+            && x.diag == y.diag && x.diags == y.diags
+            && sameNode(&whole.ast, &x, x.root, ast, &y, y.root);
+    }
+    for (size_t i = 0; same && i < a->count; i++) {
+        same = DiagnosticVecGet(a, i)->report.span.offset
+            == DiagnosticVecGet(b, i)->report.span.offset;
+    }
+
+    ParserFree(&parser);
+    DiagnosticVecFree(&wholeDiags.diagnostics);
+    ContextFree(&whole);
+    return same;
+}
+
+#define EDITED_CAPACITY 96
+
+// Applies `edits` to `text` one after the other, rescans and reparses it
+// with `ScanEdit()` and `ParseEdit()` after each, and checks every result
+// against a plain `Parse()` of the edited text. Each edit replaces the buffer
+// in place, `texts` receive the edited texts and must outlive the test.
+static bool sameAsReparse(
+    const char *text,
+    size_t length,
+    const TextEdit *edits,
+    size_t count,
+    char (*texts)[EDITED_CAPACITY]
+) {
+    const FileId file = SMAddBuffer(text, length, "<reparse>");
+    const Source *src = SMGetSource(file);
+
+    Context ctx = ContextNew("");
+    Scanner before = ScannerNew(src, &ctx.de, &ctx.tl);
+    bool success = false;
+    Scan(&before, &success);
+    DiagEngine diags = DENew();
+    Parser parser = ParserNew(src, &ctx.ast, &diags, &ctx.tl);
+    Parse(&parser, &success);
+    ParserFree(&parser);
+
+    bool same = true;
+    for (size_t i = 0; same && i < count; i++) {
+        const TextEdit *edit = &edits[i];
+        const Source old = *src;
+        char *edited = texts[i];
+        memcpy(edited, old.data, edit->offset);
+        memcpy(edited + edit->offset, edit->inserted, edit->length);
+        const size_t rest = edit->offset + edit->deleted;
+        memcpy(edited + edit->offset + edit->length, old.data + rest,
+            old.length - rest);
+        /* discard */ SMReplaceBuffer(file,
+            edited, old.length - edit->deleted + edit->length);
+
+        TokenEdit changed = {0};
+        Scanner after = ScannerNew(src, &ctx.de, &ctx.tl);
+        ScanEdit(&after, &old, edit, &changed, &success);
+        Parser reparse = ParserNew(src, &ctx.ast, &diags, &ctx.tl);
+        ParseEdit(&reparse, &changed, &success);
+        ParserFree(&reparse);
+
+        same = sameAsParse(src, &ctx.ast, &diags, success);
+    }
+
+    DiagnosticVecFree(&diags.diagnostics);
+    ContextFree(&ctx);
+    return same;
+}
+
+TEST(ParseEdit) {
+    TestContext tctx = BEGIN("incremental parse");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    static char text[] =
+        "a = 1; f(x: 2, \"s\\t\"); b c;\ng(y) + \"q\"; h(k: z)\n";
+    static char edited[8][EDITED_CAPACITY];
+    const size_t length = sizeof(text) - 1;
+    const size_t one = (size_t)(strchr(text, '1') - text);
+    const size_t bc = (size_t)(strstr(text, "b c") - text);
+    const size_t g = (size_t)(strchr(text, 'g') - text);
+    const size_t z = (size_t)(strrchr(text, 'z') - text);
+
+    // Inside the first item, fixing the error in the third, joining the
+    // fourth onto the third, splitting the second, and appending an item
+    const TextEdit grow = { one, 1, "(1 + 2)", 7 };
+    const TextEdit fix = { bc + 1, 1, " +", 2 };
+    const TextEdit join = { g - 2, 1, "", 0 };
+    const TextEdit split = { one + 4, 0, "0;", 2 };
+    const TextEdit append = { length, 0, "let", 3 };
+
+    // One edit after the other, so that the kept items move more than once
+    const TextEdit chain[] = {
+        { one, 1, "(1 + 2)", 7 },
+        { 0, 0, "w(v: \"\");\n", 10 },
+        { bc + 17, 1, " +", 2 },
+    };
+
+    // The first and last items edited in turn, over and over, so that dead
+    // nodes pile up until they are compacted
+    static char churned[32][EDITED_CAPACITY];
+    TextEdit churn[32];
+    for (size_t i = 0; i < 32; i += 4) {
+        churn[i]     = (TextEdit) { one, 1, "(1 + 2)", 7 };
+        churn[i + 1] = (TextEdit) { z + 6, 1, "(z)", 3 };
+        churn[i + 2] = (TextEdit) { one, 7, "1", 1 };
+        churn[i + 3] = (TextEdit) { z, 3, "z", 1 };
+    }
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, sameAsReparse(text, length, &grow, 1, &edited[0]),
+        "grown item differs");
+    CHECK(tctx, sameAsReparse(text, length, &fix, 1, &edited[1]),
+        "fixed item differs");
+    CHECK(tctx, sameAsReparse(text, length, &join, 1, &edited[2]),
+        "joined items differ");
+    CHECK(tctx, sameAsReparse(text, length, &split, 1, &edited[3]),
+        "split item differs");
+    CHECK(tctx, sameAsReparse(text, length, &append, 1, &edited[4]),
+        "appended item differs");
+    CHECK(tctx, sameAsReparse(text, length, chain, 3, &edited[5]),
+        "chained edits differ");
+    CHECK(tctx, sameAsReparse(text, length, churn, 32, churned),
+        "churned items differ");
+    END(tctx)
+}
+
+// What a streamed compile handed over, item by item.
+typedef struct StreamedItems {
+    char trees[256];
+    size_t length;
+    size_t items;
+    size_t lines[8];
+    size_t diags;
+    size_t maxExprs;
+    bool ownNodes;
+} StreamedItems;
+
+static void recordItem(void *ctx, const CompileItem *item) {
+    StreamedItems *seen = ctx;
+    seen->items++;
+
+    // Only this item's nodes are in the AST
+    const Ast *ast = item->ast;
+    seen->ownNodes = seen->ownNodes && AstItemCount(ast) == 1
+        && AstRootCount(ast) == (item->root == NULL_AST_ID ? 1 : 2);
+    if (ast->exprs.count > seen->maxExprs)
+        seen->maxExprs = ast->exprs.count;
+
+    const DiagnosticVec *diags = &item->diags->diagnostics;
+    for (size_t i = 0; i < diags->count; i++, seen->diags++) {
+        size_t col = 0;
+        if (seen->diags < 8)
+            /* discard */ SpanLineCol(&DiagnosticVecGet(diags, i)->report.span,
+                &seen->lines[seen->diags], &col);
+    }
+
+    if (item->root == NULL_AST_ID || seen->length >= sizeof(seen->trees))
+        return;
+    char *out = seen->trees + seen->length;
+    size_t cap = sizeof(seen->trees) - seen->length;
+    if (seen->length > 0)
+        seen->length += (size_t)snprintf(out, cap, "; ");
+    out = seen->trees + seen->length;
+    cap = seen->length < sizeof(seen->trees)
+        ? sizeof(seen->trees) - seen->length
+        : 0;
+    seen->length += sexpr(ast, item->root, out, cap);
+}
+
+TEST(CompileStream) {
+    TestContext tctx = BEGIN("streamed compile");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    const char *path = "tm2l_items.m2l";
+    const char *text =
+        "alpha = 12345;\n"
+        "f(x: beta, gamma(2)) ;; delta eps\n"
+        "let zeta;\n"
+        "long_callee(a, b, c, d, e, f, g, h) + 7;\n"
+        "k = -1\n";
+    FILE *file = fopen(path, "wb");
+    if (file) {
+        fputs(text, file);
+        fclose(file);
+    }
+
+    // Parse it whole for reference
+    Context ctx = ContextNew(text);
+    ContextScan(&ctx);
+    Parser parser = ParserNew(&ctx.source, &ctx.ast, &ctx.de, &ctx.tl);
+    bool wholeSuccess = false;
+    Parse(&parser, &wholeSuccess);
+    char wholeTrees[256] = {0};
+    /* discard */ rootTrees(&ctx.ast, wholeTrees, sizeof(wholeTrees));
+    size_t wholeLines[8] = {0};
+    for (size_t i = 0; i < ctx.de.diagnostics.count && i < 8; i++) {
+        size_t col = 0;
+        /* discard */ SpanLineCol(
+            &DiagnosticVecGet(&ctx.de.diagnostics, i)->report.span,
+            &wholeLines[i], &col);
+    }
+
+    // Then an item at a time through a 16 byte window, which the long item
+    // has to grow
+    StreamedItems streamed = { .ownNodes = true };
+    SourceStream stream = SourceStreamOpen(path, 16);
+    bool success = true;
+    CompileStream(&stream, recordItem, &streamed, &success);
+
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, file != NULL, "could not write test file");
+    CHECK(tctx, SourceStreamIsValid(&stream), "invalid stream");
+    CHECK(tctx, success == wholeSuccess, "success differs from Parse()");
+    CHECK(tctx, strcmp(streamed.trees, wholeTrees) == 0,
+        "streamed trees differ from whole trees");
+    CHECK(tctx, streamed.items == AstItemCount(&ctx.ast),
+        "streamed item count differs");
+    CHECK(tctx, streamed.diags == ctx.de.diagnostics.count,
+        "streamed diagnostic count differs");
+    CHECK(tctx, memcmp(streamed.lines, wholeLines, sizeof(wholeLines)) == 0,
+        "streamed diagnostics are on other lines");
+    CHECK(tctx, streamed.ownNodes, "an item saw another item's nodes");
+    CHECK(tctx, streamed.maxExprs < ctx.ast.exprs.count,
+        "nodes were not recycled between items");
+    CHECK(tctx, stream.capacity == 64, "window did not grow to one item");
+
+    ParserFree(&parser);
+    ContextFree(&ctx);
+
+    SourceStreamFree(&stream);
+    remove(path);
     END(tctx)
 }
@@ -3,7 +3,16 @@
 
 #include "test.h"
 #define TESTS \
-    X(Call)
+    X(Call)                                                                   \
+    X(Precedence)                                                             \
+    X(NestedCalls)                                                            \
+    X(DeepNesting)                                                            \
+    X(StringLiterals)                                                         \
+    X(PullTokens)                                                             \
+    X(Items)                                                                  \
+    X(ParallelParse)                                                          \
+    X(ParseEdit)                                                              \
+    X(CompileStream)
 
 #define X(name) int Test##name();
 TESTS
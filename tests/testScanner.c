@@ -0,0 +1,753 @@
+#define M2L_TEST_IMPL
+
+// Test headers
+#include "test.h"
+#include "testScanner.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Lib headers
+#include "../src/common/source.h"
+#include "../src/common/stream.h"
+#include "../src/scanning/literal.h"
+#include "../src/scanning/pipe.h"
+#include "../src/scanning/scanner.h"
+#include "../src/scanning/unicode.h"
+
+void RunScannerTests() {
+    #define X(name) Test##name();
+    SCANNER_TESTS
+    #undef X
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Helpers
+// -------------------------------------------------------------------------- //
+
+// What a streamed token looked like while its window was alive.
+typedef struct SeenToken {
+    TokenKind kind;
+    char lexeme[32];
+    size_t line;
+    size_t col;
+} SeenToken;
+
+typedef struct Seen {
+    SeenToken tokens[512];
+    size_t count;
+    size_t batches;
+} Seen;
+
+static void recordToken(Seen *seen, const Token *token) {
+    if (seen->count >= 512) return;
+    SeenToken *out = &seen->tokens[seen->count++];
+    *out = (SeenToken) { .kind = token->kind };
+
+    // EOF points one past the data, it has no lexeme
+    Substring str = token->kind == TK_EOF
+        ? NULL_SUBSTRING
+        : SpanSubstring(&token->span);
+    if (!SubstringIsNull(&str) && str.length < sizeof(out->lexeme))
+        memcpy(out->lexeme, str.data, str.length);
+    /* discard */ SpanLineCol(&token->span, &out->line, &out->col);
+}
+
+static size_t recordBatch(void *ctx, TokenList *tokens, DiagEngine *diags) {
+    (void)diags;
+    Seen *seen = ctx;
+    seen->batches++;
+    for (size_t i = 0; i < tokens->count; i++) {
+        const Token token = TLGet(tokens, i);
+        recordToken(seen, &token);
+    }
+    return tokens->count;
+}
+
+// -------------------------------------------------------------------------- //
+// MARK: Tests
+// -------------------------------------------------------------------------- //
+
+TEST(ScanStream) {
+    TestContext tctx = BEGIN("streamed scan");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    const char *path = "tm2l_stream.m2l";
+    const char *text =
+        "let alpha = 12345 + \"a string\"\n"
+        "beta(gamma, 3.25)\n"
+        "    delta_epsilon >= 0.5\n"
+        "\"last string straddles\" zeta\n";
+    FILE *file = fopen(path, "wb");
+    if (file) {
+        fputs(text, file);
+        fclose(file);
+    }
+
+    // Scan it whole for reference
+    Context ctx = ContextNew(text);
+    ContextScan(&ctx);
+    Seen whole = {0};
+    /* discard */ recordBatch(&whole, &ctx.tl, &ctx.de);
+
+    // Then through a 16 byte window, which almost every line straddles
+    Seen streamed = {0};
+    SourceStream stream = SourceStreamOpen(path, 16);
+    DiagEngine de = DENew();
+    TokenList  tl = TLNew();
+    Scanner scanner = ScannerNew(SourceStreamSource(&stream), &de, &tl);
+    bool success = false;
+    ScanStream(&scanner, &stream, recordBatch, &streamed, &success);
+
+    bool same = whole.count == streamed.count;
+    for (size_t i = 0; same && i < whole.count; i++) {
+        const SeenToken *a = &whole.tokens[i];
+        const SeenToken *b = &streamed.tokens[i];
+        same = a->kind == b->kind
+            && strcmp(a->lexeme, b->lexeme) == 0
+            && a->line == b->line
+            && a->col == b->col;
+    }
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, file != NULL, "could not write test file");
+    CHECK(tctx, SourceStreamIsValid(&stream), "invalid stream");
+    CHECK(tctx, success, "streamed scan failed");
+    CHECK(tctx, streamed.batches > 4, "input was not split into windows");
+    CHECK(tctx, stream.capacity == 32, "window did not grow for one token");
+    CHECK(tctx, same, "streamed tokens differ from whole tokens");
+
+    SourceStreamFree(&stream);
+    TLFree(&tl);
+    DiagnosticVecFree(&de.diagnostics);
+    ContextFree(&ctx);
+    remove(path);
+
+    END(tctx)
+}
+
+TEST(Keywords) {
+    TestContext tctx = BEGIN("keyword table");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Context ctx = ContextNew(
+        "true false let mut fun type if else for in while enum "
+        "trues fals le iff i x _if whilee tru3 Let\tfor\r\nfor");
+    ContextScan(&ctx);
+
+    const TokenKind expected[] = {
+        #define X(kind, text) kind,
+        KEYWORD_LIST
+        #undef X
+        TK_SYMBOL, TK_SYMBOL, TK_SYMBOL, TK_SYMBOL, TK_SYMBOL, TK_SYMBOL,
+        TK_SYMBOL, TK_SYMBOL, TK_SYMBOL, TK_SYMBOL, TK_FOR, TK_FOR, TK_EOF,
+    };
+    const size_t count = sizeof(expected) / sizeof(expected[0]);
+
+    bool same = ctx.tl.count == count;
+    for (size_t i = 0; same && i < count; i++)
+        same = TLKind(&ctx.tl, i) == expected[i];
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, ctx.de.diagnostics.count == 0, "unexpected diagnostics");
+    CHECK(tctx, same, "wrong token kinds");
+
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+TEST(KeywordTable) {
+    TestContext tctx = BEGIN("every keyword round-trips");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    // Spelled from the list itself, so a keyword added there is checked too
+    Context ctx = ContextNew(
+        #define X(kind, text) text " "
+        KEYWORD_LIST
+        #undef X
+    );
+    ContextScan(&ctx);
+
+    const TokenKind expected[] = {
+        #define X(kind, text) kind,
+        KEYWORD_LIST
+        #undef X
+    };
+    const size_t count = sizeof(expected) / sizeof(expected[0]);
+
+    bool same = ctx.tl.count == count + 1;
+    for (size_t i = 0; same && i < count; i++)
+        same = TLKind(&ctx.tl, i) == expected[i];
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, ctx.de.diagnostics.count == 0, "unexpected diagnostics");
+    CHECK(tctx, same, "a keyword scanned as the wrong kind");
+
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+TEST(NumberLiterals) {
+    TestContext tctx = BEGIN("number literals");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Context ctx = ContextNew(
+        "1_000 0x7f_FF 0b1010 9223372036854775807 2.5 0.1 "
+        "1_0.2_5 7.x 0b12 99999999999999999999");
+    ContextScan(&ctx);
+
+    const TokenKind kinds[] = {
+        TK_INT, TK_INT, TK_INT, TK_INT, TK_FLOAT, TK_FLOAT, TK_FLOAT,
+        TK_INT, TK_DOT, TK_SYMBOL, TK_INT, TK_INT, TK_EOF,
+    };
+    const size_t count = sizeof(kinds) / sizeof(kinds[0]);
+    bool same = ctx.tl.count == count;
+    for (size_t i = 0; same && i < count; i++)
+        same = TLKind(&ctx.tl, i) == kinds[i];
+
+    // Values are decoded by the scanner and kept off the token rows
+    bool values = same
+        && TLGet(&ctx.tl, 0).value.i == 1000
+        && TLGet(&ctx.tl, 1).value.i == 0x7fff
+        && TLGet(&ctx.tl, 2).value.i == 10
+        && TLGet(&ctx.tl, 3).value.i == INT64_MAX
+        && TLGet(&ctx.tl, 4).value.f == 2.5
+        && TLGet(&ctx.tl, 5).value.f == 0.1
+        && TLGet(&ctx.tl, 6).value.f == 10.25
+        && TLGet(&ctx.tl, 7).value.i == 7;
+
+    // A literal that can't be decoded is still a token, with a diagnostic
+    size_t invalid = 0;
+    for (size_t i = 0; i < ctx.de.diagnostics.count; i++) {
+        const Diagnostic *diag = DiagnosticVecGet(&ctx.de.diagnostics, i);
+        invalid += diag->issue == ERR_INVALID_NUMBER;
+    }
+
+    // Dropping tokens drops their values
+    TLTruncate(&ctx.tl, 5);
+    const size_t kept = ctx.tl.valueCount;
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, same, "wrong token kinds");
+    CHECK(tctx, values, "wrong values");
+    CHECK(tctx, invalid == 2 && ctx.de.diagnostics.count == 2,
+        "expected two invalid numbers");
+    CHECK(tctx, kept == 5, "truncate kept the wrong values");
+
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+TEST(Strings) {
+    TestContext tctx = BEGIN("strings");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    Context ctx = ContextNew(
+        "\"plain\" \"a\\tb\" r\"c\\d\" # a comment, \"not a string\"\n"
+        "\"e\\q\" \"f");
+    ContextScan(&ctx);
+
+    const TokenKind kinds[] = { TK_STR, TK_STR, TK_STR, TK_STR, TK_EOF };
+    const size_t count = sizeof(kinds) / sizeof(kinds[0]);
+    bool same = ctx.tl.count == count;
+    for (size_t i = 0; same && i < count; i++)
+        same = TLKind(&ctx.tl, i) == kinds[i];
+
+    // Only strings that need decoding say so, raw ones never do
+    bool flags = same
+        && TLGet(&ctx.tl, 0).hash == 0
+        && TLGet(&ctx.tl, 1).hash == TOKEN_STR_ESCAPED
+        && TLGet(&ctx.tl, 2).hash == TOKEN_STR_RAW
+        && TLGet(&ctx.tl, 3).hash == TOKEN_STR_ESCAPED;
+
+    // A bad escape keeps its string, a missing quote doesn't
+    size_t invalid = 0;
+    for (size_t i = 0; i < ctx.de.diagnostics.count; i++) {
+        const Diagnostic *diag = DiagnosticVecGet(&ctx.de.diagnostics, i);
+        invalid += diag->issue == ERR_INVALID_STRING;
+    }
+
+    // Decoding
+    char decoded[16];
+    const size_t length = LiteralDecodeString("a\\tb\\x41\\q", 10, decoded);
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, same, "wrong token kinds");
+    CHECK(tctx, flags, "wrong string flags");
+    CHECK(tctx, invalid == 2 && ctx.de.diagnostics.count == 2,
+        "expected a bad escape and an unterminated string");
+    CHECK(tctx, length == 6 && memcmp(decoded, "a\tbA\\q", 6) == 0,
+        "wrong decoded string");
+
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+TEST(UnicodeSymbols) {
+    TestContext tctx = BEGIN("unicode symbols");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    // Two byte, three byte and subscript code points, one that can't start
+    // a symbol, one that can't be in one at all and a broken sequence
+    Context ctx = ContextNew(
+        "σ Δt+λ₁ café_2 ·x x∑y \xC3(");
+    ContextScan(&ctx);
+
+    const TokenKind kinds[] = {
+        TK_SYMBOL, TK_SYMBOL, TK_PLUS, TK_SYMBOL, TK_SYMBOL, TK_SYMBOL,
+        TK_SYMBOL, TK_SYMBOL, TK_LPAR, TK_EOF,
+    };
+    const size_t count = sizeof(kinds) / sizeof(kinds[0]);
+    bool same = ctx.tl.count == count;
+    for (size_t i = 0; same && i < count; i++)
+        same = TLKind(&ctx.tl, i) == kinds[i];
+
+    // Symbols take whole code points
+    const uint32_t lengths[] = { 2, 3, 1, 5, 7, 1, 1, 1 };
+    bool spans = same;
+    for (size_t i = 0; spans && i < sizeof(lengths) / sizeof(*lengths); i++)
+        spans = TLGet(&ctx.tl, i).span.length == lengths[i];
+
+    // `·`, `∑` and the lone lead byte, each reported once
+    size_t invalid = 0;
+    for (size_t i = 0; i < ctx.de.diagnostics.count; i++) {
+        const Diagnostic *diag = DiagnosticVecGet(&ctx.de.diagnostics, i);
+        invalid += diag->issue == ERR_INVALID_CHAR;
+    }
+
+    // Decoding
+    uint32_t cp = 0;
+    const bool decoded = Utf8Decode("\xE2\x82\x81", 3, &cp) == 3
+        && cp == 0x2081
+        && Utf8Decode("\xC0\x80", 2, &cp) == 0    // overlong
+        && Utf8Decode("\xED\xA0\x80", 3, &cp) == 0 // surrogate
+        && Utf8Decode("\xE2\x82", 2, &cp) == 0;   // truncated
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, same, "wrong token kinds");
+    CHECK(tctx, spans, "wrong symbol spans");
+    CHECK(tctx, invalid == 3 && ctx.de.diagnostics.count == 3,
+        "expected three invalid characters");
+    CHECK(tctx, decoded, "wrong UTF-8 decoding");
+    CHECK(tctx, UnicodeIsXidStart(0x03C3) && !UnicodeIsXidStart(0x2081)
+        && UnicodeIsXidContinue(0x2081) && !UnicodeIsXidContinue(0x2211),
+        "wrong identifier properties");
+
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+TEST(RunKernels) {
+    TestContext tctx = BEGIN("run kernels");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    // Runs of every class, with boundary bytes just outside each range, and
+    // long enough to cover whole vectors and the tails after them. Allocated
+    // to the exact size so that reading past `length` trips the sanitizer.
+    const char pattern[] =
+        "  \t\r \t   \r\r   \t   \t  \n"
+        "abc_XYZ09az_AZ_Q@[`{/:aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa "
+        "0123456789_000000000000000000000000000000000000.12\x80\xff"
+        "string body with no quote, nor backslash, for a while\\n\"."
+        "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+        "\t\t\t\t\t\t\t\t\t\t\0x";
+    const size_t size = sizeof(pattern) - 1;
+    char *data = malloc(size);
+    if (data) memcpy(data, pattern, size);
+
+    const RunKernels *fast = RunKernelsGet();
+    const RunKernels *slow = RunKernelsScalar();
+    bool same = data != NULL;
+    for (size_t from = 0; same && from < size; from++) {
+        const char *at = data + from;
+        const size_t left = size - from;
+        same = fast->whitespace(at, left) == slow->whitespace(at, left)
+            && fast->symbol(at, left) == slow->symbol(at, left)
+            && fast->digits(at, left) == slow->digits(at, left)
+            && fast->string(at, left) == slow->string(at, left);
+    }
+
+    const char *symbols = strchr(pattern, 'a');
+    const char *digits  = strstr(pattern, "0123");
+    const char *string  = strstr(pattern, "string body");
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, same, "fast kernels disagree with scalar kernels");
+    CHECK(tctx, slow->whitespace(pattern, size) == 21, "wrong whitespace run");
+    CHECK(tctx, slow->symbol(symbols, 20) == 16, "wrong symbol run");
+    CHECK(tctx, slow->digits(digits, 60) == 47, "wrong digit run");
+    CHECK(tctx, slow->string(string, 60) == 53, "wrong string run");
+    CHECK(tctx, slow->string(string + 54, 3) == 1, "wrong escaped run");
+    CHECK(tctx, slow->digits(digits, 5) == 5, "run read past its length");
+
+    free(data);
+    END(tctx)
+}
+
+// Scans `src` with `ScanParallel()` and checks it against `Scan()`.
+static bool sameAsScan(const Source *src, size_t threads, size_t minChunk) {
+    DiagEngine wholeDiags = DENew();
+    TokenList  wholeTokens = TLNew();
+    Scanner whole = ScannerNew(src, &wholeDiags, &wholeTokens);
+    bool wholeSuccess = false;
+    Scan(&whole, &wholeSuccess);
+
+    DiagEngine diags = DENew();
+    TokenList  tokens = TLNew();
+    Scanner parallel = ScannerNew(src, &diags, &tokens);
+    bool success = !wholeSuccess;
+    ScanParallel(&parallel, threads, minChunk, &success);
+
+    bool same = success == wholeSuccess
+        && tokens.count == wholeTokens.count
+        && diags.diagnostics.count == wholeDiags.diagnostics.count;
+    for (size_t i = 0; same && i < tokens.count; i++) {
+        const Token a = TLGet(&wholeTokens, i);
+        const Token b = TLGet(&tokens, i);
+        same = a.kind == b.kind
+            && a.span.offset == b.span.offset
+            && a.span.length == b.span.length
+            && a.hash == b.hash;
+    }
+    for (size_t i = 0; same && i < diags.diagnostics.count; i++) {
+        const Diagnostic *a = DiagnosticVecGet(&wholeDiags.diagnostics, i);
+        const Diagnostic *b = DiagnosticVecGet(&diags.diagnostics, i);
+        same = a->issue == b->issue
+            && a->report.span.offset == b->report.span.offset;
+    }
+
+    TLFree(&wholeTokens);
+    DiagnosticVecFree(&wholeDiags.diagnostics);
+    TLFree(&tokens);
+    DiagnosticVecFree(&diags.diagnostics);
+    return same;
+}
+
+TEST(ScanParallel) {
+    TestContext tctx = BEGIN("parallel scan");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    // Plain lines, with strings that run across several lines (and so across
+    // chunk boundaries, with code-like text inside), stray characters, and an
+    // unterminated string at the very end.
+    static char text[4096];
+    size_t length = 0;
+    for (int line = 0; line < 64; line++) {
+        const char *extra = line % 13 == 5 ? "\"open\n x = $ 1\n\n y\n"
+            : line % 13 == 6 ? "closed\" + 2.5.x"
+            : line % 17 == 3 ? "@ 1.2.3"
+            : "";
+        length += (size_t)snprintf(text + length, sizeof(text) - length,
+            "let v%d = f(%d, \"s\") >= 0.5 %s\n", line, line * 7, extra);
+    }
+    length += (size_t)snprintf(text + length, sizeof(text) - length,
+        "tail \"never closed\n a b c\n");
+
+    const FileId file = SMAddBuffer(text, length, "<parallel>");
+    const Source *src = SMGetSource(file);
+    const bool valid = SourceIsValid(src) && length < sizeof(text) - 1;
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, valid, "could not build the test source");
+    CHECK(tctx, valid && sameAsScan(src, 4, 256), "4 chunks differ");
+    CHECK(tctx, valid && sameAsScan(src, 11, 64), "11 chunks differ");
+    CHECK(tctx, valid && sameAsScan(src, 1, 64), "1 chunk differs");
+    END(tctx)
+}
+
+// Applies `edit` to `text` and checks `ScanEdit()` against a plain `Scan()`
+// of the edited text. The edit replaces the buffer in place, like an editor
+// would, and `edited` receives the new text and must outlive the test.
+static bool sameAsEdit(
+    const char *text,
+    size_t length,
+    const TextEdit *edit,
+    char *edited
+) {
+    const FileId file = SMAddBuffer(text, length, "<edit>");
+    const Source *src = SMGetSource(file);
+
+    // Scan the old text
+    DiagEngine diags = DENew();
+    TokenList  tokens = TLNew();
+    Scanner before = ScannerNew(src, &diags, &tokens);
+    bool success = false;
+    Scan(&before, &success);
+
+    // Then edit it
+    const Source old = *src;
+    memcpy(edited, text, edit->offset);
+    memcpy(edited + edit->offset, edit->inserted, edit->length);
+    const size_t rest = edit->offset + edit->deleted;
+    memcpy(edited + edit->offset + edit->length, text + rest, length - rest);
+    /* discard */ SMReplaceBuffer(file,
+        edited, length - edit->deleted + edit->length);
+
+    DiagEngine wholeDiags = DENew();
+    TokenList  wholeTokens = TLNew();
+    Scanner whole = ScannerNew(src, &wholeDiags, &wholeTokens);
+    bool wholeSuccess = false;
+    Scan(&whole, &wholeSuccess);
+
+    Scanner after = ScannerNew(src, &diags, &tokens);
+    success = !wholeSuccess;
+    const size_t oldCount = tokens.count;
+    TokenEdit changed = {0};
+    ScanEdit(&after, &old, edit, &changed, &success);
+
+    bool same = success == wholeSuccess
+        && tokens.count == wholeTokens.count
+        && diags.diagnostics.count == wholeDiags.diagnostics.count
+        && tokens.count == oldCount - changed.removed + changed.inserted;
+    for (size_t i = 0; same && i < tokens.count; i++) {
+        const Token a = TLGet(&wholeTokens, i);
+        const Token b = TLGet(&tokens, i);
+        same = a.kind == b.kind
+            && a.span.offset == b.span.offset
+            && a.span.length == b.span.length
+            && a.hash == b.hash;
+    }
+    for (size_t i = 0; same && i < diags.diagnostics.count; i++) {
+        const Diagnostic *a = DiagnosticVecGet(&wholeDiags.diagnostics, i);
+        const Diagnostic *b = DiagnosticVecGet(&diags.diagnostics, i);
+        same = a->issue == b->issue
+            && a->report.span.offset == b->report.span.offset;
+    }
+
+    TLFree(&wholeTokens);
+    DiagnosticVecFree(&wholeDiags.diagnostics);
+    TLFree(&tokens);
+    DiagnosticVecFree(&diags.diagnostics);
+    return same;
+}
+
+TEST(ScanEdit) {
+    TestContext tctx = BEGIN("incremental scan");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    static char text[] = "let a = f(1, 2.5)\nb = \"s\" + 12\nc = a.x $ 3\n";
+    static char edited[6][sizeof(text) + 16];
+    const size_t length = sizeof(text) - 1;
+    const size_t quote = (size_t)(strchr(text, '"') - text);
+    const size_t two = (size_t)(strstr(text, "2.5") - text);
+
+    // Inside a token, opening a string that swallows the rest, deleting the
+    // closing quote, turning `2.5` into `2.` then `2`, and a no-op edit
+    const TextEdit rename = { 4, 1, "abc", 3 };
+    const TextEdit open = { 0, 0, "\"", 1 };
+    const TextEdit unquote = { quote, 1, "", 0 };
+    const TextEdit dot = { two + 2, 1, "", 0 };
+    const TextEdit digits = { two + 1, 2, "", 0 };
+    const TextEdit same = { length - 1, 1, "\n", 1 };
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, sameAsEdit(text, length, &rename, edited[0]),
+        "rename differs");
+    CHECK(tctx, sameAsEdit(text, length, &open, edited[1]),
+        "open quote differs");
+    CHECK(tctx, sameAsEdit(text, length, &unquote, edited[2]),
+        "unquote differs");
+    CHECK(tctx, sameAsEdit(text, length, &dot, edited[3]),
+        "dropped digit differs");
+    CHECK(tctx, sameAsEdit(text, length, &digits, edited[4]),
+        "dropped dot differs");
+    CHECK(tctx, sameAsEdit(text, length, &same, edited[5]),
+        "no-op edit differs");
+    END(tctx)
+}
+
+TEST(TokenPipe) {
+    TestContext tctx = BEGIN("token pipe");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    static char text[2048];
+    size_t length = 0;
+    for (int i = 0; i < 40; i++) {
+        length += (size_t)snprintf(text + length, sizeof(text) - length,
+            "x%d = f(%d, 2.5) + \"s\"\n", i, i);
+    }
+
+    // Scanned whole for reference
+    Context ctx = ContextNew(text);
+    ContextScan(&ctx);
+
+    // Then through a ring much smaller than the token count, so that both
+    // threads wait on each other many times over
+    DiagEngine de = DENew();
+    TokenList  tl = TLNew();
+    Scanner scanner = ScannerNew(&ctx.source, &de, &tl);
+    TokenPipe pipe = TokenPipeNew(10);
+    const bool started = TokenPipeStart(&pipe, ScannerTokenSource(&scanner));
+    const TokenSource tokens = TokenPipeSource(&pipe);
+
+    bool same = started;
+    for (size_t i = 0; same && i < ctx.tl.count + 2; i++) {
+        const size_t at = i < ctx.tl.count ? i : ctx.tl.count - 1;
+        const Token a = TLGet(&ctx.tl, at);
+        Token b = {0};
+        tokens.pull(tokens.ctx, &b);
+        same = a.kind == b.kind && a.span.offset == b.span.offset;
+    }
+    const size_t capacity = pipe.capacity;
+    TokenPipeFree(&pipe);
+
+    // A consumer that stops early must not leave the producer stuck
+    DiagEngine de2 = DENew();
+    TokenList  tl2 = TLNew();
+    Scanner scanner2 = ScannerNew(&ctx.source, &de2, &tl2);
+    TokenPipe early = TokenPipeNew(4);
+    /* discard */ TokenPipeStart(&early, ScannerTokenSource(&scanner2));
+    const TokenSource earlyTokens = TokenPipeSource(&early);
+    Token first = {0};
+    earlyTokens.pull(earlyTokens.ctx, &first);
+    TokenPipeFree(&early);
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, started, "producer thread did not start");
+    CHECK(tctx, capacity == 16, "capacity not rounded to a power of two");
+    CHECK(tctx, same, "piped tokens differ from scanned tokens");
+    CHECK(tctx, first.kind == TK_SYMBOL, "wrong first token");
+    CHECK(tctx, !TokenPipeIsValid(&early), "pipe not poisoned");
+
+    TLFree(&tl);
+    TLFree(&tl2);
+    DiagnosticVecFree(&de.diagnostics);
+    DiagnosticVecFree(&de2.diagnostics);
+    ContextFree(&ctx);
+
+    END(tctx)
+}
+
+TEST(TokenList) {
+    TestContext tctx = BEGIN("struct of arrays token list");
+
+    //
+    // ---------------------- [[ PROCESSING ]] ----------------------
+    //
+    // Enough tokens to grow every array a few times over
+    const size_t count = INIT_TOKEN_LIST_CAP * 4 + 3;
+    TokenList tl = TLNew();
+    for (size_t i = 0; i < count; i++) {
+        const Token token = (Token) {
+            i % 2 ? TK_SYMBOL : TK_EOF,
+            { (uint32_t)(i * 3), (uint32_t)(i % 7) },
+            { (uint32_t)(i * 2654435761u) },
+        };
+        TLPush(&tl, &token);
+    }
+
+    bool same = tl.count == count;
+    for (size_t i = 0; same && i < count; i++) {
+        const Token token = TLGet(&tl, i);
+        same = token.kind == (i % 2 ? TK_SYMBOL : TK_EOF)
+            && TLKind(&tl, i) == token.kind
+            && token.span.offset == i * 3
+            && token.span.length == i % 7
+            && TLSpan(&tl, i).offset == token.span.offset
+            && token.hash == (uint32_t)(i * 2654435761u);
+    }
+
+    // Copy the back half over, then cut it down again
+    TokenList half = TLNew();
+    TLExtend(&half, &tl, count / 2);
+    const bool extended = half.count == count - count / 2
+        && TLGet(&half, 0).span.offset == TLGet(&tl, count / 2).span.offset
+        && TLKind(&half, half.count - 1) == TLKind(&tl, count - 1);
+    TLTruncate(&half, 5);
+
+    // Splice literals into the middle, then near the front, moving every
+    // token after the second splice, and check them against a fresh list
+    Context edited = ContextNew("1 a 2.5 b 3 c");
+    ContextScan(&edited);
+    Context middle = ContextNew("7 8");
+    ContextScan(&middle);
+    TLTruncate(&middle.tl, 2);
+    Context front = ContextNew("x 9.5 y");
+    ContextScan(&front);
+    TLTruncate(&front.tl, 3);
+    const uint32_t before = TLSpan(&edited.tl, 2).offset;
+    const uint32_t after = TLSpan(&edited.tl, 5).offset;
+    const bool spliced = TLSplice(&edited.tl, 3, 2, &middle.tl)
+        && TLSplice(&edited.tl, 1, 1, &front.tl);
+    TLShiftOffsets(&edited.tl, 4, edited.tl.count, 100);
+
+    const TokenKind splicedKinds[] = {
+        TK_INT, TK_SYMBOL, TK_FLOAT, TK_SYMBOL, TK_FLOAT, TK_INT, TK_INT,
+        TK_SYMBOL, TK_EOF,
+    };
+    const int64_t splicedInts[] = { 1, 0, 0, 0, 0, 7, 8 };
+    bool kept = spliced && edited.tl.count == 9
+        && edited.tl.valueCount == 5;
+    for (size_t i = 0; kept && i < edited.tl.count; i++) {
+        const Token token = TLGet(&edited.tl, i);
+        kept = token.kind == splicedKinds[i]
+            && (token.kind != TK_INT || token.value.i == splicedInts[i]);
+    }
+    kept = kept && TLGet(&edited.tl, 2).value.f == 9.5
+        && TLGet(&edited.tl, 4).value.f == 2.5
+        && TLSpan(&edited.tl, 4).offset == before + 100
+        && TLSpan(&edited.tl, 7).offset == after + 100;
+
+    //
+    // ------------------------ [[ CHECKS ]] ------------------------
+    //
+    CHECK(tctx, TLIsValid(&tl), "invalid token list");
+    CHECK(tctx, tl.capacity >= count, "list did not grow");
+    CHECK(tctx, same, "tokens did not survive the round trip");
+    CHECK(tctx, extended, "wrong tokens after extending");
+    CHECK(tctx, half.count == 5, "truncate did not drop tokens");
+    CHECK(tctx, kept, "wrong tokens after splicing");
+
+    ContextFree(&edited);
+    ContextFree(&middle);
+    ContextFree(&front);
+
+    TLFree(&tl);
+    TLFree(&half);
+    CHECK(tctx, !TLIsValid(&tl), "freed list still valid");
+    END(tctx)
+}
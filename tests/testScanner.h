@@ -0,0 +1,24 @@
+#ifndef TEST_SCANNER_H
+#define TEST_SCANNER_H
+
+#include "test.h"
+#define SCANNER_TESTS \
+    X(ScanStream)                                                             \
+    X(Keywords)                                                               \
+    X(KeywordTable)                                                           \
+    X(NumberLiterals)                                                         \
+    X(Strings)                                                                \
+    X(UnicodeSymbols)                                                         \
+    X(RunKernels)                                                             \
+    X(ScanParallel)                                                           \
+    X(ScanEdit)                                                               \
+    X(TokenPipe)                                                              \
+    X(TokenList)
+
+#define X(name) int Test##name();
+SCANNER_TESTS
+#undef X
+
+void RunScannerTests();
+
+#endif